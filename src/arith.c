@@ -34,6 +34,19 @@ REVISED BY ANDREAS LOEBEL
 
 #include "arith.h"
 #include "mp.h"
+#include "porta_ctx.h"
+#include <limits.h>
+
+
+/* integer dot products with a 128-bit accumulator, if the compiler has one */
+#ifdef __SIZEOF_INT128__
+#define INT128_VECPR
+static int int_vecpr( RAT *, RAT *, int, __int128 * );
+#endif
+
+
+/* minimal number of rows for which rows_prim() works in parallel */
+#define ROWS_PRIM_PAR 256
 
 
 
@@ -50,7 +63,11 @@ void I_RAT_assign( RAT *a, RAT *b )
 
 
 
-void I_RAT_add( RAT a, RAT b, RAT *c )
+int I_RAT_add_nc( RAT a, RAT b, RAT *c )
+/*
+ * c = a+b without overflow handling: returns 0 (and leaves c
+ * undefined) if the result does not fit, 1 otherwise.
+ */
 { 
 
   int r,x,y1,y2,z1,z2,na,nb;
@@ -59,10 +76,8 @@ void I_RAT_add( RAT a, RAT b, RAT *c )
 
     c->den.i = a.den.i;
     c->num = a.num+b.num;
-    if (c->num-b.num != a.num) {
-      arith_overflow_func(1,I_RAT_add,a,b,c);
-      return;
-    }
+    if (c->num-b.num != a.num)
+      return(0);
 
   }
 
@@ -73,10 +88,8 @@ void I_RAT_add( RAT a, RAT b, RAT *c )
     nb = (z1 = b.num)*(z2 = (c->den.i/b.den.i));
     c->num = na+nb;
 
-    if ((c->den.i/b.den.i !=  x) || (na/y2 != y1) || (nb/z2 != z1) || (c->num-nb != na)) {
-      arith_overflow_func(1,I_RAT_add,a,b,c);
-      return;
-    }
+    if ((c->den.i/b.den.i !=  x) || (na/y2 != y1) || (nb/z2 != z1) || (c->num-nb != na))
+      return(0);
 
   }
 
@@ -85,6 +98,21 @@ void I_RAT_add( RAT a, RAT b, RAT *c )
     c->num /= r;
   }
 
+  return(1);
+
+}
+
+
+
+
+
+
+void I_RAT_add( RAT a, RAT b, RAT *c )
+{ 
+
+  if (!I_RAT_add_nc(a,b,c))
+    arith_overflow_func(1,I_RAT_add,a,b,c);
+
 }
 
       
@@ -93,7 +121,11 @@ void I_RAT_add( RAT a, RAT b, RAT *c )
 
 
 
-void I_RAT_sub( RAT a, RAT b, RAT *c )
+int I_RAT_sub_nc( RAT a, RAT b, RAT *c )
+/*
+ * c = a-b without overflow handling: returns 0 (and leaves c
+ * undefined) if the result does not fit, 1 otherwise.
+ */
 { 
 
   int r,x,y1,y2,z1,z2,an,bn;
@@ -102,10 +134,8 @@ void I_RAT_sub( RAT a, RAT b, RAT *c )
     c->den.i = a.den.i;
     c->num = a.num-b.num;
 
-    if (c->num+b.num != a.num) {
-      arith_overflow_func(1,I_RAT_sub,a,b,c);
-      return;
-    }
+    if (c->num+b.num != a.num)
+      return(0);
 
   }
 
@@ -115,10 +145,8 @@ void I_RAT_sub( RAT a, RAT b, RAT *c )
     bn = (z1 = b.num)*(z2 = (c->den.i/b.den.i));
     c->num = an-bn;
 
-    if ((c->den.i/b.den.i !=  x) || (an/y2 != y1) || (bn/z2 != z1) || (c->num+bn != an)) {
-      arith_overflow_func(1,I_RAT_sub,a,b,c);
-      return;
-    }
+    if ((c->den.i/b.den.i !=  x) || (an/y2 != y1) || (bn/z2 != z1) || (c->num+bn != an))
+      return(0);
 
   }
 
@@ -127,6 +155,8 @@ void I_RAT_sub( RAT a, RAT b, RAT *c )
     c->num /= r;
   }
 
+  return(1);
+
 }
 
 
@@ -134,15 +164,31 @@ void I_RAT_sub( RAT a, RAT b, RAT *c )
 
 
 
+void I_RAT_sub( RAT a, RAT b, RAT *c )
+{ 
 
+  if (!I_RAT_sub_nc(a,b,c))
+    arith_overflow_func(1,I_RAT_sub,a,b,c);
 
-void I_RAT_mul( RAT a, RAT b, RAT *c )
+}
+
+
+
+
+
+
+
+
+static int I_RAT_mul_nc( RAT a, RAT b, RAT *c )
+/*
+ * c = a*b without overflow handling: returns 0 (and leaves c
+ * undefined) if the product does not fit, 1 otherwise.
+ * Uses no global state, so it may be called from parallel code.
+ */
 { 
 
   int r;
-  RAT aa,bb;
 
-  aa = a; bb = b;
   if ((r = igcd(a.num,b.den.i)) > 1) {
     b.den.i /= r;
     a.num /= r;
@@ -156,16 +202,29 @@ void I_RAT_mul( RAT a, RAT b, RAT *c )
     c->num = 0;
   else {
     c->num = a.num*b.num;
-    if (c->num/a.num != b.num) {
-      arith_overflow_func(1,I_RAT_mul,aa,bb,c);
-      return;
-    }
- 
+    if (c->num/a.num != b.num) 
+      return(0);
   }
     
   c->den.i = a.den.i*b.den.i;
   if  (c->den.i/a.den.i != b.den.i) 
-    arith_overflow_func(1,I_RAT_mul,aa,bb,c);
+    return(0);
+
+  return(1);
+
+}
+
+
+
+
+
+
+
+void I_RAT_mul( RAT a, RAT b, RAT *c )
+{ 
+
+  if (!I_RAT_mul_nc(a,b,c))
+    arith_overflow_func(1,I_RAT_mul,a,b,c);
 
 }
 
@@ -182,9 +241,22 @@ int eqie_satisfied( RAT *iep, RAT *pp, int n, int ie )
 
   void vecpr();  
   int ret;
-
-  vecpr(iep,pp,&var[1],n);
-  (*RAT_sub)(*(iep+n),var[1],&var[1]);
+#ifdef INT128_VECPR
+  __int128 s;
+
+  if (RAT_mul == I_RAT_mul && ((iep+n)->num == 0 || (iep+n)->den.i == 1)
+      && int_vecpr(iep,pp,n,&s)
+      && !__builtin_sub_overflow((__int128) (iep+n)->num,s,&s)
+      && s >= LONG_MIN && s <= LONG_MAX) {
+    var[1].num = (long) s;
+    var[1].den.i = 1;
+  }
+  else
+#endif
+  {
+    vecpr(iep,pp,&var[1],n);
+    (*RAT_sub)(*(iep+n),var[1],&var[1]);
+  }
 
   ret = 0;
   if ((ie && var[1].num>0) || (!ie && !var[1].num))
@@ -200,6 +272,31 @@ int eqie_satisfied( RAT *iep, RAT *pp, int n, int ie )
 
 
 
+#ifdef INT128_VECPR
+static int int_vecpr( RAT *a, RAT *b, int n, __int128 *s )
+/*****************************************************************/
+/*
+ * Product of the integer vectors a and b, accumulated in 128 bits.
+ * Returns 0 if a nonzero term has a denominator other than 1
+ * or the accumulator overflows, 1 otherwise.
+ */
+{
+  __int128 sum = 0;
+
+  for (; n > 0; n--, a++, b++) {
+    if (a->num == 0 || b->num == 0)
+      continue;
+    if (a->den.i != 1 || b->den.i != 1 
+        || __builtin_add_overflow(sum,(__int128) a->num*b->num,&sum))
+      return(0);
+  }
+
+  *s = sum;
+  return(1);
+}
+#endif
+
+
 
 
 
@@ -209,8 +306,21 @@ void vecpr( RAT *a, RAT *b, RAT *c, int n )
 /*
  * Compute the product of vectors a and b (both of length n)
  * and store the result in c[0].
+ * Integer vectors are done in one pass with a 128-bit accumulator;
+ * only if that fails or the sum does not fit, the product is 
+ * computed with RAT_mul and RAT_add.
  */
 {
+#ifdef INT128_VECPR
+  __int128 s;
+
+  if (RAT_mul == I_RAT_mul && int_vecpr(a,b,n,&s)
+      && s >= LONG_MIN && s <= LONG_MAX) {
+    c->num = (long) s;
+    c->den.i = 1;
+    return;
+  }
+#endif
 
   (*RAT_assign)(var,RAT_const);     /* var[0] := 0 */
   (*RAT_assign)(c,RAT_const);       /* c[0] := 0 */
@@ -263,6 +373,71 @@ void row_sub( RAT *a, RAT *b, RAT *c, int n )
 
 
 
+void row_comb( RAT *x, RAT *y, RAT *c, int n )
+/*****************************************************************/
+/*
+ * x and y are n-vectors whose first elements x[0] and y[0] have
+ * opposite signs. Store |y[0]|*x + |x[0]|*y in c[1..n-1], i.e. the
+ * nonnegative combination in which the first element cancels.
+ * c[0] is not set.
+ * With integer arithmetic the multipliers are taken as the integers
+ * |num(y[0])|*den(x[0]) and |num(x[0])|*den(y[0]), and integer
+ * vectors are combined without gcd computations as long as the
+ * results stay in the int range.
+ * The multipliers are kept in var[2] and var[3].
+ */
+{
+  long an,bn,s,t;
+  int i = 1;
+
+  if (RAT_mul == I_RAT_mul
+      && !__builtin_mul_overflow(labs(y->num),(long) x->den.i,&an)
+      && !__builtin_mul_overflow(labs(x->num),(long) y->den.i,&bn)
+      && an <= INT_MAX && bn <= INT_MAX) {
+
+    for (; i < n; i++) {
+      if (((x+i)->num && (x+i)->den.i != 1) || ((y+i)->num && (y+i)->den.i != 1)
+          || __builtin_mul_overflow(an,(x+i)->num,&s)
+          || __builtin_mul_overflow(bn,(y+i)->num,&t)
+          || __builtin_add_overflow(s,t,&s) || s > INT_MAX || s < -INT_MAX)
+        break;
+      (c+i)->num = s;
+      (c+i)->den.i = 1;
+    }
+    if (i == n)
+      return;
+
+    var[2].num = an; var[2].den.i = 1;
+    var[3].num = bn; var[3].den.i = 1;
+  }
+  else {
+    (*RAT_assign)(var+2,y);
+    if (var[2].num < 0) var[2].num = -var[2].num;
+    (*RAT_assign)(var+3,x);
+    if (var[3].num < 0) var[3].num = -var[3].num;
+  }
+
+  for (; i < n; i++) {
+    (*RAT_mul)(var[2],*(x+i),var);
+    (*RAT_mul)(var[3],*(y+i),var+1);
+    (*RAT_add)(var[0],var[1],c+i);
+  }
+
+  /*
+   * With long integer arithmetic the integer form may exceed the
+   * fixed precision, so return to x/|x[0]| + y/|y[0]| here.
+   */
+  if (RAT_mul != I_RAT_mul) {
+    (*RAT_mul)(var[2],var[3],var+1);
+    (*RAT_row_prim)(c+1,c+1,var+1,n-1);
+  }
+}
+
+
+
+
+
+
 void scal_mul( RAT *val, RAT *b, RAT *c, int n )
 {
   for( ; n > 0; n-- )  
@@ -336,26 +511,48 @@ void gauss_calcnewrow( RAT *row1, RAT *row2, int pivcol, RAT *newrow,
 
 
 
+unsigned long long binary_gcd( unsigned long long u, unsigned long long v )
+/*
+ * Binary (Stein's) gcd of two nonnegative integers.
+ * Only shifts and subtractions are used, no divisions.
+ */
+{
+    unsigned long long t;
+    int shift;
+
+    if (u == 0)
+        return(v);
+    if (v == 0)
+        return(u);
+
+    shift = __builtin_ctzll(u | v);
+    u >>= __builtin_ctzll(u);
+    do
+    {
+        v >>= __builtin_ctzll(v);
+        if (u > v)
+        {
+            t = v;
+            v = u;
+            u = t;
+        }
+        v -= u;
+    } while (v != 0);
+
+    return(u << shift);
+}
+
+
+
+
+
+
 int igcd( int a, int b )
 { 
-    int r;
-    
     if (a == 0)
         return(b);
     
-    if ((a = abs(a)) < (b = abs(b)))
-    {
-        r = a;
-        a = b;
-        b = r;
-    }
-    
-    while ((r = a%b) > 0)
-    {
-        a = b;
-        b = r;
-    }
-    return(b);
+    return((int) binary_gcd(U abs(a),U abs(b)));
 }
 
 
@@ -370,34 +567,18 @@ int igcd( int a, int b )
 
 
 int gcdrow( int *x, int m )
+/*
+ * gcd of the positive numbers x[0..m].
+ */
 {
 
-  int im,r;
-
-  while (m > 0) {
+  unsigned long long g;
+  int i;
 
-    r = x[0]%x[1];
-    if (r > 1) {
-      x[0] = x[1];
-      for(im = 1; im < m && x[im+1] > r; im++)
-        x[im] = x[im+1];
-      if (m > 1 && im < m && x[im+1] == r) {
-        for (;im < m; im++) 
-          x[im] = x[im+1];
-        m--;
-      }
-      else
-        x[im] = r;
-    }
-    else if (r == 0) {
-      for(im = 0; im < m; im++)
-        x[im] = x[im+1];
-      m--;
-    }
-    else return(1);
-  }
+  for (g = x[0], i = 1; i <= m && g != 1; i++)
+    g = binary_gcd(g,U x[i]);
 
-  return(x[0]);
+  return((int) g);
 
 }
 
@@ -406,33 +587,13 @@ int gcdrow( int *x, int m )
 long int longgcdrow( long int *x, int m )
 {
 
-  int im;
-  long int r;
+  unsigned long long g;
+  int i;
 
-  while (m > 0) {
+  for (g = x[0], i = 1; i <= m && g != 1; i++)
+    g = binary_gcd(g,(unsigned long long) x[i]);
 
-    r = x[0]%x[1];
-    if (r > 1) {
-      x[0] = x[1];
-      for(im = 1; im < m && x[im+1] > r; im++)
-        x[im] = x[im+1];
-      if (m > 1 && im < m && x[im+1] == r) {
-        for (;im < m; im++) 
-          x[im] = x[im+1];
-        m--;
-      }
-      else
-        x[im] = r;
-    }
-    else if (r == 0) {
-      for(im = 0; im < m; im++)
-        x[im] = x[im+1];
-      m--;
-    }
-    else return(1);
-  }
-
-  return(x[0]);
+  return((long int) g);
 
 }
 
@@ -440,33 +601,13 @@ long int longgcdrow( long int *x, int m )
 long long int longlonggcdrow( long long int *x, int m )
 {
 
-  int im;
-  long int r;
-
-  while (m > 0) {
+  unsigned long long g;
+  int i;
 
-    r = x[0]%x[1];
-    if (r > 1) {
-      x[0] = x[1];
-      for(im = 1; im < m && x[im+1] > r; im++)
-        x[im] = x[im+1];
-      if (m > 1 && im < m && x[im+1] == r) {
-        for (;im < m; im++) 
-          x[im] = x[im+1];
-        m--;
-      }
-      else
-        x[im] = r;
-    }
-    else if (r == 0) {
-      for(im = 0; im < m; im++)
-        x[im] = x[im+1];
-      m--;
-    }
-    else return(1);
-  }
+  for (g = x[0], i = 1; i <= m && g != 1; i++)
+    g = binary_gcd(g,(unsigned long long) x[i]);
 
-  return(x[0]);
+  return((long long int) g);
 
 }
 
@@ -480,6 +621,51 @@ long long int longlonggcdrow( long long int *x, int m )
 
 
 
+static void I_row_gcd_prim( RAT *old, RAT *new, int n )
+/*****************************************************************/
+/*
+ * All numerators of "old" are divided by their gcd,
+ * and all denominators of "old" are divided by their gcd.
+ * The result is stored in "new".
+ * Fractions like 0/12 are converted to 0/1.
+ * Uses no global state, so it may be called from parallel code.
+ */
+{
+  unsigned long long gnum,gden;
+  int j;
+
+  /* GCD OF NUMERATOR */
+
+  for (gnum = 0, j = 0; j < n && gnum != 1; j++)
+    gnum = binary_gcd(gnum,(unsigned long long) labs((old+j)->num));
+
+  /* GCD OF DENUMERATOR */
+
+  for (gden = 0, j = 0; j < n && gden != 1; j++)
+    if ((old+j)->num != 0)
+      gden = binary_gcd(gden,U (old+j)->den.i);
+
+  if (gnum > 1 || gden > 1) 
+    for (j = 0; j < n; j++) {
+      (new+j)->num = (old+j)->num/(long) gnum;
+      (new+j)->den.i = ((old+j)->num == 0) ? 1 : ((old+j)->den.i)/(int) gden;
+    }
+  else if (old != new)  
+    for (j = 0; j < n; j++) {
+      (new+j)->num = (old+j)->num;
+      (new+j)->den = (old+j)->den;
+    }
+
+}
+
+
+
+
+
+
+
+
+
 void I_RAT_row_prim( RAT *old, RAT *new, RAT *p, int n )
 /*****************************************************************/
 /*
@@ -493,12 +679,7 @@ void I_RAT_row_prim( RAT *old, RAT *new, RAT *p, int n )
  * Fractions like 0/12 are converted to 0/1.
  */
 {
-  int *x;
-  int m=0,ii,i,j,r;
-
-  x = (int *) allo(CP 0,0,U n*sizeof(int));
-  for(i=0; i<n; i++)
-     x[i] = 0;
+  int i;
 
   /* 
    * Divide the elements of list "old" by "|p|", 
@@ -514,72 +695,45 @@ void I_RAT_row_prim( RAT *old, RAT *new, RAT *p, int n )
   }
 
   else {
+    I_row_gcd_prim(old,new,n);
+  }
 
-    var[0].num = 0;
-    var[0].den.i = 0;
+}
 
-  /* GCD OF NUMERATOR */
 
-    /* 
-     * The array "x" contains all absolute values of numerators
-     * in strictly increasing order,
-     * If the numerator 1 appears, var[0]->num is set to 1.
-     * var[0]->num is then computed as the gcd of "x".
-     */
-    for (j = 0; j < n; j++) {
-      r = abs ((old+j)->num);
-      if (r == 1) { 
-        var[0].num = 1;
-        break;
-      }
-      else if (r  != 0) {
-        for (i = 0; i != m && r < x[i]; i++); 
-        if (r != x[i] || i == m) {
-          for (ii = m; ii > i; ii--) 
-            x[ii] = x[ii-1];
-          x[i] = r;
-          m++;
-        }
-      }
-    }
-    m--;
-    if (var[0].num != 1) var[0].num = gcdrow(x,m);
 
-   /* GCD OF DENUMERATOR */
 
-    m = 0;
-    for (j = 0; j < n; j++) {
-      r = ((old+j)->num == 0) ? 0 : (old+j)->den.i;
-      if (r == 1) { 
-        var[0].den.i = 1;
-        break;
-      }
-      else if (r  != 0) {
-        for (i = 0; i != m && r < x[i]; i++); 
-        if (r != x[i] || i == m) {
-          for (ii = m; ii > i; ii--) 
-            x[ii] = x[ii-1];
-          x[i] = r;
-          m++;
-        }
-      }
-    }
-    m--;
-    if (var[0].den.i != 1) var[0].den.i = gcdrow(x,m);
 
-    if (var[0].num > 1 || var[0].den.i > 1) 
-      for (j = 0; j < n; j++) {
-        (new+j)->num = (old+j)->num/var[0].num;
-        (new+j)->den.i = ((old+j)->num == 0) ? 1 : ((old+j)->den.i)/var[0].den.i;
-    }
-    else if (old != new)  
-      for (j = 0; j < n; j++) {
-        (new+j)->num = (old+j)->num;
-        (new+j)->den = (old+j)->den;
-      }
+
+
+
+
+static int I_row_prim_nc( RAT *old, RAT *new, RAT *p, int n )
+/*****************************************************************/
+/*
+ * Same as I_RAT_row_prim, but without overflow handling:
+ * returns 0 and leaves "new" untouched if "old"/p does not fit
+ * into integers, 1 otherwise.
+ */
+{
+  RAT q,r;
+  int j;
+
+  if (p->num == 0) {
+    I_row_gcd_prim(old,new,n);
+    return(1);
   }
-  
-  x = (int *) allo(CP x,U n*sizeof(int),0);
+
+  q.den.i = abs(p->num);
+  q.num = p->den.i;
+
+  for (j = 0; j < n; j++)
+    if (!I_RAT_mul_nc(old[j],q,&r))
+      return(0);
+  for (j = 0; j < n; j++)
+    I_RAT_mul_nc(old[j],q,new+j);
+
+  return(1);
 
 }
 
@@ -588,7 +742,49 @@ void I_RAT_row_prim( RAT *old, RAT *new, RAT *p, int n )
 
 
 
-   
 
-  
-        
+
+
+void rows_prim( listp *list, int first, int last, int pcol, int n )
+/*****************************************************************/
+/*
+ * Batched RAT_row_prim on the rows list[first..last-1]->sys (in place).
+ * Column pcol of each row is taken as p; if pcol < 0, p = 0, i.e.
+ * numerators and denominators are divided by their gcds.
+ * With integer arithmetic the rows are normalized in parallel.
+ * Rows which would overflow are left alone and redone afterwards
+ * by RAT_row_prim, which then switches to long integer arithmetic.
+ */
+{
+  int i,nover;
+  char *over;
+  RAT *sys;
+
+  if (RAT_row_prim != I_RAT_row_prim || last-first < ROWS_PRIM_PAR) {
+    for (i = first; i < last; i++) {
+      sys = list[i]->sys;
+      (*RAT_row_prim)(sys,sys,(pcol < 0) ? RAT_const : sys+pcol,n);
+    }
+    return;
+  }
+
+  over = allo(CP 0,0,U (last-first));
+  nover = 0;
+
+#pragma omp parallel for private(sys) reduction(+:nover) schedule(guided) copyin(porta_cur)
+  for (i = first; i < last; i++) {
+    sys = list[i]->sys;
+    over[i-first] = !I_row_prim_nc(sys,sys,(pcol < 0) ? RAT_const : sys+pcol,n);
+    nover += over[i-first];
+  }
+
+  if (nover)
+    for (i = first; i < last; i++)
+      if (over[i-first]) {
+        sys = list[i]->sys;
+        (*RAT_row_prim)(sys,sys,(pcol < 0) ? RAT_const : sys+pcol,n);
+      }
+
+  allo(over,U (last-first),0);
+
+}
@@ -43,13 +43,18 @@ REVISED BY ANDREAS LOEBEL
 extern void I_RAT_assign( RAT *, RAT * );
 extern void I_RAT_add( RAT, RAT, RAT * );
 extern void I_RAT_sub( RAT, RAT, RAT * );
+extern int I_RAT_add_nc( RAT, RAT, RAT * );
+extern int I_RAT_sub_nc( RAT, RAT, RAT * );
 extern void I_RAT_mul( RAT, RAT, RAT * );
 extern void I_RAT_row_prim( RAT *, RAT *, RAT *, int );
+extern void rows_prim( listp *, int, int, int, int );
 extern void gauss_calcnewrow( RAT *, RAT *, int, RAT *, int, int );
 extern void vecpr( RAT *, RAT *, RAT *, int );
 extern void row_add( RAT *, RAT *, RAT *, int );
+extern void row_comb( RAT *, RAT *, RAT *, int );
 extern int eqie_satisfied( RAT *, RAT *, int, int );
 extern void scal_mul( RAT *, RAT *, RAT *, int );
+extern unsigned long long binary_gcd( unsigned long long, unsigned long long );
 extern int igcd( int, int );
 extern int gcdrow( int *, int );
 extern long int longgcdrow( long int *, int );
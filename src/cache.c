@@ -0,0 +1,540 @@
+/*******************************************************************************
+
+Copyright (C) 2026 PORTA contributors
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; either version 2 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+
+FILENAME: cache.c
+
+The result cache of xporta (option -r) and of the library: a conversion
+whose input, up to the order, the scaling and the repetition of its rows,
+was converted before takes the output file from the cache directory.
+
+*******************************************************************************/
+
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+
+#include "cache.h"
+#include "common.h"
+#include "arith.h"
+#include "inout.h"
+#include "log.h"
+#include "porta_ctx.h"
+#include <string.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+#if defined WIN32
+#include <direct.h>
+#include <io.h>
+#include <process.h>
+#include <sys/utime.h>
+#define mkdir(d,m) _mkdir(d)
+#define getpid _getpid
+#define utime _utime
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+
+
+
+
+
+
+
+char *cache_dir()
+/*****************************************************************/
+/*
+ * The cache directory: $PORTA_CACHE, or porta.cache in the working
+ * directory.
+ */
+{
+    char *d = getenv("PORTA_CACHE");
+
+    return((d && *d) ? d : CACHE_DIR);
+}
+
+
+
+
+
+
+
+
+static int keyrow_compare( const void *a, const void *b )
+/*****************************************************************/
+/*
+ * Lexicographic order of two key rows; the first entry of a row is
+ * its length.
+ */
+{
+    long *x = *(long **) a, *y = *(long **) b;
+    long j;
+
+    for (j = 1; j <= x[0]; j++)
+        if (x[j] != y[j])
+            return((x[j] < y[j]) ? -1 : 1);
+    return(0);
+}
+
+
+
+
+
+
+
+
+long *cache_key( RAT *ar, int rows, int ndim, int ieq, RAT *valid, long tag, 
+                 long *keylen )
+/*****************************************************************/
+/*
+ * The key of the system of "rows" rows in "ar" (rows of ndim+2 entries
+ * if "ieq", of ndim+1 otherwise) with the valid point "valid" (0, if 
+ * there is none), as described in cache.h. Inequalities, equations and 
+ * cone-points are multiplied by the positive number that makes them 
+ * primitive integer rows, equations are also given a positive first 
+ * nonzero entry. 0, if the system has entries beyond the integer range 
+ * (then it is not cached).
+ */
+{
+    long rowl = ieq ? ndim+2 : ndim+1, n = rows*(2*rowl+1), *rk, **rp, *key;
+    long i, j, k, l, g, t, h = KEY_HEAD(ndim);
+
+    if (MP_realised || rows <= 0)
+        return(0);
+
+    rk = (long *) allo(CP 0,0,U (n*sizeof(long)));
+    rp = (long **) allo(CP 0,0,U (rows*sizeof(long *)));
+
+    for (i = 0; i < rows; i++)
+    {
+        RAT *r = ar+i*rowl;
+        long *x = rp[i] = rk+i*(2*rowl+1);
+
+        x[0] = 2*rowl;
+        /* the last entry tells conv- from cone-points, inequalities from equations */
+        x[2*rowl-1] = (r[rowl-1].num != 0);
+        x[2*rowl] = 1;
+        for (j = 0; j < rowl-1; j++)
+        {
+            if (r[j].den.i <= 0)
+                goto no_key;
+            g = (r[j].num) ? longgcd(labs(r[j].num),r[j].den.i) : r[j].den.i;
+            x[1+2*j] = r[j].num/g;
+            x[2+2*j] = r[j].den.i/g;
+        }
+
+        /* conv-points are not scaled */
+        if (!ieq && r[ndim].num)
+            continue;
+
+        for (l = 1, j = 0; j < rowl-1; j++)
+        {
+            t = l/longgcd(l,x[2+2*j]);
+            if (x[2+2*j] > LONG_MAX/t)
+                goto no_key;
+            l = t*x[2+2*j];
+        }
+        for (g = 0, j = 0; j < rowl-1; j++)
+        {
+            t = l/x[2+2*j];
+            if (labs(x[1+2*j]) > LONG_MAX/t)
+                goto no_key;
+            x[1+2*j] *= t;
+            x[2+2*j] = 1;
+            g = (x[1+2*j]) ? ((g) ? longgcd(g,labs(x[1+2*j])) : labs(x[1+2*j])) : g;
+        }
+        for (j = 0; g > 1 && j < rowl-1; j++)
+            x[1+2*j] /= g;
+
+        /* equations: the first nonzero entry positive */
+        if (ieq && !r[ndim+1].num)
+        {
+            for (j = 0; j < rowl-1 && !x[1+2*j]; j++);
+            if (j < rowl-1 && x[1+2*j] < 0)
+                for (; j < rowl-1; j++)
+                    x[1+2*j] = -x[1+2*j];
+        }
+    }
+
+    qsort(CP rp,rows,sizeof(long *),keyrow_compare);
+
+    key = (long *) allo(CP 0,0,U ((h+n)*sizeof(long)));
+    key[0] = CACHE_VERSION;
+    key[1] = tag;
+    key[2] = ieq;
+    key[3] = ndim;
+    key[5] = (valid != 0);
+    for (j = 0; j < ndim; j++)
+    {
+        if (valid && valid[j].den.i <= 0)
+        {
+            allo(CP key,U ((h+n)*sizeof(long)),0);
+            goto no_key;
+        }
+        g = (!valid) ? 1 : (valid[j].num) ? longgcd(labs(valid[j].num),valid[j].den.i) 
+                                          : valid[j].den.i;
+        key[6+2*j] = (valid) ? valid[j].num/g : 0;
+        key[7+2*j] = (valid) ? valid[j].den.i/g : 1;
+    }
+    for (k = h, i = 0; i < rows; i++)
+        if (i == 0 || keyrow_compare(rp+i,rp+i-1))
+        {
+            memcpy(key+k,rp[i],(2*rowl+1)*sizeof(long));
+            k += 2*rowl+1;
+        }
+    key[4] = (k-h)/(2*rowl+1);
+    *keylen = h+n;
+
+    allo(CP rp,U (rows*sizeof(long *)),0);
+    allo(CP rk,U (n*sizeof(long)),0);
+    return(key);
+
+  no_key:
+    allo(CP rp,U (rows*sizeof(long *)),0);
+    allo(CP rk,U (n*sizeof(long)),0);
+    return(0);
+}
+
+
+
+
+
+
+
+
+void cache_free( long *key, long keylen )
+{
+    if (key)
+        allo(CP key,U (keylen*sizeof(long)),0);
+}
+
+
+
+
+
+
+
+
+unsigned long long cache_hash( char *p, size_t n )
+/*****************************************************************/
+/*
+ * FNV-1a hash of n bytes.
+ */
+{
+    unsigned long long h = 14695981039346656037ULL;
+
+    for (; n; n--)
+    {
+        h ^= (unsigned char) *p++;
+        h *= 1099511628211ULL;
+    }
+    return(h);
+}
+
+
+
+
+
+
+
+
+static long key_size( long *key )
+/*****************************************************************/
+/*
+ * The number of longs of the key that are used (the duplicate rows
+ * removed leave the end of the key unused).
+ */
+{
+    return(KEY_HEAD(key[3])+key[4]*(2*(key[2] ? key[3]+2 : key[3]+1)+1));
+}
+
+
+
+
+
+
+
+
+void cache_name( char *name, char *dir, long *key, long keylen, char *ext )
+/*****************************************************************/
+/*
+ * The name of the entry of "key" in "dir", if "ext" is CACHE_EXT, or
+ * else the name of a file of this process and porta context, for the
+ * files on the way into or out of the cache (then "dir" is made, if
+ * it does not exist).
+ */
+{
+    unsigned long long h = cache_hash(CP key,U (key_size(key)*sizeof(long)));
+
+    if (!strcmp(ext,CACHE_EXT))
+        sprintf(name,"%s/%016llx%s",dir,h,ext);
+    else 
+    {
+        mkdir(dir,0777);
+        sprintf(name,"%s/%016llx.%d.%lx%s",dir,h,(int) getpid(),
+                (unsigned long) porta_cur,ext);
+    }
+}
+
+
+
+
+
+
+
+
+static char *read_whole( char *fname, long *len )
+/*****************************************************************/
+/*
+ * The contents of file "fname" (*len bytes), 0 if it cannot be read.
+ */
+{
+    struct stat st;
+    FILE *f;
+    char *buf;
+
+    if (stat(fname,&st) || !(f = fopen(fname,"rb")))
+        return(0);
+    *len = (long) st.st_size;
+    buf = allo(CP 0,0,U (*len+1));
+    if ((long) fread(buf,1,*len,f) != *len)
+    {
+        allo(buf,U (*len+1),0);
+        buf = 0;
+    }
+    fclose(f);
+    return(buf);
+}
+
+
+
+
+
+
+
+
+int cache_fetch( char *dir, long *key, long keylen, char *fname )
+/*****************************************************************/
+/*
+ * Writes the output file "fname" from the entry of "key" in "dir".
+ * Returns 0, if there is no such entry. An entry that fails the
+ * integrity check is removed.
+ */
+{
+    char name[FILENAME_MAX];
+    struct cache_head head;
+    long len, n = key_size(key), ok;
+    char *buf;
+    FILE *ofp;
+
+    cache_name(name,dir,key,keylen,CACHE_EXT);
+    if (!(buf = read_whole(name,&len)))
+        return(0);
+
+    memcpy(&head,buf,(len < (long) sizeof(head)) ? len : sizeof(head));
+    ok = (len >= (long) sizeof(head)
+          && !memcmp(head.magic,CACHE_MAGIC,8)
+          && head.keylen >= 0 && head.reslen >= 0
+          && len == (long) sizeof(head)+head.keylen*(long) sizeof(long)+head.reslen);
+
+    /* another key of the same hash */
+    if (ok && (head.keylen != n || memcmp(buf+sizeof(head),key,n*sizeof(long))))
+    {
+        allo(buf,U (len+1),0);
+        return(0);
+    }
+
+    if (!ok || cache_hash(buf+len-head.reslen,U head.reslen) != head.sum)
+    {
+        fprintf(prt,"cache entry %s is damaged, removed\n",name);
+        porta_log("cache entry %s is damaged, removed\n",name);
+        remove(name);
+        allo(buf,U (len+1),0);
+        return(0);
+    }
+
+    /* the old output file is kept as wfopen() does */
+    fclose(wfopen(fname));
+    if (!(ofp = fopen(fname,"wb")))
+        msg( "%s : cannot open file", fname, 0 );
+    if ((long) fwrite(buf+len-head.reslen,1,head.reslen,ofp) != head.reslen)
+        msg( "%s : cannot write file", fname, 0 );
+    fclose(ofp);
+    allo(buf,U (len+1),0);
+
+    /* the entries are evicted in the order of their last use */
+    utime(name,0);
+
+    fprintf(prt,"output taken from cache entry %s\n",name);
+    porta_log("output taken from cache entry %s\n",name);
+    return(1);
+}
+
+
+
+
+
+
+
+
+struct cache_entry {
+    char name[FILENAME_MAX];
+    long size;
+    time_t time;
+};
+
+static int entry_compare( const void *a, const void *b )
+{
+    time_t x = ((struct cache_entry *) a)->time, y = ((struct cache_entry *) b)->time;
+
+    return((x < y) ? -1 : (x > y) ? 1 : 0);
+}
+
+
+static void cache_evict( char *dir, long budget )
+/*****************************************************************/
+/*
+ * Removes the entries of "dir" least recently used, until the
+ * entries take at most "budget" bytes.
+ */
+{
+    struct cache_entry *e = 0;
+    long n = 0, i, total = 0;
+    char name[FILENAME_MAX];
+    struct stat st;
+#if defined WIN32
+    struct _finddata_t fd;
+    intptr_t h;
+    char pattern[FILENAME_MAX];
+
+    sprintf(pattern,"%s/*%s",dir,CACHE_EXT);
+    if ((h = _findfirst(pattern,&fd)) == -1)
+        return;
+    do {
+        char *d_name = fd.name;
+#else
+    DIR *d;
+    struct dirent *de;
+
+    if (!(d = opendir(dir)))
+        return;
+    while ((de = readdir(d)) != 0)
+    {
+        char *d_name = de->d_name;
+        size_t l = strlen(d_name);
+
+        if (l <= strlen(CACHE_EXT) || strcmp(d_name+l-strlen(CACHE_EXT),CACHE_EXT))
+            continue;
+#endif
+        sprintf(name,"%s/%s",dir,d_name);
+        if (stat(name,&st))
+            continue;
+        e = (struct cache_entry *) allo(CP e,U (n*sizeof(struct cache_entry)),
+                                        U ((n+1)*sizeof(struct cache_entry)));
+        strcpy(e[n].name,name);
+        e[n].size = (long) st.st_size;
+        e[n].time = st.st_mtime;
+        total += e[n++].size;
+#if defined WIN32
+    } while (!_findnext(h,&fd));
+    _findclose(h);
+#else
+    }
+    closedir(d);
+#endif
+
+    qsort(CP e,n,sizeof(struct cache_entry),entry_compare);
+    for (i = 0; i < n && total > budget; i++)
+        if (!remove(e[i].name))
+        {
+            total -= e[i].size;
+            porta_log("cache entry %s evicted\n",e[i].name);
+        }
+    if (e)
+        allo(CP e,U (n*sizeof(struct cache_entry)),0);
+}
+
+
+
+
+
+
+
+
+void cache_store( char *dir, long budget, long *key, long keylen, char *fname )
+/*****************************************************************/
+/*
+ * Stores the output file "fname" as the entry of "key" in "dir", and
+ * evicts entries to keep the cache within "budget" bytes. The entry is
+ * written under another name first, so that no other process reads an
+ * incomplete entry. Failing to store is not an error.
+ */
+{
+    char name[FILENAME_MAX], tmp[FILENAME_MAX];
+    struct cache_head head;
+    long len, n = key_size(key);
+    char *buf;
+    FILE *ofp;
+    int ok;
+
+    if (!(buf = read_whole(fname,&len)))
+        return;
+    if ((long) sizeof(head)+n*(long) sizeof(long)+len > budget)
+    {
+        allo(buf,U (len+1),0);
+        return;
+    }
+
+    memset(&head,0,sizeof(head));
+    memcpy(head.magic,CACHE_MAGIC,8);
+    head.keylen = n;
+    head.reslen = len;
+    head.sum = cache_hash(buf,U len);
+
+    cache_name(name,dir,key,keylen,CACHE_EXT);
+    cache_name(tmp,dir,key,keylen,".tmp");
+    ok = ((ofp = fopen(tmp,"wb")) != 0);
+    if (ok)
+    {
+        ok = (fwrite(&head,sizeof(head),1,ofp) == 1
+              && (long) fwrite(key,sizeof(long),n,ofp) == n
+              && (long) fwrite(buf,1,len,ofp) == len);
+        ok = !fclose(ofp) && ok;
+    }
+#if defined WIN32
+    remove(name);
+#endif
+    if (ok && !rename(tmp,name))
+    {
+        fprintf(prt,"output stored as cache entry %s\n",name);
+        porta_log("output stored as cache entry %s\n",name);
+        cache_evict(dir,budget);
+    }
+    else
+    {
+        remove(tmp);
+        fprintf(prt,"cannot store cache entry %s\n",name);
+        porta_log("cannot store cache entry %s\n",name);
+    }
+    allo(buf,U (len+1),0);
+}
@@ -0,0 +1,76 @@
+/*******************************************************************************
+
+Copyright (C) 2026 PORTA contributors
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; either version 2 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+
+FILENAME: cache.h
+
+The result cache: output files of earlier conversions, kept in a directory
+under the hash of their canonical input.
+
+*******************************************************************************/
+
+
+#ifndef _CACHE_H
+#define _CACHE_H
+
+
+#include "porta.h"
+
+
+/*
+ * A cache entry "<hash>.cache" holds the header, the key (keylen longs)
+ * and the output file (reslen bytes). The key is the canonical input
+ * system: the rows made primitive (rows of .poi files that are conv-points
+ * reduced only), sorted and without duplicates, preceded by CACHE_VERSION,
+ * the tag, whether it is a .ieq system, dim, the number of rows and the
+ * valid point, which the output repeats (whether there is one, then its
+ * reduced numerators and denominators; KEY_HEAD(dim) entries in all).
+ * The hash of the key names the entry, the hash of the output checks it.
+ */
+#define CACHE_MAGIC "PORTAC\0\1"
+#define CACHE_VERSION 1
+#define CACHE_EXT ".cache"
+#define CACHE_DIR "porta.cache"
+#define CACHE_DEFAULT_MB 256
+#define KEY_HEAD(dim) (6+2*(dim))
+
+/* The options that change the output file */
+#define CACHE_OPTIONS (Binary_out|Unaligned_out|Statistic_of_coefficients|\
+                       Facet_check|Long_arithmetic|Dedup_input)
+
+/* The options whose outputs besides the output file only a conversion gives */
+#define CACHE_BYPASS (Protocol_to_file|Stream_out)
+
+/* The tag of the conversions of the library (xporta tags its output options) */
+#define CACHE_LIBPORTA -1L
+
+struct cache_head {
+    char magic[8];
+    long keylen, reslen;
+    unsigned long long sum;
+};
+
+extern char *cache_dir( void );
+extern long *cache_key( RAT *, int, int, int, RAT *, long, long * );
+extern unsigned long long cache_hash( char *, size_t );
+extern void cache_name( char *, char *, long *, long, char * );
+extern int cache_fetch( char *, long *, long, char * );
+extern void cache_store( char *, long, long *, long, char * );
+extern void cache_free( long *, long );
+
+
+#endif // _CACHE_H
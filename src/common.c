@@ -36,6 +36,10 @@ REVISED BY ANDREAS LOEBEL
 #include "common.h"
 #include "arith.h"
 #include "inout.h"
+#include "cache.h"
+#include "porta_ctx.h"
+#include "omp.h"
+#include <limits.h>
 
 
 
@@ -51,9 +55,10 @@ char* RATallo( RAT *ptr, int nold, int nnew )
 #define get_len(x)  (abs((x)->num) & m0_9)
 #define m0_9    1023
     if (ptr && MP_realised && nold > nnew) 
-        /* free space in ptr[i].den.p  for i>nold */
-        for (i = nold; i < nnew; i++) 
-            allo(CP ptr[i].den.p,U get_len(ptr+1)*szU,0);
+        /* free space in ptr[i].den.p  for i>=nnew */
+        for (i = nnew; i < nold; i++) 
+            if (get_len(ptr+i))
+                allo(CP ptr[i].den.p,U get_len(ptr+i)*szU,0);
     
     /* 
      * Allocate ptr using malloc(),     if nnew = 0,
@@ -87,9 +92,25 @@ char* allo( char *ptr, unsigned oldsize, unsigned newsize )
  * Free ptr, if newsize = 0,
  * Allocate ptr, if newsize > 0, oldsize = 0,
  * Reallocate ptr, if newsize and oldsize are nonzero.
- * Update total_size.
- * But not every ptr allocated with allo() is freed with allo(),
- * so total_size is too high.
+ * Update total_size, the number of bytes currently allocated with allo(),
+ * and its maximum peak_size.
+ * allo() may be called by several threads at a time.
+ */
+{  
+    return(lallo(ptr,oldsize,newsize));
+}
+
+
+
+
+
+
+
+
+char* lallo( char *ptr, size_t oldsize, size_t newsize )
+/*****************************************************************/
+/*
+ * allo() for blocks of 4 GB and more.
  */
 {  
     if( newsize == 0 && oldsize == 0 )
@@ -102,7 +123,7 @@ char* allo( char *ptr, unsigned oldsize, unsigned newsize )
             free(CP ptr);
             ptr = 0;
         }
-        total_size -= oldsize;
+        mem_count(-(long) oldsize);
         return (CP 0);
     }
     
@@ -115,13 +136,13 @@ char* allo( char *ptr, unsigned oldsize, unsigned newsize )
            */
         if ((ptr = (char *) calloc(newsize,1)) == 0)
             msg( "allocation of new space failed", "", 0 );   
-        total_size += newsize;
+        mem_count((long) newsize);
         return(ptr);
     }
     
     if (oldsize != newsize && (ptr = (char *) realloc(ptr,newsize)) == 0) 
         msg( "reallocation of space failed", "", 0 );   
-    total_size += newsize-oldsize;
+    mem_count((long) newsize-(long) oldsize);
     
     return(ptr);
 }
@@ -132,38 +153,160 @@ char* allo( char *ptr, unsigned oldsize, unsigned newsize )
 
 
 
+
+void mem_count( long d )
+/*****************************************************************/
+/*
+ * Add d bytes to total_size and update peak_size.
+ */
+{
+    long t;
+    
+#pragma omp atomic capture
+    t = total_size += d;
+    
+    if (t > peak_size)
+#pragma omp critical (peak)
+        if (t > peak_size)
+            peak_size = t;
+}
+
+
+
+
+
+
+
+
+int mem_exceeded( long more )
+/*****************************************************************/
+/*
+ * Return 1, if a memory budget was set (option -a),
+ * and allocating "more" bytes would exceed it.
+ */
+{
+    return(mem_budget && total_size+more > mem_budget);
+}
+
+
+
+
+
+
+
 //char andreas[20] = "sonmist"; // Seems unused -- removed by J-D B
 
-listp *porta_list;
+/*
+ * The list elements and their marks are taken from pools of chunks 
+ * (the first one holds LIST_POOL elements, every further one twice 
+ * as many as the one before). Chunks are never moved, so the pointers 
+ * in porta_list stay valid, and elements (marks) allocated one after 
+ * the other are adjacent. The chunks are freed by free_lists().
+ */
+#define LIST_POOL 256
+
+#define list_pool (porta_cur->list_pool)
+#define mark_pool (porta_cur->mark_pool)
+#define list_left (porta_cur->list_left)
+#define mark_left (porta_cur->mark_left)
+#define list_size (porta_cur->list_size)
+#define mark_size (porta_cur->mark_size)
+#define chunk (porta_cur->list_chunk)
+#define chunk_size (porta_cur->list_chunk_size)
+#define nchunks (porta_cur->list_chunks)
+
+
+
+
+
+
+
 
-void allo_list( int new, unsigned **markp, int blocks )
+static char *pool_chunk( size_t size )
 {
-    int i,ms;
+    if (nchunks == MAX_CHUNKS)
+        msg( "%sallocation of new space failed: more than %i chunks of list elements", 
+             "", MAX_CHUNKS );   
+    chunk_size[nchunks] = size;
+    return(chunk[nchunks++] = lallo(CP 0,0,size));
+}
+
+
+
+
+
+
+
+
+void allo_list( int new, unsigned **markp, int nblocks )
+{
+    int i;
     
     if (new == maxlist) 
     {
-        maxlist += INCR_LIST;
-        porta_list = (listp *) allo(CP porta_list,1,U maxlist*sizeof(listp));
+        i = maxlist;
+        maxlist = (maxlist < INCR_LIST) ? INCR_LIST : 2*maxlist;
+        porta_list = (listp *) allo(CP porta_list,U i*sizeof(listp),
+                                    U maxlist*sizeof(listp));
         for (i = new; i < maxlist; i++)
                 porta_list[i] = 0;
     }
     if (porta_list[new] == 0)  
     { 
-        porta_list[new] = (struct list *) allo(CP 0,0,U sizeof(struct list));
+        if (!list_left) 
+        {
+            list_size = (list_size) ? 2*list_size : LIST_POOL;
+            list_pool = (struct list *) pool_chunk(list_size*sizeof(struct list));
+            list_left = list_size;
+        }
+        porta_list[new] = list_pool++;
+        list_left--;
         porta_list[new]->mark = 0;
     }
     if (markp)
     {
-        if ( porta_list[new]->mark == 0) 
+        if ( porta_list[new]->mark == 0 && nblocks > 0) 
         {
-            *markp = porta_list[new]->mark = (unsigned *) 
-                allo(CP 0,0,U (ms = blocks*sizeof(unsigned)));
-            for (i = 0; i < blocks; i++)
+            if (mark_left < (size_t) nblocks) 
+            {
+                mark_size = (mark_size) ? 2*mark_size : LIST_POOL*nblocks;
+                if (mark_size < (size_t) nblocks)
+                    mark_size = nblocks;
+                mark_pool = (unsigned *) pool_chunk(mark_size*sizeof(unsigned));
+                mark_left = mark_size;
+            }
+            porta_list[new]->mark = mark_pool;
+            mark_pool += nblocks;
+            mark_left -= nblocks;
+            for (i = 0; i < nblocks; i++)
                 porta_list[new]->mark[i] = 0;
         }
-        else
-            *markp = porta_list[new]->mark;
+        *markp = porta_list[new]->mark;
+    }
+}
+
+
+
+
+
+
+
+
+void free_lists( void )
+/*****************************************************************/
+/*
+ * Free porta_list and the pools of its elements and marks.
+ */
+{
+    while (nchunks)
+    {
+        nchunks--;
+        lallo(chunk[nchunks],chunk_size[nchunks],0);
     }
+    list_left = mark_left = list_size = mark_size = 0;
+    allo(CP porta_list,U maxlist*sizeof(listp),0);
+    porta_list = 0;
+    maxlist = 0;
 }
 
 
@@ -173,7 +316,7 @@ void allo_list( int new, unsigned **markp, int blocks )
 
 
 
-void listptoar( RAT *ar, int rows, int rowl, int blocks )
+void listptoar( RAT *ar, int rows, int rowl, int nblocks )
 {
     int i;
     unsigned j = 0;
@@ -181,7 +324,7 @@ void listptoar( RAT *ar, int rows, int rowl, int blocks )
     
     for (i = 0,arp = ar; i < rows; i++,arp += rowl) 
     {
-        allo_list(i,(unsigned **)&j,blocks);
+        allo_list(i,(unsigned **)&j,nblocks);
         porta_list[i]->sys = arp;
     }
 }
@@ -217,29 +360,65 @@ void get_options( int *argc, char **argv[] )
                 break; 
             case 'o' : option |= Opt_elim;
                 break; 
+            case 'i' : option |= Int_tableau;
+                break; 
+            case 'm' : option |= Modular_arith;
+                break; 
+            case 'b' : option |= Binary_out;
+                break; 
+            case 'u' : option |= Unaligned_out;
+                break; 
+            case 'e' : option |= Stream_out;
+                break; 
+            case 'f' : option |= Facet_check;
+                break; 
+            case 'd' : option |= Dedup_input;
+                break; 
+            case 'a' : option |= Memory_budget;
+                /* the budget in megabytes follows the letter */
+                mem_budget = strtol(s+1,&s,10)*1048576L;
+                if (mem_budget <= 0)
+                    msg( "invalid command line", "", 0 );
+                s--;
+                break; 
+            case 'r' : option |= Result_cache;
+                /* the size of the cache in megabytes may follow the letter */
+                cache_budget = strtol(s+1,&s,10)*1048576L;
+                if (cache_budget < 0)
+                    msg( "invalid command line", "", 0 );
+                if (cache_budget == 0)
+                    cache_budget = CACHE_DEFAULT_MB*1048576L;
+                s--;
+                break; 
             case 'D' : option |= Dim;
                 allowed_options = Dim|Protocol_to_file|Long_arithmetic;
                 break; 
             case 'F' : option |= Fmel;
-                allowed_options = Fmel|Chernikov_rule_off|Protocol_to_file|Long_arithmetic;
+                allowed_options = Fmel|Chernikov_rule_off|Protocol_to_file|Long_arithmetic|
+                    Int_tableau|Modular_arith|Binary_out|Unaligned_out|
+                    Stream_out|Memory_budget|Dedup_input;
                 break; 
             case 'S' : option |= Sort;
-                allowed_options = Sort|Statistic_of_coefficients;
+                allowed_options = Sort|Statistic_of_coefficients|Binary_out|
+                    Unaligned_out;
                 break; 
             case 'T' : option |= Traf;
                 allowed_options = Traf|
                     Chernikov_rule_off|Validity_table_out|
                     Redundance_check|Statistic_of_coefficients|
-                    Protocol_to_file|Opt_elim|Long_arithmetic;
+                    Protocol_to_file|Opt_elim|Long_arithmetic|Int_tableau|
+                    Modular_arith|Binary_out|Unaligned_out|Stream_out|
+                    Facet_check|Memory_budget|Result_cache|Dedup_input;
                 break; 
             case 'C' : option |= Cfctp;
-                allowed_options = Cfctp;
+                allowed_options = Cfctp|Binary_out|Unaligned_out;
                 break; 
             case 'P' : option |= Posie;
-                allowed_options = Posie;
+                allowed_options = Posie|Binary_out|Unaligned_out;
                 break; 
             case 'I' : option |= Iespo;
-                allowed_options = Iespo|Validity_table_out;
+                allowed_options = Iespo|Validity_table_out|Binary_out|
+                    Unaligned_out;
                 break; 
             case 'V' : option |= Vint;
                 allowed_options = Vint;
@@ -296,7 +475,6 @@ void set_I_functions()
 
 
 
-int comp;
 
 
 
@@ -314,7 +492,7 @@ int num_den_comp( RAT *a, RAT *b )
 
 
 
-void sort_eqie_cvce( RAT *ar, int nrows, int rowlen, int *neqcv, int *niece )
+void sort_eqie_cvce( RAT *ar, int nrows, int rlen, int *neqcv, int *niece )
 /*****************************************************************/
 /*
  * Sort the "nrow" inequalities and equations in ar, 
@@ -326,21 +504,300 @@ void sort_eqie_cvce( RAT *ar, int nrows, int rowlen, int *neqcv, int *niece )
  *   niece the number of inequalities.
  */
 {
-    int i,equa;
+    int i,nequa;
     
     /* ar[i][rowlen-1] contains 0 (for equation), 1 (for inequality). */
 
     for (i = 1; i <= nrows; i++)
-        (ar+i*rowlen-1)->den.i = i;
-    comp = rowlen-1;
-    qsort(CP ar,nrows,sizeof(RAT)*rowlen,
+        (ar+i*rlen-1)->den.i = i;
+    comp = rlen-1;
+    qsort(CP ar,nrows,sizeof(RAT)*rlen,
           (int(*)(const void*,const void*))num_den_comp);
-    for (equa = 0; equa < nrows && (ar+rowlen*equa+comp)->num == 0;
-         equa++);
-    *neqcv = equa;
-    *niece = nrows - equa;
+    for (nequa = 0; nequa < nrows && (ar+rlen*nequa+comp)->num == 0;
+         nequa++);
+    *neqcv = nequa;
+    *niece = nrows - nequa;
     for (i = 1; i <= nrows; i++)
-        (ar+i*rowlen-1)->den.i = 1; 
+        (ar+i*rlen-1)->den.i = 1; 
+}
+
+
+
+
+
+
+
+
+
+int int_system( RAT *ar, int n, int ard, int ndim, int poi,
+                 long **m, long **w, long **mx, long *gmx )
+/*****************************************************************/
+/*
+ * Scale the n rows of ar (row distance ard) to integer vectors
+ * (*m)[i*dim],...,(*m)[i*dim+dim-1] by the lcm of the denominators.
+ * (*w)[i] is the scaled right-hand side of an inequality or, for a
+ * point, the scaling factor of a conv-point (0 for a cone-point).
+ * (*mx)[i] and *gmx are the largest absolute values of a row and 
+ * of the system. Return 0, if a row cannot be scaled.
+ */
+{
+    RAT *r;
+    long l,g,d,v,*mp;
+    int i,j,ok = 1;
+    
+    *m = (long *) lallo(CP 0,0,(size_t) n*ndim*sizeof(long)+1);
+    *w = (long *) lallo(CP 0,0,n*sizeof(long)+1);
+    *mx = (long *) lallo(CP 0,0,n*sizeof(long)+1);
+    *gmx = 0;
+    if (MP_realised)
+        return(0);
+    
+#pragma omp parallel for private(r,l,g,d,v,mp,j) reduction(&&:ok) if (n > 256) copyin(porta_cur)
+    for (i = 0; i < n; i++) 
+    {
+        r = ar+(size_t) i*ard;
+        mp = *m+(size_t) i*ndim;
+        for (l = 1, j = 0; j < ndim+!poi; j++) 
+        {
+            d = r[j].den.i;
+            g = (long) binary_gcd(l,d);
+            if (__builtin_mul_overflow(l/g,d,&l))
+                break;
+        }
+        if (j < ndim+!poi) 
+        {
+            ok = 0;
+            continue;
+        }
+        (*mx)[i] = (*w)[i] = poi ? (r[ndim].num ? l : 0) : 0;
+        for (j = 0; j < ndim+!poi; j++) 
+        {
+            if (__builtin_mul_overflow(r[j].num,l/r[j].den.i,&v) 
+                || v == LONG_MIN)
+                break;
+            if (j < ndim)
+                mp[j] = v;
+            else
+                (*w)[i] = v;
+            if (labs(v) > (*mx)[i])
+                (*mx)[i] = labs(v);
+        }
+        if (j < ndim+!poi) 
+            ok = 0;
+    }
+    if (!ok)
+        return(0);
+    
+    for (i = 0; i < n; i++)
+        if ((*mx)[i] > *gmx)
+            *gmx = (*mx)[i];
+    return(1);
+}
+
+
+
+
+
+
+
+
+void free_int_system( int n, int ndim, long *m, long *w, long *mx )
+{
+    lallo(CP m,(size_t) n*ndim*sizeof(long)+1,0);
+    lallo(CP w,n*sizeof(long)+1,0);
+    lallo(CP mx,n*sizeof(long)+1,0);
+}
+
+
+
+
+
+
+
+
+int int_fits( long rmx, long gmx, int ndim )
+/*****************************************************************/
+/*
+ * Can all products of a row with largest value rmx and a row of 
+ * the other system be computed in long integers?
+ */
+{
+    return((long double) (ndim+1) * rmx * gmx < 9.0e18L);
+}
+
+
+
+
+
+
+
+
+static int dedup_key( RAT *row, int m, int flag, int ieq, long *key )
+/*****************************************************************/
+/*
+ * Normal form of the row (m values and the flag) in key[0],...,key[m]:
+ * cone-points, inequalities and equations are scaled to primitive 
+ * integer vectors (equations with their first nonzero value positive), 
+ * key[0] = 0 (-1 for equations). Conv-points are written as 
+ * key[1..m]/key[0], key[0] the least common denominator. 
+ * Return 0, if the normal form exceeds the long integers.
+ */
+{
+    long l = 1,g,d;
+    unsigned long long u = 0;
+    int j;
+    
+    for (j = 0; j < m; j++) 
+    {
+        d = row[j].den.i;
+        if (d <= 0)
+            return(0);
+        if (!ieq && flag)
+            d /= (long) binary_gcd(labs(row[j].num),d);
+        g = (long) binary_gcd(l,d);
+        if (__builtin_mul_overflow(l/g,d,&l))
+            return(0);
+    }
+    for (j = 0; j < m; j++) 
+    {
+        g = (!ieq && flag) ? (long) binary_gcd(labs(row[j].num),row[j].den.i) : 1;
+        if (__builtin_mul_overflow(row[j].num/g,l/(row[j].den.i/g),key+j+1))
+            return(0);
+        u = binary_gcd(u,(unsigned long long) labs(key[j+1]));
+    }
+    
+    if (!ieq && flag) 
+    {
+        /* conv-point */
+        key[0] = l;
+        return(1);
+    }
+    
+    if (u > 1)
+        for (j = 1; j <= m; j++)
+            key[j] /= (long) u;
+    key[0] = 0;
+    if (ieq && !flag) 
+    {
+        key[0] = -1;
+        for (j = 1; j <= m && !key[j]; j++);
+        if (j <= m && key[j] < 0)
+            for (; j <= m; j++)
+                key[j] = -key[j];
+    }
+    return(1);
+}
+
+
+
+
+
+
+
+
+int dedup_rows( RAT *ar, int nrows, int rowl, int ieq )
+/*****************************************************************/
+/*
+ * Remove the rows of "ar" ("nrows" rows of length "rowl", the last
+ * element is 0 for cone-points and equations, 1 for conv-points and
+ * inequalities) that are equal to an earlier row up to the scaling
+ * of dedup_key(). Return the number of rows left.
+ *
+ * The normal forms and their hash values are computed in parallel,
+ * then every thread looks for the duplicates among the rows whose 
+ * hash value belongs to it, in its own hash table.
+ */
+{
+    int i,j,k,nt,*tab,*cnt;
+    long *key;
+    unsigned long long *hash,h;
+    char *dup;
+    
+    if (nrows < 2 || MP_realised)
+        return(nrows);
+    
+    key = (long *) lallo(CP 0,0,(size_t) nrows*rowl*sizeof(long));
+    hash = (unsigned long long *) lallo(CP 0,0,nrows*sizeof(hash[0]));
+    dup = allo(CP 0,0,U nrows);
+    
+#pragma omp parallel for private(j,h) if (nrows > 10000) copyin(porta_cur)
+    for (i = 0; i < nrows; i++) 
+    {
+        long *kp = key+(size_t) i*rowl;
+        
+        dup[i] = 0;
+        if (!dedup_key(ar+(size_t) i*rowl,rowl-1,
+                       (ar+(size_t) i*rowl+rowl-1)->num != 0,ieq,kp)) 
+        {
+            /* not compared */
+            hash[i] = 0;
+            dup[i] = 2;
+            continue;
+        }
+        for (h = 14695981039346656037ULL, j = 0; j < rowl; j++)
+            h = (h ^ (unsigned long long) kp[j]) * 1099511628211ULL;
+        hash[i] = h;
+    }
+    
+    nt = omp_get_max_threads();
+    if (nrows <= 10000)
+        nt = 1;
+    cnt = (int *) allo(CP 0,0,U nt*sizeof(int));
+    for (k = 0; k < nt; k++)
+        cnt[k] = 0;
+    for (i = 0; i < nrows; i++)
+        if (!dup[i])
+            cnt[hash[i] % nt]++;
+    
+#pragma omp parallel for private(i,j,h,tab) num_threads(nt) copyin(porta_cur)
+    for (k = 0; k < nt; k++) 
+    {
+        int size;
+        
+        for (size = 2; size < 2*cnt[k]; size *= 2);
+        tab = (int *) allo(CP 0,0,U size*sizeof(int));
+        for (j = 0; j < size; j++)
+            tab[j] = -1;
+        for (i = 0; i < nrows; i++) 
+        {
+            if (dup[i] || hash[i] % nt != (unsigned long long) k)
+                continue;
+            for (h = (hash[i]/nt) & (size-1); tab[h] >= 0; h = (h+1) & (size-1))
+                if (hash[tab[h]] == hash[i] 
+                    && !memcmp(key+(size_t) tab[h]*rowl,key+(size_t) i*rowl,
+                               rowl*sizeof(long)))
+                    break;
+            if (tab[h] >= 0)
+                dup[i] = 1;
+            else
+                tab[h] = i;
+        }
+        allo(CP tab,U size*sizeof(int),0);
+    }
+    
+    for (i = k = 0; i < nrows; i++)
+        if (dup[i] != 1) 
+        {
+            if (i != k)
+                memmove(ar+(size_t) k*rowl,ar+(size_t) i*rowl,rowl*sizeof(RAT));
+            k++;
+        }
+    
+    if (k < nrows) 
+    {
+        fprintf(prt,"duplicate %s removed  : %4i \n\n",
+                ieq ? "inequalities" : "points      ",nrows-k);
+
+        /* 17.01.1994: include logging on file porta.log */
+        porta_log( "duplicate %s removed  : %4i \n\n",
+                   ieq ? "inequalities" : "points      ",nrows-k);
+    }
+    
+    allo(CP cnt,U nt*sizeof(int),0);
+    allo(dup,U nrows,0);
+    lallo(CP hash,nrows*sizeof(hash[0]),0);
+    lallo(CP key,(size_t) nrows*rowl*sizeof(long),0);
+    return(k);
 }
 
 
@@ -361,6 +818,13 @@ void msg( char *s, char *s2, int i )
         porta_log( s, s2, i );
         porta_log( "\n" );
 
+        /* the library stops a conversion of a batch by on_error() */
+        if (on_error) {
+            char text[256];
+            
+            snprintf(text,sizeof(text),s,s2,i);
+            (*on_error)(text);
+        }
         exit(1);
 
 }
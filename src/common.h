@@ -39,15 +39,21 @@ REVISED BY ANDREAS LOEBEL
 #include "porta.h"
 #include "log.h"
 
-extern int comp; // Added by J-D B to allow initialization in libporta.cpp
 
 extern void initialize( );
 extern void set_I_functions( );
 extern void sort_eqie_cvce( RAT *, int, int, int *, int * );
+extern int dedup_rows( RAT *, int, int, int );
+extern int int_system( RAT *, int, int, int, int, long **, long **, long **, long * );
+extern void free_int_system( int, int, long *, long *, long * );
+extern int int_fits( long, long, int );
 extern void listptoar( RAT *, int, int, int );
 extern void get_options( int *, char **[] );
 extern void allo_list( int, unsigned **, int );
+extern void free_lists( void );
 extern void msg( char *, char *, int );
+extern void mem_count( long );
+extern int mem_exceeded( long );
 
 char* RATallo( RAT *, int, int ); // Added by J-D B on 26.2.2013 for compatibility with portalib.cpp library.
 
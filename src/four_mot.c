@@ -40,6 +40,8 @@ REVISED BY ANDREAS LOEBEL
 #include "common.h"
 #include "mp.h"
 #include "log.h"
+#include "inout.h"
+#include "porta_ctx.h"
 #include "limits.h"
 
 #include "omp.h"
@@ -47,15 +49,24 @@ REVISED BY ANDREAS LOEBEL
 #define INCR_CMB 100000
 #define MAX_EL_CMB 5000000
 
-int blocks; /* set in fourier_motzkin, used in red_test */
-int itr, totalineq = 0;
+#define hest1 (porta_cur->hest1)
+#define hest2 (porta_cur->hest2)
+#define hest3 (porta_cur->hest3)
+#define oestr1 (porta_cur->oestr1)
+#define oestr2 (porta_cur->oestr2)
+#define oestr3 (porta_cur->oestr3)
+#define oestr4 (porta_cur->oestr4)
 
 
-char hest1[7],hest2[7],hest3[7];
-char oestr1[10],oestr2[10],oestr3[10],oestr4[10];
+/*
+ * Option Stream_out: the file receiving the final inequalities
+ * during the elimination, and their number.
+ */
+#define stream_fp (porta_cur->stream_fp)
+#define nstream (porta_cur->nstream)
 
 
-int parallelize = 0; // Tells whether the parallelized or the standard version of "fourier_motzkin" should be used. (This variable get changed dynamically later in the file)
+#define parallelize (porta_cur->parallelize) // Tells whether the parallelized or the standard version of "fourier_motzkin" should be used. (This variable get changed dynamically later in the file)
 
 
 
@@ -131,8 +142,8 @@ void print_head_line_parallel()
 
 
 
-void gauss( int traf, int sysrow, int eqrl, int dim, int equa_in,
-            int *ineq, int *equa, int indx[] )
+void gauss( int traf, int sysrow, int eqrl, int ndim, int equa_in,
+            int *nineq, int *nequa, int indx[] )
 /*****************************************************************/
 /*
  * Perform Gauss-Elimination
@@ -207,7 +218,7 @@ void gauss( int traf, int sysrow, int eqrl, int dim, int equa_in,
     print_head_line();
 
     /* GAUSS - ELIMINATION */
-    ineq_in = *ineq;    /* reduced by one for each pivot on a y-variable */
+    ineq_in = *nineq;    /* reduced by one for each pivot on a y-variable */
 
     for (itr = equa_in; itr != 0; itr--)
     {
@@ -227,13 +238,13 @@ void gauss( int traf, int sysrow, int eqrl, int dim, int equa_in,
             /* Equality for the finite system found */
             /* Store it in ar4 */
             nel_ar4 += eqrl;
-            ar4 = (RAT *) RATallo(CP ar4,U nel_ar4-eqrl,U nel_ar4);
-            sptr = ar4+(*equa)*eqrl;
+            ar4 = (RAT *) RATallo(ar4,U nel_ar4-eqrl,U nel_ar4);
+            sptr = ar4+(*nequa)*eqrl;
 
-            col = sysrow-dim-1+*equa;
-            for (i = 0; i < dim-*equa; i++)
+            col = sysrow-ndim-1+*nequa;
+            for (i = 0; i < ndim-*nequa; i++)
                 (*RAT_assign)(sptr+indx[col+i],ar2+col+i);
-            for (; i < dim; i++)
+            for (; i < ndim; i++)
             {
                 (*RAT_assign)((sptr+indx[col+i]),RAT_const);
             }
@@ -256,10 +267,10 @@ void gauss( int traf, int sysrow, int eqrl, int dim, int equa_in,
          * The pivot variable is removed and porta_list[ineq+row-1]->sys
          * shortened by 1.
          */
-        for (row = 1; row < ineq_in-*equa; row++)
+        for (row = 1; row < ineq_in-*nequa; row++)
         {
             gauss_calcnewrow(porta_list[0]->sys,porta_list[row]->sys,pivcol,
-                             porta_list[(*ineq)+row-1]->sys,1,sysrow);
+                             porta_list[(*nineq)+row-1]->sys,1,sysrow);
         }
 
         if (indx[pivcol] < 0 && traf)
@@ -272,20 +283,20 @@ void gauss( int traf, int sysrow, int eqrl, int dim, int equa_in,
             for (col = 0,i = 0; col < sysrow; col++)
                 if (col != pivcol)
                 {
-                    (*RAT_assign)(porta_list[*ineq + ineq_in-*equa-1]->sys+i,
+                    (*RAT_assign)(porta_list[*nineq + ineq_in-*nequa-1]->sys+i,
                                   porta_list[0]->sys+col);
                     i++;
                 }
             if (pivot->num < 0)
                 for (col = 0,i = 0; col < sysrow; col++)
-                    (porta_list[*ineq + ineq_in-*equa-1]->sys+col)->num *= -1;
+                    (porta_list[*nineq + ineq_in-*nequa-1]->sys+col)->num *= -1;
         }
 
         /* Rows in "ar2" are now 1 element shorter */
         (sysrow)--;
 
         if (indx[pivcol] >= 0)
-            (*equa)++;
+            (*nequa)++;
         else
         {
             if (!traf)
@@ -297,60 +308,194 @@ void gauss( int traf, int sysrow, int eqrl, int dim, int equa_in,
          * to porta_list[0]->sys, ..., porta_list[ineq_in-equa-1]->sys.
          */
         sptr = ar2;
-        for (row = 1; row <= ineq_in-*equa; row++)
+        for (row = 1; row <= ineq_in-*nequa; row++)
         {
-            (*RAT_row_prim)(porta_list[*ineq+row-1]->sys,sptr,
-                            porta_list[*ineq+row-1]->sys+sysrow-1,sysrow);
+            (*RAT_row_prim)(porta_list[*nineq+row-1]->sys,sptr,
+                            porta_list[*nineq+row-1]->sys+sysrow-1,sysrow);
             porta_list[row-1]->sys = sptr;
             sptr += sysrow;
         }
-        for (row = ineq_in-*equa; row <= 2*(*ineq)-1; row++)
+        for (row = ineq_in-*nequa; row <= 2*(*nineq)-1; row++)
         {
             porta_list[row]->sys = sptr;
             sptr += sysrow;
         }
 
-        for (sptr=ar2, j=sysrow*(ineq_in-*equa), i=nz=ld = 0;
-             i < sysrow*(ineq_in-*equa);
+        for (sptr=ar2, j=sysrow*(ineq_in-*nequa), i=nz=ld = 0;
+             i < sysrow*(ineq_in-*nequa);
              i++,sptr++)
             size_info(sptr,&nz,&ld);
 
         /* Update indx */
         i = indx[pivcol];
-        for (col = pivcol; col <= sysrow-2+*equa; col++)
+        for (col = pivcol; col <= sysrow-2+*nequa; col++)
             indx[col] = indx[col+1];
         if (i>=0)
-            indx[sysrow-2+*equa] = i;
+            indx[sysrow-2+*nequa] = i;
 
 #if defined WIN32
 
         fprintf(prt,
-                "|%6i |%11i |%9i |%5i |%4c |%7.2f |%8i |%10.2f |\n",
+                "|%6i |%11i |%9i |%5i |%4c |%7.2f |%8li |%10.2f |\n",
                 itr, itr, ineq_in-itr+1, ld,MP_realised?'y':'n',
                 (float)nz/(float)j, total_size/1000, total_time());
 
         /* 17.01.1994: include logging on file porta.log */
-        porta_log( "|%6i |%11i |%9i |%5i |%4c |%7.2f |%8i |%10.2f |\n",
+        porta_log( "|%6i |%11i |%9i |%5i |%4c |%7.2f |%8li |%10.2f |\n",
             itr, itr, ineq_in-itr+1, ld,MP_realised?'y':'n',
             (float)nz/(float)j, total_size/1000, total_time());
 
 #else // WIN32
 
         fprintf(prt,
-                "|%6i |%11i |%9i |%5i |%4c |%7.2f |%8i |%10.2f |%10.2f |\n",
+                "|%6i |%11i |%9i |%5i |%4c |%7.2f |%8li |%10.2f |%10.2f |\n",
                 itr, itr, ineq_in-itr+1, ld,MP_realised?'y':'n',
                 (float)nz/(float)j, total_size/1000, time_used(),
                 total_time());
 
         /* 17.01.1994: include logging on file porta.log */
-        porta_log( "|%6i |%11i |%9i |%5i |%4c |%7.2f |%8i |%10.2f |%10.2f |\n",
+        porta_log( "|%6i |%11i |%9i |%5i |%4c |%7.2f |%8li |%10.2f |%10.2f |\n",
             itr, itr, ineq_in-itr+1, ld,MP_realised?'y':'n',
             (float)nz/(float)j, total_size/1000, time_used(),
             total_time());
 
 #endif // WIN32
     }
-    *ineq = ineq_in;
+    *nineq = ineq_in;
+}
+
+
+
+
+
+
+
+
+
+static int stream_final( RAT *sys, int from, int niterat, int nieq, 
+                         int *elim_ord )
+/*****************************************************************/
+/*
+ * Does the Fourier-Motzkin inequality "sys" survive the elimination of 
+ * the variables "from",...,"niterat"-1 (i.e. the columns of "ar2")?
+ * Inequalities are never removed but by the elimination of a variable,
+ * where "fmel" removes those with a nonzero coefficient, "traf" those
+ * with a negative coefficient (the positive ones are kept because of
+ * the implicit constraints -x <= 0). sys[0] is used for the products.
+ */
+{
+    int k;
+    
+    for (k = from; k < niterat; k++) 
+    {
+        vecpr(ar2+nieq*((elim_ord)?elim_ord[k]:k), sys+1, sys, nieq);
+        if (sys->num < 0 || (elim_ord && sys->num))
+            return(0);
+    }
+    return(1);
+}
+
+
+
+
+
+
+
+
+
+static void stream_rows( int first, int last, int from, int niterat, 
+                         int nieq, int rowl, int *elim_ord, int *indx )
+/*****************************************************************/
+/*
+ * Write those of the inequalities porta_list[first],...,porta_list[last-1]
+ * to stream_fp, which are final (see stream_final()). 
+ * They are computed as at the end of fourier_motzkin(), in the reserved 
+ * elements at the beginning of "ar3", and made integer as by no_denom()
+ * (by L_RAT_row_int() in multiple precision).
+ */
+{
+    int i,j,n = rowl-niterat;
+    long l;
+    
+    for (i = first; i < last; i++)
+    {
+        if (!stream_final(porta_list[i]->sys,from,niterat,nieq,elim_ord))
+            continue;
+        for (j = 0; j < n; j++)
+            vecpr(ar2+nieq*((elim_ord)?elim_ord[niterat+j]:niterat+j), 
+                  porta_list[i]->sys+1, ar3+j, nieq);
+        (*RAT_row_prim)(ar3,ar3,ar3+n-1,n);
+        
+        /* 0x <= 0, 0x <= 1 are removed at the end */
+        for (j = 0; j < n-1 && !ar3[j].num; j++);
+        if (j == n-1 && ar3[j].num >= 0)
+            continue;
+        
+        if (MP_realised)
+            L_RAT_row_int(ar3,n);
+        else 
+        {
+            for (l = 1, j = 0; j < n && l <= INT_MAX; j++)
+                l = l/longgcd(l,ar3[j].den.i)*ar3[j].den.i;
+            for (j = 0; j < n && l <= INT_MAX 
+                     && labs(ar3[j].num) <= INT_MAX/(l/ar3[j].den.i); j++);
+            if (j == n)
+                for (j = 0; j < n; j++) 
+                {
+                    ar3[j].num *= l/ar3[j].den.i;
+                    ar3[j].den.i = 1;
+                }
+        }
+        
+        (*writeline)(stream_fp,n,ar3,0,(RAT *) 0,'<',indx);
+        fprintf(stream_fp,"\n");
+        nstream++;
+    }
+    fflush(stream_fp);
+}
+
+
+
+
+
+
+
+
+
+static void budget_stop( int iter, int nineq, long more )
+/*****************************************************************/
+/*
+ * The memory budget of option -a does not allow "more" further bytes
+ * in iteration "itr" of fourier_motzkin(). 
+ * Close the file written with option -e, so that it holds the final
+ * inequalities found so far, and stop with a diagnostic.
+ */
+{
+    if (stream_fp)
+    {
+        fprintf(stream_fp,"\nEND\n");
+        wfclose(stream_fp);
+        stream_fp = 0;
+    }
+    
+    fprintf(prt,"\n\nmemory budget of %li kbytes exceeded in iteration %i with %i inequalities\n",
+            mem_budget/1000,iter,nineq);
+    if (more)
+        fprintf(prt,"(%li kbytes in use, %li kbytes more needed)\n",
+                total_size/1000,(more+999)/1000);
+    else
+        fprintf(prt,"(%li kbytes in use)\n",total_size/1000);
+    
+    /* 17.01.1994: include logging on file porta.log */
+    porta_log( "\n\nmemory budget of %li kbytes exceeded in iteration %i with %i inequalities\n",
+               mem_budget/1000,iter,nineq);
+    if (more)
+        porta_log( "(%li kbytes in use, %li kbytes more needed)\n",
+                   total_size/1000,(more+999)/1000);
+    else
+        porta_log( "(%li kbytes in use)\n",total_size/1000);
+    
+    msg( "memory budget exceeded - try again with a larger budget (`-a' option)", "", 0 );
 }
 
 
@@ -398,19 +543,25 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
  * "ar2" does not contain the "-x[i]<=0" inequalities for the variables
  * to be eliminated.
  * These inequalities are treated implicitly by the algorithm.
+ *
+ * If "Stream_out" is set, the inequalities that are final (they survive
+ * all remaining iterations) are written to file "fname" as soon as they 
+ * are generated (see stream_rows()). The complete system is written by
+ * the caller as before.
  */
 {
     struct list *iep;
     int elcol,col = 0,maxnumineq = 0;
     int sysrow,i,j,pos,zer,neg,new,p,n,nn,s=1,minineq = 0, nel_xxx;
-    RAT *sptr,*sysp,*iesp,*ar3bd,*xxx,sw;
+    RAT *sptr,*sysp,*iesp,*ar3bd,*sysbd,*xxx,sw;
     unsigned *newmark,nmark;
-    int ld,nz,nf_dstf=0,finie = 0,nel_cmb;
+    int ld,nz,nf_dstf=0,finie = 0,nel_cmb,mod = 0;
+    long mb;
     register unsigned *nmp,*lnm,*o1mp,*o2mp;
     FILE *fie;
     int *cmb,*bdcmb,*cmbp;
 
-    printf("\n \n \n INT_MAX = %i \n \n \n",INT_MAX);
+    fprintf(prt,"\n \n \n INT_MAX = %i \n \n \n",INT_MAX);
     /////* This is a quick test to verify if parallelization works here : */
     //int threads = 100;
     //int id = 100;
@@ -454,6 +605,18 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
         strcpy(oestr4,"--------|\0");
     }
 
+    if (is_set(Stream_out) && fname)
+    {
+        stream_fp = wfopen(fname);
+        fprintf(stream_fp,"DIM = %d\n\nINEQUALITIES_SECTION\n",dim);
+        nstream = 0;
+        
+        fprintf(prt,"\nwriting final inequalities to file %s\n\n",fname);
+
+        /* 17.01.1994: include logging on file porta.log */
+        porta_log( "\nwriting final inequalities to file %s\n\n",fname);
+    }
+
     strcpy(hest1," upper");
     strcpy(hest2," bound");
     strcpy(hest3,"# ineq");
@@ -462,7 +625,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 
     /* transponation of the inequalities */
 
-    ar2 =  (RAT *) RATallo(CP ar2,nel_ar2,U 2*nieq*rowl);
+    ar2 =  (RAT *) RATallo(ar2,nel_ar2,U 2*nieq*rowl);
     sptr = ar2+nieq*rowl;
 
     /*
@@ -475,7 +638,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
     sptr = ar2+nieq*rowl;
     for (i = 0; i < nieq*rowl; i++)
         (*RAT_assign)(ar2+i,sptr++);
-    ar2 =  (RAT *) RATallo(CP ar2,U 2*nieq*rowl,U nieq*rowl);
+    ar2 =  (RAT *) RATallo(ar2,U 2*nieq*rowl,U nieq*rowl);
     nel_ar2 = nieq*rowl;
 
     sysrow = nieq+1;
@@ -491,7 +654,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
     if (rowl-niterat > FIRST_SYS_EL)
         msg( "rowl too big or FIRST_SYS_EL too small", "", 0 );
     nel_ar3 = (FIRST_SYS_EL+(nieq+1)*nieq);
-    ar3 = (RAT *) RATallo(CP ar3,0,U nel_ar3);
+    ar3 = (RAT *) RATallo(ar3,0,U nel_ar3);
     ar3bd = ar3+nel_ar3-1;
 
     sysp = ar3+rowl-niterat; /* first not reserved element */
@@ -542,6 +705,9 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
                                     * that is, set newmark[] := 2 power(i mod 32)*/
     }
 
+    if (stream_fp)
+        stream_rows(0,nieq,0,niterat,nieq,rowl,elim_ord,indx);
+
 
 
 
@@ -586,7 +752,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
             lnm = newmark+blocks;
             nf_dstf = 0;
 
-            cmbp = cmb = (int *) malloc(INCR_CMB*sizeof(int));
+            cmbp = cmb = (int *) allo(CP 0,0,U INCR_CMB*sizeof(int));
             bdcmb = cmb+INCR_CMB-3;
             nel_cmb = INCR_CMB;
 
@@ -610,8 +776,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
                             if (nel_cmb+INCR_CMB > MAX_EL_CMB)  /* no sence */
                                 goto break_opt_elim;
                             pos = cmbp - cmb;
-                            if(!(cmb = (int *) realloc(CP cmb,(INCR_CMB+nel_cmb)*sizeof(int))))
-                                goto break_opt_elim;
+                            cmb = (int *) allo(CP cmb,U nel_cmb*sizeof(int),U (INCR_CMB+nel_cmb)*sizeof(int));
                             nel_cmb += INCR_CMB;
                             bdcmb = cmb+nel_cmb-3;
                             cmbp = cmb + pos;
@@ -664,7 +829,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
             }
             if ((nf_dstf = nn) > finie)
             {
-                if (poi_file)
+                if (poi_file && !stream_fp)
                 {
                     fie = fopen (fname,"a");
                     for (i = ineq-1; nn > finie; i--)
@@ -690,7 +855,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
                 nf_dstf = -neg;
 
             break_opt_elim : ;
-            free(CP cmb);
+            allo(CP cmb,U nel_cmb*sizeof(int),0);
         }   /* end of the "minimal ineq heuristic" */
 
         /*
@@ -799,11 +964,15 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
         /*
          * Normalize the inequality by multiplying it with a positive constant,
          * such that the variable to be eliminated has coefficient +1, 0, or -1.
+         * (Not with Int_tableau, where the rows stay primitive integer vectors
+         * and row_comb() takes care of the coefficients, as long as
+         * the native integer arithmetic suffices.)
          */
-        for (p = 0; p != zer; p++)
-            (*RAT_row_prim)(porta_list[p]->sys,porta_list[p]->sys,porta_list[p]->sys,sysrow);
-        for (p = neg; p != ineq; p++)
-            (*RAT_row_prim)(porta_list[p]->sys,porta_list[p]->sys,porta_list[p]->sys,sysrow);
+        if (!is_set(Int_tableau) || MP_realised)
+        {
+            rows_prim(porta_list,0,zer,0,sysrow);
+            rows_prim(porta_list,neg,ineq,0,sysrow);
+        }
 
         // We decide if we want to use the parallelized code for this run or not
 		//if ( ((nf_dstf) && (minineq+ineq > 10000000)) || ((~nf_dstf) && (((elim_ord?(neg-zer):neg)+zer*(ineq-neg))>10000000)) )
@@ -837,13 +1006,13 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 				int co = 0;
 				for (co = 0; co < zer*(ineq-neg); co++)
 					allo_list(new+co,&newmark,blocks);
-				printf("Memory allocated for this round...");
+				fprintf(prt,"Memory allocated for this round...");
 
 				for (p = 0; p < zer; p++)
 				{
 					int new0 = 0; // We keep a reference of where we are in the list of created inequalities
 					new0 = new;
-					#pragma omp parallel for
+					#pragma omp parallel for copyin(porta_cur)
 					for(n = neg; n < ineq; n++)
 					{
 						porta_list[new0+n-neg]->sys = porta_list[p]->sys;
@@ -851,7 +1020,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 					}
 					new = new0 + ineq - neg;
 				}
-				printf("This part is finished.");
+				fprintf(prt,"This part is finished.");
 			} else {
 				for (p = 0; p != zer; p++)
 				{
@@ -881,21 +1050,13 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 			int aBunch = ineq-neg; // Chunks of memory allocation.
 			for(co1 = 0; co1 < omp_get_max_threads(); co1++)
 			{
-				selectionThread[co1][0] = (int*) realloc((int*) NULL, aBunch*sizeof(int));
-				if (selectionThread[co1][0] == NULL) {
-					printf("Error allocating memory");
-					exit(1);
-				}
-				selectionThread[co1][1] = (int*) realloc((int*) NULL, aBunch*sizeof(int));
-				if (selectionThread[co1][1] == NULL) {
-					printf("Error allocating memory");
-					exit(1);
-				}
+				selectionThread[co1][0] = (int*) allo(CP 0,0,U aBunch*sizeof(int));
+				selectionThread[co1][1] = (int*) allo(CP 0,0,U aBunch*sizeof(int));
 			}
 
             /* for all inequalities with positive coefficients */
             //printf("\nComing through here... [zer, ineq-neg] = [%i, %i]\n", zer, ineq-neg);
-			#pragma omp parallel for schedule(guided) private(n)
+			#pragma omp parallel for schedule(guided) private(n) copyin(porta_cur)
 			for (p = 0; p < zer; p++)
 //			for (n = neg; n < ineq; n++)
             {
@@ -1034,16 +1195,8 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 						 * behaves in this case (whether it is necessarily thread-safe). */
 						#pragma omp critical(allocateMore)
 						{
-							selectionThread[omp_get_thread_num()][0] = (int*) realloc(selectionThread[omp_get_thread_num()][0], (nbSelectedThread[omp_get_thread_num()]/aBunch + 1)*aBunch*sizeof(int));
-							if (selectionThread[omp_get_thread_num()][0] == NULL) {
-								printf("Error allocating memory");
-								exit(1);
-							}
-							selectionThread[omp_get_thread_num()][1] = (int*) realloc(selectionThread[omp_get_thread_num()][1], (nbSelectedThread[omp_get_thread_num()]/aBunch + 1)*aBunch*sizeof(int));
-							if (selectionThread[omp_get_thread_num()][1] == NULL) {
-								printf("Error allocating memory");
-								exit(1);
-							}
+							selectionThread[omp_get_thread_num()][0] = (int*) allo(CP selectionThread[omp_get_thread_num()][0], U (nbSelectedThread[omp_get_thread_num()]/aBunch)*aBunch*sizeof(int), U (nbSelectedThread[omp_get_thread_num()]/aBunch + 1)*aBunch*sizeof(int));
+							selectionThread[omp_get_thread_num()][1] = (int*) allo(CP selectionThread[omp_get_thread_num()][1], U (nbSelectedThread[omp_get_thread_num()]/aBunch)*aBunch*sizeof(int), U (nbSelectedThread[omp_get_thread_num()]/aBunch + 1)*aBunch*sizeof(int));
 						} // end of critical region
 					}
 
@@ -1077,7 +1230,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 			for(co1 = 0; co1 < omp_get_max_threads(); co1++)
 				accumulator += nbSelectedThread[co1];
 				//printf("%i ", nbSelectedThread[co1]);
-			printf("-> %11i ", (elim_ord?(neg-zer):neg)+accumulator);
+			fprintf(prt,"-> %11i ", (elim_ord?(neg-zer):neg)+accumulator);
 			//printf("\n");
 			for(co1 = 0; co1 < omp_get_max_threads(); co1++)
 			for(co2 = 0; co2 < nbSelectedThread[co1]; co2++)
@@ -1221,15 +1374,15 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 			// Ok, now we can desallocate this memory.
 			for(co1 = 0; co1 < omp_get_max_threads(); co1++)
 			{
-				free(selectionThread[co1][0]);
-				free(selectionThread[co1][1]);
+				allo(CP selectionThread[co1][0], U (nbSelectedThread[co1]/aBunch + 1)*aBunch*sizeof(int), 0);
+				allo(CP selectionThread[co1][1], U (nbSelectedThread[co1]/aBunch + 1)*aBunch*sizeof(int), 0);
 			}
 
 
         } /* if the Chernikov-rules were used (with parallelization) */
         else
         {
-			printf("               ");
+			fprintf(prt,"               ");
             /* for all inequalities with positive coefficients */
 			for (p = 0; p < zer; p++)
             {
@@ -1362,40 +1515,57 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
         } /* if the Chernikov-rules were used (without parallelization) */
 
         /* numerical phase */
+        sysbd = ar3bd;
+        if (mem_budget)
+        {
+            /* space for the new inequalities not yet allocated */
+            mb = (long) (new-ineq)*sysrow - (ar3bd+1-sptr) - sys_chunk_room();
+            if (mb > 0 && mem_exceeded(mb*sizeof(RAT)))
+                budget_stop(itr,new,mb*sizeof(RAT));
+        }
         for (i = ineq; i != new; i++)
         {
-            if (sptr+sysrow > ar3bd)
-            {
+            if (sptr+sysrow > sysbd+1)
                 /*
-                 * Make array a3 larger,
-                 * and recompute porta_list[]->sys, porta_list[]->ptr, sptr, ar3bd and sysp.
+                 * Array "ar3" is full. Continue in an overflow chunk,
+                 * instead of enlarging "ar3" by reallocate(),
+                 * so porta_list[]->sys and porta_list[]->ptr stay valid.
                  */
-                reallocate(new, &sptr);
-                ar3bd = ar3+nel_ar3-1;
-                /*
-                 * Change by M.S. 3.6.1992:
-                 * "sysp" points to the beginning of the space used by porta_list[]->sys.
-                 * If fourier_motzkin() is called by "traf", sysp = ar3+dim+1-equa.
-                 * If fourier_motzkin() is called by "fmel", sysp = ar3+rowl-niterat.
-                 * rowl-niterat = dim+1-equa, whenever fourier_motzkin()
-                 * is called by "traf", but not when it is called by "fmel".
-                 *
-                 sysp = ar3+dim+1-equa;
-                 */
-                sysp = ar3+rowl-niterat;
-            }
+                sptr = next_sys_chunk(sysrow,new-i,&sysbd);
             /*
              * Add the two inequalities making up the new one.
              * Recall that one of them has coeff. +1, the other coeff. -1,
              * for the elimination variable.
+             * With Int_tableau the coefficients are arbitrary, and
+             * the rows are combined such that this variable cancels.
              */
-            row_add(porta_list[i]->sys+1,porta_list[i]->ptr+1,sptr+1,sysrow-1);
+            if (is_set(Int_tableau))
+                row_comb(porta_list[i]->sys,porta_list[i]->ptr,sptr,sysrow);
+            else
+                row_add(porta_list[i]->sys+1,porta_list[i]->ptr+1,sptr+1,sysrow-1);
             porta_list[i]->sys = sptr;
             sptr = sptr+sysrow;
         }
 
         /* reordering of sys */
         sptr = sysp;
+        nel_xxx = 0;
+        n = ((elim_ord) ? neg-zer : neg) + new-ineq;
+        if (sysp+n*sysrow-1 > ar3bd)
+        {
+            /*
+             * The reordered system does not fit into "ar3".
+             * Store it in a new array of sufficient size,
+             * which becomes "ar3" after the reordering.
+             * The vectors are copied exactly once, as they are
+             * when "ar3" is large enough.
+             */
+            nel_xxx = (sysp-ar3)+n*sysrow+INCR_SYS_EL;
+            if (mem_exceeded((long) nel_xxx*sizeof(RAT)))
+                budget_stop(itr,new,(long) nel_xxx*sizeof(RAT));
+            xxx = (RAT *) RATallo((RAT *) 0,0,U nel_xxx);
+            sptr = xxx+(sysp-ar3);
+        }
         nmark = (zer != 0 && neg != ineq) ? 1 : 0;
         /*  nmark is not used for elim_ord != 0. */
         nmark <<= ((points-itr) % 32);
@@ -1490,6 +1660,28 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
         }
 
         ineq = j;
+        rewind_sys_chunks();
+        if (nel_xxx)
+        {
+            /*
+             * Change by M.S. 3.6.1992:
+             * "sysp" points to the beginning of the space used by porta_list[]->sys.
+             * If fourier_motzkin() is called by "traf", sysp = ar3+dim+1-equa.
+             * If fourier_motzkin() is called by "fmel", sysp = ar3+rowl-niterat.
+             * rowl-niterat = dim+1-equa, whenever fourier_motzkin()
+             * is called by "traf", but not when it is called by "fmel".
+             *
+             sysp = ar3+dim+1-equa;
+             */
+            sysp = xxx+(sysp-ar3);
+            RATallo(ar3,nel_ar3,0);
+            ar3 = xxx;
+            nel_ar3 = nel_xxx;
+            ar3bd = ar3+nel_ar3-1;
+        }
+
+        if (stream_fp)
+            stream_rows(neg,ineq,niterat-itr+1,niterat,nieq,rowl,elim_ord,indx);
 
         nz = ld = 0;
         /* compute number of nonzeros nz, and the max bit-length ld */
@@ -1503,26 +1695,26 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 
 #if defined WIN32
 
-        fprintf(prt,"|%9i |%5i |%4c |%7.2f |%8i |%10.2f |",
+        fprintf(prt,"|%9i |%5i |%4c |%7.2f |%8li |%10.2f |",
                 ineq,ld,MP_realised?'y':'n',
                 (ineq && sysrow ? (float)nz/(float)(ineq*sysrow) : 0),
                 total_size/1000, total_time());
 
         /* 17.01.1994: include logging on file porta.log */
-        porta_log( "|%9i |%5i |%4c |%7.2f |%8i |%10.2f |",
+        porta_log( "|%9i |%5i |%4c |%7.2f |%8li |%10.2f |",
                 ineq,ld,MP_realised?'y':'n',
                 (ineq && sysrow ? (float)nz/(float)(ineq*sysrow) : 0),
                 total_size/1000, total_time());
 
 #else // WIN32
 
-        fprintf(prt,"|%9i |%5i |%4c |%7.2f |%8i |%10.2f |%10.2f |",
+        fprintf(prt,"|%9i |%5i |%4c |%7.2f |%8li |%10.2f |%10.2f |",
                 ineq,ld,MP_realised?'y':'n',
                 (ineq && sysrow ? (float)nz/(float)(ineq*sysrow) : 0),
                 total_size/1000,time_used(),total_time());
 
         /* 17.01.1994: include logging on file porta.log */
-        porta_log( "|%9i |%5i |%4c |%7.2f |%8i |%10.2f |%10.2f |",
+        porta_log( "|%9i |%5i |%4c |%7.2f |%8li |%10.2f |%10.2f |",
                 ineq,ld,MP_realised?'y':'n',
                 (ineq && sysrow ? (float)nz/(float)(ineq*sysrow) : 0),
                 total_size/1000,time_used(), total_time());
@@ -1549,6 +1741,9 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 
         fflush(prt);
 
+        if (mem_exceeded(0))
+            budget_stop(itr,ineq,0);
+
         if (ineq > maxnumineq)
             maxnumineq = ineq;
 
@@ -1562,6 +1757,7 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
     // Ok, now we can desallocate this memory.
 	for (co1 = 0; co1 < omp_get_max_threads(); co1++)
 		newmark1Table[co1] = (unsigned *) allo(CP 0,0,0);
+    free_sys_chunks();
 
 
 
@@ -1634,11 +1830,16 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
      * but only for the non-eliminated variables and the right-hand side.
      * The result is stored one vector to the left of porta_list[]->sys.
      * (This is the reason for the free space at the beginning of ar3).
+     * With option Modular_arith and long integer arithmetic, the products
+     * are computed modulo several primes (see L_RAT_mod_vecpr()).
      */
+    if (is_set(Modular_arith) && MP_realised)
+        mod = L_RAT_mod_init(iesp,elim_ord,nieq,sysrow,ineq);
     for (i = 0; i < ineq; i++,sptr += sysrow)
     {
-        for (j = 0; j < sysrow; j++)
-            vecpr(iesp+nieq*((elim_ord)?elim_ord[j]:j), porta_list[i]->sys+1, sptr+j, nieq);
+        if (!mod || !L_RAT_mod_vecpr(i,sptr))
+            for (j = 0; j < sysrow; j++)
+                vecpr(iesp+nieq*((elim_ord)?elim_ord[j]:j), porta_list[i]->sys+1, sptr+j, nieq);
         porta_list[i]->sys = sptr;
         /*
          * Transform inequalities into "<=1", "<=-1" inequalities,
@@ -1673,12 +1874,35 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
         }
     }
 
+    if (mod)
+    {
+        i = L_RAT_mod_free();
+        fprintf(prt,"multi-modular products                  : %6i\n",i);
+
+        /* 17.01.1994: include logging on file porta.log */
+        porta_log( "multi-modular products                  : %6i\n",i);
+    }
+
     fprintf(prt,"sum of inequalities over all iterations : %6i\n",totalineq);
-    fprintf(prt,"maximal number of inequalities          : %6i\n\n",maxnumineq);
+    fprintf(prt,"maximal number of inequalities          : %6i\n",maxnumineq);
+    fprintf(prt,"maximal memory used (kbytes)            : %6li\n\n",peak_size/1000);
 
     /* 17.01.1994: include logging on file porta.log */
     porta_log( "sum of inequalities over all iterations : %6i\n",totalineq);
-    porta_log( "maximal number of inequalities          : %6i\n\n",maxnumineq);
+    porta_log( "maximal number of inequalities          : %6i\n",maxnumineq);
+    porta_log( "maximal memory used (kbytes)            : %6li\n\n",peak_size/1000);
+
+    if (stream_fp)
+    {
+        fprintf(stream_fp,"\nEND\n");
+        wfclose(stream_fp);
+        stream_fp = 0;
+        
+        fprintf(prt,"inequalities written during elimination : %6i\n\n",nstream);
+
+        /* 17.01.1994: include logging on file porta.log */
+        porta_log( "inequalities written during elimination : %6i\n\n",nstream);
+    }
 
     /* append pointers to equations */
 
@@ -1709,6 +1933,440 @@ void fourier_motzkin( char fname[], int nieq, int rowl, int niterat,
 
 
 
+static void rm_ineqs( char *rm, int n, int sysrow )
+/*****************************************************************/
+/*
+ * Remove the inequalities k < n with rm[k] != 0 from the list, 
+ * the equations follow the remaining inequalities (as after 
+ * rmlistel()). Set ineq to the number of remaining inequalities.
+ */
+{
+    listp *lp;
+    int k,m,j,b;
+    
+    lp = (listp *) allo(CP 0,0,U (n+equa)*sizeof(listp));
+    for (k = m = 0; k < n; k++) 
+    {
+        if (rm[k])
+            continue;
+        if (k != m) 
+        {
+            for (j = 0; j <= sysrow; j++)
+                (*RAT_assign)(porta_list[m]->sys+j, porta_list[k]->sys+j);
+            for (b = 0; b < blocks; b++)
+                porta_list[m]->mark[b] = porta_list[k]->mark[b];
+        }
+        m++;
+    }
+    for (k = 0; k < n+equa; k++)
+        lp[k] = porta_list[k];
+    for (k = 0; k < equa; k++)
+        porta_list[m+k] = lp[n+k];
+    for (k = m; k < n; k++)
+        porta_list[equa+k] = lp[k];
+    allo(CP lp,U (n+equa)*sizeof(listp),0);
+    ineq = m;
+}
+
+
+
+
+
+
+
+
+#define RED_TILE  64
+#define RED_BLOCK 256
+
+static int red_test_int( RAT *inieq, int sysrow )
+/*****************************************************************/
+/*
+ * The strong validity test of red_test() for systems that can be 
+ * scaled to long integers: the incidences (marks) of all inequalities 
+ * are computed in parallel, in blocks of RED_BLOCK points and RED_TILE 
+ * inequalities.
+ * Return 0, if MP arithmetic is used, if the system cannot be scaled,
+ * if an inequality has no satisfying conv-point but cone-points 
+ * exist, or for the redundance check. The marks are recomputed by 
+ * red_test() in that case.
+ */
+{
+    RAT *ie,s;
+    long *pm,*pw,*pmx,*am,*aw,*amx,pgmx,agmx;
+    int *ncv,i,j,k,b,ok,n,m;
+    char *fit;
+    
+    if (MP_realised || (option & Redundance_check))
+        return(0);
+    
+    n = ineq;
+    ie = (RAT *) RATallo((RAT *) 0,0,n*(sysrow+1)+1);
+    for (k = 0; k < n; k++)
+        for (j = 0; j <= sysrow; j++)
+            ie[k*(sysrow+1)+j] = porta_list[k]->sys[j];
+    ok = int_system(inieq,points,sysrow+1,sysrow,1,&pm,&pw,&pmx,&pgmx);
+    ok = int_system(ie,n,sysrow+1,sysrow,0,&am,&aw,&amx,&agmx) && ok;
+    ie = (RAT *) RATallo(ie,n*(sysrow+1)+1,0);
+    if (!ok) 
+    {
+        free_int_system(points,sysrow,pm,pw,pmx);
+        free_int_system(n,sysrow,am,aw,amx);
+        return(0);
+    }
+    
+    ncv = (int *) allo(CP 0,0,U (n*sizeof(int)+1));
+    fit = allo(CP 0,0,U n+1);
+    
+#pragma omp parallel for schedule(dynamic) private(i,j,k,b) copyin(porta_cur)
+    for (m = 0; m < n; m += RED_TILE) 
+    {
+        int t,e,te;
+        long d,*a,*x;
+        
+        e = (m+RED_TILE < n) ? m+RED_TILE : n;
+        for (k = m; k < e; k++) 
+        {
+            for (b = 0; b < blocks; b++)
+                porta_list[k]->mark[b] = 0;
+            ncv[k] = 0;
+            fit[k] = int_fits(amx[k],pgmx,sysrow);
+        }
+        for (t = 0; t < points; t += RED_BLOCK) 
+        {
+            te = (t+RED_BLOCK < points) ? t+RED_BLOCK : points;
+            for (k = m; k < e; k++) 
+            {
+                if (!fit[k])
+                    continue;
+                a = am+(size_t) k*sysrow;
+                for (i = t; i < te; i++) 
+                {
+                    x = pm+(size_t) i*sysrow;
+                    d = 0;
+#pragma omp simd reduction(+:d)
+                    for (j = 0; j < sysrow; j++)
+                        d += a[j]*x[j];
+                    /* conv-points: a*x = b, cone-points: a*x = 0 */
+                    if (d == aw[k]*pw[i]) 
+                    {
+                        domark(porta_list[k]->mark,i);
+                        if (pw[i])
+                            ncv[k]++;
+                    }
+                }
+            }
+        }
+    }
+    
+    /* exact marks of the rows which do not fit */
+    
+    for (k = 0; k < n; k++) 
+    {
+        if (fit[k])
+            continue;
+        for (i = 0; i < points; i++) 
+        {
+            if (!inieq[i*(sysrow+1)+sysrow].num) 
+            {
+                /* cone  */
+                s = porta_list[k]->sys[sysrow];
+                porta_list[k]->sys[sysrow] = RAT_const[0];
+            }
+            if (eqie_satisfied(porta_list[k]->sys,inieq+i*(sysrow+1),sysrow,0)) 
+            {
+                domark(porta_list[k]->mark,i);
+                if (inieq[i*(sysrow+1)+sysrow].num)
+                    ncv[k]++;
+            }
+            if (!inieq[i*(sysrow+1)+sysrow].num)
+                porta_list[k]->sys[sysrow] = s;
+        }
+    }
+    
+    for (k = 0, ok = 1; k < n; k++)
+        if (!ncv[k] && cone)
+            ok = 0;
+    
+    free_int_system(points,sysrow,pm,pw,pmx);
+    free_int_system(n,sysrow,am,aw,amx);
+    
+    if (ok) 
+        /* same output as red_test() */
+        for (i = 0; i < ineq; i += 50)
+        {
+            fprintf(prt,".");
+            fflush(prt);
+            
+            /* 17.01.1994: include logging on file porta.log */
+            porta_log( "." );
+            fflush(logfile);
+        }
+    
+    allo(CP ncv,U (n*sizeof(int)+1),0);
+    allo(fit,U n+1,0);
+    return(ok);
+}
+
+
+
+
+
+
+
+
+#define FACET_PRIME 2147483647U
+
+static unsigned facet_inv( unsigned a )
+{
+    unsigned long long r = 1, x = a;
+    unsigned e = FACET_PRIME-2;
+    
+    for (; e; e >>= 1, x = x*x % FACET_PRIME)
+        if (e & 1) r = r*x % FACET_PRIME;
+    return((unsigned) r);
+}
+
+
+
+
+
+
+
+
+static int facet_rank_exact( RAT *inieq, int k, int sysrow )
+/*****************************************************************/
+/*
+ * Rank of the (homogenized) points marked for inequality k,
+ * computed by exact gaussian elimination in ar5.
+ * ar5[0..n*n) holds the basis, the pivot of row r is 1 and
+ * stored in column piv[r].
+ */
+{
+    RAT *row,*f;
+    int n = sysrow+1,rank = 0,i,j,r,*piv;
+    
+    if (nel_ar5 < (n+2)*n) 
+    {
+        ar5 = (RAT *) RATallo(ar5,nel_ar5,(n+2)*n);
+        nel_ar5 = (n+2)*n;
+    }
+    row = ar5+n*n;
+    f = row+n;
+    piv = (int *) allo(CP 0,0,U n*sizeof(int));
+    
+    for (i = 0; i <= points && rank < sysrow; i++) 
+    {
+        if (i < points) 
+        {
+            if (!(porta_list[k]->mark[i/32] & (1U << i%32)))
+                continue;
+            for (j = 0; j <= sysrow; j++)
+                (*RAT_assign)(row+j,inieq+i*n+j);
+        }
+        else 
+        {
+            /* origin, if there are no conv-points */
+            if (cone != points)
+                continue;
+            for (j = 0; j < sysrow; j++)
+                (*RAT_assign)(row+j,RAT_const);
+            (*RAT_assign)(row+sysrow,RAT_const+1);
+        }
+        
+        for (r = 0; r < rank; r++) 
+        {
+            if (!row[piv[r]].num)
+                continue;
+            (*RAT_assign)(f,row+piv[r]);
+            for (j = 0; j < n; j++) 
+            {
+                (*RAT_mul)(*f,ar5[r*n+j],f+1);
+                (*RAT_sub)(row[j],f[1],row+j);
+            }
+        }
+        for (j = 0; j < n && !row[j].num; j++);
+        if (j == n)
+            continue;
+        
+        /* new basis row with pivot 1 */
+        (*RAT_assign)(f,row+j);
+        for (r = 0; r < n; r++) 
+            (*RAT_assign)(ar5+rank*n+r,row+r);
+        (*RAT_row_prim)(ar5+rank*n,ar5+rank*n,f,n);
+        if (f->num < 0) 
+            for (r = 0; r < n; r++)
+                (*RAT_sub)(RAT_const[0],ar5[rank*n+r],ar5+rank*n+r);
+        piv[rank++] = j;
+    }
+    
+    allo(CP piv,U n*sizeof(int),0);
+    return(rank);
+}
+
+
+
+
+
+
+
+
+static void facet_test( RAT *inieq, int sysrow )
+/*****************************************************************/
+/*
+ * Remove the inequalities which are not facet-defining: the points 
+ * (x,1) and rays (y,0) satisfying an inequality with equality must
+ * have rank sysrow = dim-equa (the origin is added for cones). 
+ * The ranks are computed modulo FACET_PRIME from the marks, in 
+ * parallel over the inequalities. Since the rank modulo a prime 
+ * cannot exceed the rank, rank sysrow proves a facet; a smaller
+ * rank is confirmed exactly by facet_rank_exact().
+ */
+{
+    unsigned *res;
+    int n = sysrow+1,nie = ineq,*rk,*ncv,i,k,nf;
+    char *ok,*rm;
+    
+    fprintf(prt,"facet test ");
+    
+    /* 17.01.1994: include logging on file porta.log */
+    porta_log( "facet test ");
+    
+    res = (unsigned *) allo(CP 0,0,U ((size_t) points*n*sizeof(unsigned)+1));
+    ok = allo(CP 0,0,U points+1);
+    rk = (int *) allo(CP 0,0,U (ineq*sizeof(int)+1));
+    ncv = (int *) allo(CP 0,0,U (ineq*sizeof(int)+1));
+    rm = allo(CP 0,0,U ineq+1);
+    
+    /* residues of the points */
+    
+#pragma omp parallel for private(k) if (!MP_realised) copyin(porta_cur)
+    for (i = 0; i < points; i++) 
+    {
+        RAT *x = inieq+(size_t) i*n;
+        unsigned d;
+        
+        ok[i] = 1;
+        for (k = 0; k < sysrow; k++) 
+            if (MP_realised) 
+                ok[i] &= L_RAT_mod(x[k],FACET_PRIME,res+(size_t) i*n+k);
+            else if (!(d = (unsigned) x[k].den.i % FACET_PRIME))
+                ok[i] = 0;
+            else 
+            {
+                long r = x[k].num % (long) FACET_PRIME;
+                
+                if (r < 0) r += FACET_PRIME;
+                res[(size_t) i*n+k] = (unsigned) 
+                    ((unsigned long long) r*facet_inv(d) % FACET_PRIME);
+            }
+        res[(size_t) i*n+sysrow] = (x[sysrow].num != 0);
+    }
+    
+#pragma omp parallel for schedule(dynamic) private(i) copyin(porta_cur)
+    for (k = 0; k < ineq; k++) 
+    {
+        unsigned *bas,*row,c;
+        int *piv,rank = 0,j,r;
+        
+        bas = (unsigned *) allo(CP 0,0,U (n+1)*n*sizeof(unsigned));
+        piv = (int *) allo(CP 0,0,U n*sizeof(int));
+        row = bas+n*n;
+        for (ncv[k] = i = 0; i < points; i++)
+            if (porta_list[k]->mark[i/32] & (1U << i%32))
+                ncv[k] += res[(size_t) i*n+sysrow];
+        
+        for (i = 0; i <= points && rank < sysrow; i++) 
+        {
+            if (i < points) 
+            {
+                if (!(porta_list[k]->mark[i/32] & (1U << i%32)))
+                    continue;
+                if (!ok[i]) 
+                {
+                    rank = -1;
+                    break;
+                }
+                memcpy(row,res+(size_t) i*n,n*sizeof(unsigned));
+            }
+            else 
+            {
+                /* origin, if there are no conv-points */
+                if (cone != points)
+                    continue;
+                memset(row,0,sysrow*sizeof(unsigned));
+                row[sysrow] = 1;
+            }
+            
+            for (r = 0; r < rank; r++) 
+            {
+                if (!(c = row[piv[r]]))
+                    continue;
+                for (j = 0; j < n; j++)
+                    row[j] = (unsigned) ((row[j] + (unsigned long long) 
+                                          (FACET_PRIME-c)*bas[r*n+j]) % FACET_PRIME);
+            }
+            for (j = 0; j < n && !row[j]; j++);
+            if (j == n)
+                continue;
+            c = facet_inv(row[j]);
+            for (r = 0; r < n; r++)
+                bas[rank*n+r] = (unsigned) ((unsigned long long) row[r]*c % FACET_PRIME);
+            piv[rank++] = j;
+        }
+        rk[k] = rank;
+        
+        allo(CP piv,U n*sizeof(int),0);
+        allo(CP bas,U (n+1)*n*sizeof(unsigned),0);
+    }
+    
+    for (k = nf = 0; k < ineq; k++) 
+    {
+        if (k%50 == 0)
+        {
+            fprintf(prt,".");
+            fflush(prt);
+
+            /* 17.01.1994: include logging on file porta.log */
+            porta_log( "." );
+            fflush(logfile);
+        }
+        
+        if (rk[k] < sysrow)
+            rk[k] = facet_rank_exact(inieq,k,sysrow);
+        if (rk[k] < sysrow || (!ncv[k] && cone != points)) 
+        {
+            /* no face or no facet */
+            fprintf (prt,"r");
+            
+            /* 17.01.1994: include logging on file porta.log */
+            porta_log( "r" );
+            
+            rm[k] = 1;
+            nf++;
+        }
+    }
+    if (nf)
+        rm_ineqs(rm,ineq,sysrow);
+    
+    fprintf(prt,"\nnot facet-defining inequalities removed : %i\n",nf);
+    
+    /* 17.01.1994: include logging on file porta.log */
+    porta_log( "\nnot facet-defining inequalities removed : %i\n",nf);
+    
+    allo(CP res,U ((size_t) points*n*sizeof(unsigned)+1),0);
+    allo(ok,U points+1,0);
+    allo(CP rk,U (nie*sizeof(int)+1),0);
+    allo(CP ncv,U (nie*sizeof(int)+1),0);
+    allo(rm,U nie+1,0);
+}
+
+
+
+
+
+
+
+
 void red_test( int indx[], RAT *inieq, int *rowl_inar )
 {
     RAT  *convmid,*mid,*x;
@@ -1746,13 +2404,14 @@ void red_test( int indx[], RAT *inieq, int *rowl_inar )
     *rowl_inar = dim-equa+1;
 
     nel_ar5 = 3*(sysrow+1);
-    ar5 = (RAT *) RATallo (CP ar5,0,nel_ar5);
+    ar5 = (RAT *) RATallo (ar5,0,nel_ar5);
     convmid = ar5;
     mid = ar5+sysrow+1;
     x = mid+sysrow+1;
 
 
-    for (ie1 = 0; ie1 != ineq; ie1++)
+    ie1 = (red_test_int(inieq,sysrow)) ? ineq : 0;
+    for (; ie1 != ineq; ie1++)
     {
         /*******************************/
 
@@ -1888,6 +2547,9 @@ void red_test( int indx[], RAT *inieq, int *rowl_inar )
     /* 17.01.1994: include logging on file porta.log */
     porta_log( "\n" );
 
+    if (is_set(Facet_check))
+        facet_test(inieq,sysrow);
+
     pp = ar3;
     sysrow++;
     for (i = 0; i < ineq; i++)
@@ -1928,7 +2590,7 @@ void domark( unsigned *m, int n )
 
 
 
-void rmlistel( int blocks, int cel, int lastie, int real, int sysrow )
+void rmlistel( int nblocks, int cel, int lastie, int real, int sysrow )
 /*****************************************************************/
 /*
  * Remove element cel from list.
@@ -1949,7 +2611,7 @@ void rmlistel( int blocks, int cel, int lastie, int real, int sysrow )
             lp = porta_list[i];
             for (j = 0; j <= sysrow; j++)
                 (*RAT_assign)(lp->sys+j, porta_list[i+1]->sys+j);
-            for (j = 0; j < blocks; j++)
+            for (j = 0; j < nblocks; j++)
                 lp->mark[j] = porta_list[i+1]->mark[j];
         }
     }
@@ -39,44 +39,357 @@ REVISED BY ANDREAS LOEBEL
 #include "common.h"
 #include "arith.h"
 #include "log.h"
+#include "porta_ctx.h"
+#include <limits.h>
 
 
-#define MAXLINE 100000
+#define SECT_CHUNK 65536
 
 
+#if !defined WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#include <process.h>
+#include <sys/stat.h>
+#endif
 
 
+/*
+ * The input file is mapped into memory (or read into memory, where
+ * mmap() is not available). get_line() and read_sect() take their 
+ * characters from in_pos.
+ */
+#define in_buf (porta_cur->in_buf)
+#define in_pos (porta_cur->in_pos)
+#define in_end (porta_cur->in_end)
+#define in_size (porta_cur->in_size)
+#define in_cap (porta_cur->in_cap)
+#define in_mapped (porta_cur->in_mapped)
 
+/*
+ * The current line, copied from the input buffer by get_line(), 
+ * and its squeezed form (see scan_line2()). Both buffers have ln_cap 
+ * characters and grow with the longest line read.
+ */
+#define ln_buf (porta_cur->ln_buf)
+#define sq_buf (porta_cur->sq_buf)
+#define ln_cap (porta_cur->ln_cap)
 
 
+/*
+ * The lines ELIMINATION_ORDER, LOWER_BOUNDS, UPPER_BOUNDS of the input
+ * file, kept when sorting for a binary output file (see bin_begin()).
+ */
+#define in_list (porta_cur->in_list)
 
-int scan_line( RAT *rat_in, int type, int d, int line, 
-               char fname[], char *in_line, char scanned_inline[] )
+
+/*
+ * Compressed files: the suffixes and the filters through which they
+ * are read and written (see open_input() and wfopen()). The filter
+ * runs as a separate process, overlapping with the computation.
+ * It is started without a shell (see zip_open()), with the file as
+ * its standard input or output, so that no file name is interpreted.
+ */
+static struct { char *ext, *rd[5], *wr[5]; } zip_tab[] = {
+    { ".gz",  { "gzip", "-d", "-c", 0 },       { "gzip", "-c", 0 } },
+    { ".zst", { "zstd", "-q", "-d", "-c", 0 }, { "zstd", "-q", "-c", 0 } } };
+#define ZIP_N (int) (sizeof(zip_tab)/sizeof(zip_tab[0]))
+
+#define wf_pipe (porta_cur->wf_pipe)
+#define wf_pid (porta_cur->wf_pid)
+
+
+/*
+ * Error messages of the scanning functions, 
+ * which return the index into this table.
+ */
+#define SCAN_FORMAT_FILE 1
+#define SCAN_DENOM       2
+#define SCAN_DIM         3
+#define SCAN_FORMAT      4
+#define SCAN_VARNAME     5
+#define SCAN_LONG        6
+#define SCAN_EOL         7
+#define SCAN_OVERFLOW    8
+
+/* lengths of a multiple precision RAT (see mp.c) */
+#define get_numlen(x)   ((abs((x)->num)>>20) & 1023)
+#define get_denlen(x)   ((abs((x)->num)>>10) & 1023)
+
+
+static char *scan_msg[] = { "",
+    "%s, line %i : invalid format of input file ",
+    "%s, line %i : invalid denominator",
+    "%s, line %i : dimension error",
+    "%s, line %i : invalid format",
+    "%s, line %i : only variable names x1,...,xdim allowed",
+    "%s, line %i : line too long ",
+    "%s, line %i : unexpected end of line",
+    "%s, line %i : arithmetic overflow" };
+
+
+
+
+
+
+
+
+static FILE *zip_open( char *fname, int z, int wr, long *pid )
 /*****************************************************************/
 /*
- * Read the string "in_line" 
- * of "d" integers or fractions into the array rat_in
- * in case of type = 0 or 1, fractions are accepted:  1/2  400/5
- * in case of type = 2, only integers are accepted: 1 2 400 5
- * Brackets starting the line are overread. 
- * The statistical part is also overread. 
- * Return with 1.
- *
- * If the type = 3
- * or in_line is not started by brackets or integers or '+' or '-',
- * scan_line2() is used to scan the string in_line.
- * Output is string scanned_inline then.
- * Return with 0 if in_line begins with a number (not counting blanks),
- * with 1 otherwise.
- *
- * Change by M.S. 1.6.92:
- * Overread also tabs.
+ * Start the filter of the compressed file "fname" (z = file_zip(fname))
+ * and return the stream of its uncompressed side: the decompressed 
+ * contents of "fname", if wr = 0, and the data to be compressed into
+ * "fname", if wr = 1. The process id goes to "*pid" for zip_close().
+ * Return 0, if "fname" cannot be opened.
+ */
+{
+    char **argv = (wr) ? zip_tab[z-1].wr : zip_tab[z-1].rd;
+    int p[2], fd;
+    
+#if !defined WIN32
+    fd = (wr) ? open(fname,O_WRONLY|O_CREAT|O_TRUNC,0666) : open(fname,O_RDONLY);
+#else
+    fd = (wr) ? _open(fname,_O_WRONLY|_O_CREAT|_O_TRUNC|_O_BINARY,_S_IREAD|_S_IWRITE) 
+              : _open(fname,_O_RDONLY|_O_BINARY);
+#endif
+    if (fd < 0)
+        return(0);
+#if !defined WIN32
+    /* 
+     * The descriptors must not leak into the filters started by other
+     * threads, which would then hold a pipe open.
+     */
+#pragma omp critical (zip)
+    {
+        if (pipe(p) == 0) 
+        {
+            fcntl(p[0],F_SETFD,FD_CLOEXEC);
+            fcntl(p[1],F_SETFD,FD_CLOEXEC);
+            fcntl(fd,F_SETFD,FD_CLOEXEC);
+            if ((*pid = fork()) == 0) 
+            {
+                dup2(fd,wr);
+                dup2(p[wr ? 0 : 1],wr ? 0 : 1);
+                execvp(argv[0],argv);
+                _exit(127);
+            }
+        }
+        else
+            *pid = -1;
+    }
+    close(fd);
+    if (*pid < 0)
+        msg( "%s : cannot start compression filter", fname, 0 );
+    close(p[wr ? 0 : 1]);
+    return( fdopen(p[wr],(wr) ? "w" : "r") );
+#else
+    if (_pipe(p,65536,_O_BINARY|_O_NOINHERIT))
+        msg( "%s : cannot start compression filter", fname, 0 );
+    /* The filter inherits the standard input and output of the moment */
+#pragma omp critical (zip)
+    {
+        int s0 = _dup(0), s1 = _dup(1);
+        
+        _dup2(fd,wr);
+        _dup2(p[wr ? 0 : 1],wr ? 0 : 1);
+        *pid = (long) _spawnvp(_P_NOWAIT,argv[0],argv);
+        _dup2(s0,0);
+        _dup2(s1,1);
+        _close(s0);
+        _close(s1);
+    }
+    _close(fd);
+    _close(p[wr ? 0 : 1]);
+    if (*pid == -1)
+        msg( "%s : cannot start compression filter", fname, 0 );
+    return( _fdopen(p[wr],(wr) ? "w" : "r") );
+#endif
+}
+
+
+
+
+
+
+
+
+static int zip_close( FILE *f, long pid )
+/*****************************************************************/
+/*
+ * Close the stream "f" of zip_open() and wait for the filter.
+ * Return 0, if it succeeded.
  */
+{
+    int status;
+    
+    fclose(f);
+#if !defined WIN32
+    while (waitpid((pid_t) pid,&status,0) < 0)
+        if (errno != EINTR)
+            return(1);
+    return(!WIFEXITED(status) || WEXITSTATUS(status) != 0);
+#else
+    if (_cwait(&status,(intptr_t) pid,0) == -1)
+        return(1);
+    return(status != 0);
+#endif
+}
+
+
+
+
+
+
 
+
+static void open_input( char *fname, char *mode )
 {
-    char ch, *ptr;
-    int j,*int_in;
-    RAT val;
+    FILE *f;
+    size_t n;
+    long pid = 0;
+    int z;
+#if !defined WIN32
+    struct stat st;
+    int fd;
+#endif
+
+    in_buf = 0;
+    in_size = in_cap = 0;
+    in_mapped = 0;
+    
+    z = file_zip(fname);
+    
+#if !defined WIN32
+    if ((fd = open(fname,O_RDONLY)) < 0)
+        msg( "%s : no such file", fname, 0 );
+    if (!z && !fstat(fd,&st) && S_ISREG(st.st_mode) && st.st_size > 0) 
+    {
+        in_buf = (char *) mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+        if (in_buf == (char *) MAP_FAILED)
+            in_buf = 0;
+        else 
+        {
+            in_size = st.st_size;
+            in_mapped = 1;
+            madvise(in_buf,in_size,MADV_SEQUENTIAL);
+        }
+    }
+    close(fd);
+#endif
+
+    if (!in_mapped) 
+    {
+        /* read the whole file */
+        if (z) 
+            f = zip_open(fname,z,0,&pid);
+        else
+            f = fopen(fname,mode);
+        if (f == 0)
+            msg( "%s : no such file", fname, 0 );
+        do 
+        {
+            if (in_size+BUFSIZ > in_cap) 
+            {
+                in_buf = lallo(in_buf,in_cap,2*in_cap+BUFSIZ);
+                in_cap = 2*in_cap+BUFSIZ;
+            }
+            n = fread(in_buf+in_size,1,in_cap-in_size,f);
+            in_size += n;
+        }
+        while (n > 0);
+        if (!z)
+            fclose(f);
+        else if (zip_close(f,pid))
+            msg( "%s : cannot decompress file", fname, 0 );
+    }
+    
+    in_pos = in_buf;
+    in_end = in_buf+in_size;
+}
+
+
+
+
+
+
+
+
+static void close_input()
+{
+#if !defined WIN32
+    if (in_mapped)
+        munmap(in_buf,in_size);
+    else
+        lallo(in_buf,in_cap,0);
+#else
+    lallo(in_buf,in_cap,0);
+#endif
+    in_buf = in_pos = in_end = 0;
+    ln_buf = lallo(ln_buf,ln_cap,0);
+    sq_buf = lallo(sq_buf,ln_cap,0);
+    ln_cap = 0;
+}
+
+
+
+
+
+
+
+
+
+char *map_input_file( char *fname, size_t *len )
+/*****************************************************************/
+/*
+ * The contents of the file "fname" (mapped, read, or decompressed 
+ * like an input file), for readers of other file formats. 
+ * The "*len" characters are not terminated by '\0'.
+ * They remain valid until unmap_input_file().
+ */
+{
+    open_input(fname,"r");
+    *len = in_size;
+    return(in_buf);
+}
+
+
+
+
+
+
+
+
+void unmap_input_file()
+{
+    close_input();
+}
+
+
+
+
+
+
+
+
+static char *skip_head( char *in_line )
+/*****************************************************************/
+/*
+ * Overread blanks, tabs, and brackets () with the text inside 
+ * at the beginning of a line.
+ * Return the position of the next character, 
+ * or 0 if the line ends within the brackets.
+ */
+{
+    char ch;
     
     do
     {
@@ -84,15 +397,13 @@ int scan_line( RAT *rat_in, int type, int d, int line,
     }  
     while (ch == ' ' || ch == '\t');
     
-    /* overread brackets () and text inside */
     if (ch == '(') 
     {
         do 
         {
             ch = *(in_line++);
             if (ch == '\n')
-                msg("%s, line %i : unexpected end of line",
-                    fname,line);
+                return(0);
         }  
         while (ch != ')');
         do 
@@ -101,24 +412,75 @@ int scan_line( RAT *rat_in, int type, int d, int line,
         } 
         while (ch == ' ' || ch == '\t');
     }
-    in_line--;
     
-    if ((((ch < '0' || ch > '9') && ch != '+' && ch != '-'))
-        || type == 3 ) 
-    {
-        /* NO POINT-LINE */
-        return(scan_line2(line,fname,in_line,scanned_inline));
-    }
+    return(in_line-1);
+}
+
+
+
+
+
+
+
+
+static char *scan_int( char *s, int *val )
+/*****************************************************************/
+/*
+ * The same as (int) strtol(s,&ptr,10), 
+ * but white space is skipped only up to the end of the line.
+ * Return ptr, or 0 if no number was found.
+ */
+{
+    unsigned long x = 0, lim;
+    int neg = 0, over = 0;
+    
+    while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\v' || *s == '\f')
+        s++;
+    if (*s == '+' || *s == '-')
+        neg = (*s++ == '-');
+    if (*s < '0' || *s > '9')
+        return(0);
+    
+    lim = (neg) ? (unsigned long) LONG_MAX+1 : LONG_MAX;
+    for (; *s >= '0' && *s <= '9'; s++)
+        if (x > (lim-(*s-'0'))/10)
+            over = 1;
+        else
+            x = 10*x+(*s-'0');
+    if (over)
+        x = lim;
+    
+    *val = (int) ((neg) ? (long) (0UL-x) : (long) x);
+    return(s);
+}
+
 
+
+
+
+
+
+
+static int scan_nums( RAT *rat_in, int type, int d, char *in_line )
+/*****************************************************************/
+/*
+ * The number part of scan_line(): read "d" numbers from "in_line". 
+ * Return 0, or the error number (see scan_msg[]).
+ * For type 0, no global data are used.
+ */
+{
+    char ch, *ptr;
+    int j,*int_in,x;
+    RAT val;
+    
     int_in = (int *) rat_in;
     
     /* read exactly d fractions or integers */
     for (j = 0; j < d; j++,rat_in++) 
     {
-        val.num = (int) strtol(in_line,&ptr,10);
-        if (ptr == in_line)
-            msg("%s, line %i : invalid format of input file ",
-                fname,line);
+        if (!(ptr = scan_int(in_line,&x)))
+            return(SCAN_FORMAT_FILE);
+        val.num = x;
         /* position in_line after the number */
         in_line = ptr;
         /* read the denominator, if type < 2 */
@@ -131,52 +493,583 @@ int scan_line( RAT *rat_in, int type, int d, int line,
             while (ch == ' ' || ch == '\t');
             if (ch  == '/') 
             {
-                val.den.i = (int) strtol(in_line,&ptr,10);
-                if (ptr == in_line || val.den.i <= 0)
-                    msg("%s, line %i : invalid denominator",
-                        fname,line);
+                if (!(ptr = scan_int(in_line,&x)) || x <= 0)
+                    return(SCAN_DENOM);
+                val.den.i = x;
                 in_line = ptr;
             }
-            else 
+            else 
+            {
+                /* default denominator = 1 */
+                in_line--;
+                (val.den.i = 1);
+            }
+        }
+
+        if (type == 0)
+            *rat_in = val;
+        else if (type == 1)
+            I_RAT_add(val,*rat_in,rat_in);
+        else
+            *(int_in+j) = val.num;
+    }
+
+    /* 
+     * change by M.S. 1.7.92:
+     * the following three lines lead to the rejection of
+     * "(..) 1 1  # statistical part\n"
+     * As for inequality-lines, the comment sign # should also be allowed
+     * for point-lines.
+     *
+     *  for (ch = getc(fp); ch != '\n' ; ch = getc(fp))
+     *    if (ch != ' ') 
+     *      msg("%sline : %i invalid format of input file ","",line);
+     */
+    ch = *(in_line++);
+    while (ch != '\n'  && ch != '#') 
+    {
+        if (ch >= '0' && ch <= '9')
+            return(SCAN_DIM);
+        /* too many numbers on the line */
+        else if (ch != ' ' && ch != '\t') 
+            return(SCAN_FORMAT_FILE);
+        ch = *(in_line++);
+    }
+    
+    return(0);
+}
+
+
+
+
+
+
+
+
+int scan_line( RAT *rat_in, int type, int d, int line, 
+               char fname[], char *in_line, char scanned_inline[] )
+/*****************************************************************/
+/*
+ * Read the string "in_line" 
+ * of "d" integers or fractions into the array rat_in
+ * in case of type = 0 or 1, fractions are accepted:  1/2  400/5
+ * in case of type = 2, only integers are accepted: 1 2 400 5
+ * Brackets starting the line are overread. 
+ * The statistical part is also overread. 
+ * Return with 1.
+ *
+ * If the type = 3
+ * or in_line is not started by brackets or integers or '+' or '-',
+ * scan_line2() is used to scan the string in_line.
+ * Output is string scanned_inline then.
+ * Return with 0 if in_line begins with a number (not counting blanks),
+ * with 1 otherwise.
+ *
+ * Change by M.S. 1.6.92:
+ * Overread also tabs.
+ */
+
+{
+    char ch;
+    int err;
+    
+    /* overread brackets () and text inside */
+    if (!(in_line = skip_head(in_line)))
+        msg(scan_msg[SCAN_EOL],fname,line);
+    ch = *in_line;
+    
+    if ((((ch < '0' || ch > '9') && ch != '+' && ch != '-'))
+        || type == 3 ) 
+    {
+        /* NO POINT-LINE */
+        return(scan_line2(line,fname,in_line,scanned_inline));
+    }
+
+    if ((err = scan_nums(rat_in,type,d,in_line)))
+        msg(scan_msg[err],fname,line);
+    
+    return(1);
+}
+
+
+
+
+
+
+
+
+
+
+int nstrcmp( char *a, char *b1, char *b2, char *b3, char *b4, char *b5, char *b6, char *b7 )
+{
+    return(strcmp(a,b1) && strcmp(a,b2) && strcmp(a,b3) && strcmp(a,b4) &&
+           strcmp(a,b5) && strcmp(a,b6) && strcmp(a,b7));
+} 
+
+
+
+
+
+
+
+
+static int squeeze_line( char *in_line, char scanned_inline[] )
+/*****************************************************************/
+/*
+ * scan_line2() for a line that ends with '\n'.
+ * scanned_inline has room for the line and two more characters.
+ */
+{
+    int i = 0;
+    char ch;
+    
+    ch = *(in_line++);
+    
+    for (  ; ch != '\n'; ch = *(in_line++)) 
+    {
+        if (ch == 'x' && i == 0)
+            scanned_inline[i++] = '+';
+        /* || (i > 0 ? in_line[i-1] != ' ' : 1)) */
+        if (ch != ' ' && ch != '\t') 
+            scanned_inline[i++] = ch;
+    }
+    
+    scanned_inline[i] = '\0';
+    /* scanned_inline ends with "\0", but not with "\n\0" */
+    ch = scanned_inline[0];
+    if ((ch < '0' || ch > '9') && ch != '+' && ch !=  '-')
+        return(0);
+    return (1);
+}     
+
+
+
+
+
+
+
+
+int scan_line2( int line, char fname[], char *in_line, char scanned_inline[] )
+/*****************************************************************/
+/*
+ * Former get_line().
+ * From a string "in_line",
+ * remove all brackets and text inside.
+ * Put a '+' in front the first 'x'.
+ * Remove all blanks.
+ * Output is string scanned_inline.
+ * 
+ * Change by M.S. 1.6.92:
+ * remove also tabs
+ *
+ * Return 1, if line begins with a non-number (not counting blanks)
+ * otherwise return 0.
+ * scanned_inline must have room for in_line and two more characters.
+ */
+{
+    return(squeeze_line(in_line,scanned_inline));
+}     
+
+
+
+
+
+
+
+
+
+
+
+static void line_room( size_t len )
+/*****************************************************************/
+/*
+ * Grow ln_buf and sq_buf to at least len characters.
+ */
+{
+    size_t cap;
+    
+    if (len <= ln_cap)
+        return;
+    cap = 2*ln_cap+BUFSIZ;
+    if (cap < len)
+        cap = len;
+    ln_buf = lallo(ln_buf,ln_cap,cap);
+    sq_buf = lallo(sq_buf,ln_cap,cap);
+    ln_cap = cap;
+}
+
+
+
+
+
+
+
+
+int get_line( char fname[], int *line )
+/*****************************************************************/
+/*
+ * Read a line from the input file into string ln_buf,
+ * without changing this string. sq_buf grows with ln_buf.
+ * Return 0 if the line consists only of blanks, tabs, and one newline,
+ * otherwise return 1.
+ */
+{
+    char *q;
+    size_t len,i;
+    int nonempty = 0;
+    
+    (*line)++;
+    if (!(q = memchr(in_pos,'\n',in_end-in_pos)))
+    {
+        msg("%s, line %i: invalid format",fname,*line);
+        return 0; // dummy
+    }
+    len = q-in_pos+1;
+    line_room(len+2);
+    memcpy(ln_buf,in_pos,len);
+    ln_buf[len] = '\0';
+    in_pos = q+1;
+    for (i = 0; i+1 < len && !nonempty; i++)
+        if (ln_buf[i] != ' ' &&  ln_buf[i] != '\t')
+            nonempty = 1;
+    return (nonempty);
+    /* ln_buf ends with "\n\0" */
+}
+
+
+
+
+
+
+
+
+static int scan_eqie( RAT *row, int ndim, char *scanned_inline, int nc )
+/*****************************************************************/
+/*
+ * Read the (in)equality in string "scanned_inline" (see scan_line2())
+ * into the row "row" of length dim+2 (see read_eqie()).
+ * Return 0, or the error number (see scan_msg[]).
+ * If nc is set, an arithmetic overflow is returned as SCAN_OVERFLOW 
+ * instead of being handled, and no global data are used.
+ */
+{
+    char *p,*in;
+    int j,rs=0,index=0,numberread,ok = 1;
+    RAT val;
+
+    p = in = scanned_inline;
+        
+    /* scan string "scanned_inline" up to '\0' or '#' */
+    while (*p != '\0' && *p != '#' ) 
+    {
+            
+        val.den.i = 1;
+        val.num = 1;
+        if (*p == '-')
+            val.num = -1;
+        
+        /* 
+         * If: {+,-} has been read,
+         *     or {<,=,>} followed by {x,0,1,..,9} has been read,
+         *     or it is the beginning of the line. then ...
+         */
+        if ( *p == '-' || *p == '+'  || 
+             (p == scanned_inline || 
+              (p != scanned_inline && (*(p-1)=='<' || *(p-1)=='=' || *(p-1)=='>')) 
+              && ((*p < 58 && *p > 47) || *p =='x') )     ) 
+        {
+            numberread = 0;
+            if ( *p == '-' || *p == '+')    p++;
+            in = p;
+            while (*p > 47 && *p < 58)
+                p++;
+            if (in != p) 
+            {
+                /* in points to a number, p to the next non-number */
+                numberread = 1;
+                val.num *= atoi(in);
+                if (*p == '/') 
+                {
+                    p++;
+                    in = p;
+                    while (*p > 47 && *p < 58) p++;
+                    if (p == in)
+                        return(SCAN_DENOM);
+                    if ((val.den.i = atoi(in)) <= 0)
+                        return(SCAN_DENOM);
+                }   
+            } /* if (in != p) */
+
+            if (*p == 'x') 
+            {
+                p++;
+                in = p;
+                while (*p > 47 && *p < 58) p++;
+                if (p == in) 
+                    return(SCAN_FORMAT);
+                index = atoi(in)-1;
+                if (index > ndim-1 || index < 0)
+                    return(SCAN_VARNAME);
+            }
+            /* 
+             * Change by M.S. 1.6.92:
+             * The following four lines of code are changed.
+             *
+             * In the case (*p in {+,-}), 
+             * something like "10 +", but not "x10 +" has been encountered.
+             * In the case (rs==0 && *p in {<,>,>} ),
+             * something like "10 <", but not "x10 <" has been encountered.
+             * In both cases, the number "10" is interpreted as part of
+             * the right-hand side.
+             * But it should be tested, 
+             * whether a number has actually been read.
+             * Otherwise
+             * "x1++x2 <= 20\n"  is interpreted as
+             * "x1+1+x2 <= 20\n".
+             */
+            else if (numberread && (*p == '+' || *p == '-'  || 
+                      ((rs == 0) && (*p =='<'||*p == '>'||*p == '=')))) 
+            {
+                index = ndim;
+            }
+            /* The following four lines mean:
+             * If "<=" or ">=" or "==" has already been read (i.e. rs > 0),
+             * and if p points to the end of the line,
+             * then interpret the number in val as the right hand side.
+             * to be stored in the dim-th position of the current row
+             * of table "ar".
+             */
+            else if (numberread && rs && (*(p) == '\0' || *(p) == '#'))  
+            {
+                index = ndim;
+            }
+            else 
+                return(SCAN_FORMAT);
+        } /* if ......... */
+
+        else if ((p != scanned_inline) 
+                 && (*p == '<' || *p == '>' || *p == '=')) 
+        {
+            /* 
+             * Record the type of inequality:
+             * rs = 1   if it is an equation ("=" or "==")
+             * rs = 2   if it is a "<=" inequality (may also be written "=<")
+             * rs = 3   if it is a ">=" inequality (may also be written "=>")
+             */
+            if (++rs > 1) 
+                return(SCAN_FORMAT);
+            if ((*p == '=') && (*(p+1) == '='))
+                p++;
+            else if ((*p == '=') && (*(p+1) != '>') && (*(p+1) != '<'));
+            else if ((*p == '=' && *(p+1) == '>') ||
+                     (*p == '>' && *(p+1) == '=')) 
+            {
+                rs++;rs++;
+                p++;
+            }
+            else if ((*p == '=' && *(p+1) == '<') ||
+                     (*p == '<' && *(p+1) == '=')) 
+            {
+                rs++; 
+                p++;
+            }
+            else
+                return(SCAN_FORMAT);
+            p++;
+            index = -1;
+        } /* else if < = > */
+            
+        else 
+            return(SCAN_FORMAT);
+            
+        if (index > -1)  
+        { /* not "< > =" */ 
+            if (index == ndim) val.num *= -1;
+            if (nc)
+                ok = (rs) ? I_RAT_sub_nc(row[index],val,row+index)
+                    : I_RAT_add_nc(row[index],val,row+index);
+            else if (rs) 
+                I_RAT_sub(row[index],val,row+index);
+            else
+                I_RAT_add(row[index],val,row+index);
+            if (!ok)
+                return(SCAN_OVERFLOW);
+        }
+            
+    } /* while */
+        
+    /* transform ">=" into "<=" by multiplying the inequality with -1 */
+    if (rs == 3 ) 
+    {  /* >= */
+        for (j = 0; j <= ndim; j++)
+            row[j].num = -row[j].num;
+        rs -= 1;
+    }
+    row[ndim+1].num = --rs; 
+    
+    /* 
+     * Now rs = 0 if the line was an equation,
+     * and rs = 1 if the line was an inequality.
+     * The last line stored rs into the "dim+1"th position of the row.
+     */
+    return(0);
+}
+
+
+
+
+
+
+
+
+static int read_sect( RAT **ar, int *maxrows, int rowl, int first, int ndim, 
+                      int type, int *line, char *fname )
+/*****************************************************************/
+/*
+ * Read the body of a CONV_SECTION or CONE_SECTION (type 0) or of the 
+ * INEQUALITIES_SECTION (type 3) directly from the input buffer,
+ * into rows first, first+1, ... of "ar" (row length "rowl").
+ * The lines are collected in chunks of SECT_CHUNK lines,
+ * and each chunk is scanned in parallel. Lines with brackets or 
+ * comments are scanned as by scan_line() and read_eqie(); 
+ * there is no limit on the line length.
+ * Reading stops in front of the first line that is not a point or 
+ * (in)equality, or that causes an error or an overflow, 
+ * the line-by-line code continues with this line.
+ * Return the number of rows read.
+ */
+{
+    char **start,*p,*q,*buf;
+    int *lnum,*err,n,i,j,k,done = 0,last = 0,ln;
+    size_t len,blen;
+    RAT *row;
+    
+    start = (char **) allo(CP 0,0,U SECT_CHUNK*sizeof(char *));
+    lnum = (int *) allo(CP 0,0,U SECT_CHUNK*sizeof(int));
+    err = (int *) allo(CP 0,0,U SECT_CHUNK*sizeof(int));
+    
+    while (!last) 
+    {
+        /* 
+         * Collect the next lines; empty lines are skipped. 
+         */
+        ln = *line;
+        for (n = 0, p = in_pos; n < SECT_CHUNK; p = q+1) 
+        {
+            if (!(q = memchr(p,'\n',in_end-p)))
+                break;
+            ln++;
+            for (k = 0; p+k < q && (p[k] == ' ' || p[k] == '\t'); k++);
+            if (p+k == q)
+                continue;
+            if (!(p = skip_head(p)))
+                break;
+            if ((*p < '0' || *p > '9') && *p != '+' && *p != '-' 
+                && (type == 0 || *p != 'x'))
+                break;
+            start[n] = p;
+            lnum[n++] = ln;
+        }
+        if (n < SECT_CHUNK)
+            last = 1;
+        if (n == 0)
+            break;
+        
+        if (first+done+n+1 > *maxrows) 
+        {
+            i = *maxrows;
+            while (first+done+n+1 > *maxrows)
+                *maxrows += INCR_INSYS_ROW;
+            *ar = (RAT *) RATallo(*ar,i*rowl,(*maxrows)*rowl);
+        }
+        row = *ar+(first+done)*rowl;
+        
+#pragma omp parallel private(buf,blen,len) if (n > 256) copyin(porta_cur)
+        {
+            buf = 0;
+            blen = 0;
+#pragma omp for schedule(dynamic,256)
+            for (i = 0; i < n; i++) 
+            {
+                if (type == 0) 
+                {
+                    err[i] = scan_nums(row+i*rowl,0,ndim,start[i]);
+                    continue;
+                }
+                len = (char *) memchr(start[i],'\n',in_end-start[i])-start[i]+3;
+                if (len > blen) 
+                {
+                    buf = lallo(buf,blen,len+blen);
+                    blen += len;
+                }
+                squeeze_line(start[i],buf);
+                err[i] = scan_eqie(row+i*rowl,ndim,buf,1);
+            }
+            lallo(buf,blen,0);
+        }
+        
+        for (i = 0; i < n && !err[i]; i++);
+        if (i < n) 
+        {
+            /* 
+             * Continue line by line at line i, 
+             * the rows from i on are cleared for this.
+             */
+            for (j = i*rowl; j < n*rowl; j++) 
             {
-                /* default denominator = 1 */
-                in_line--;
-                (val.den.i = 1);
+                row[j].num = 0;
+                row[j].den.i = 1;
             }
+            n = i;
+            last = 1;
         }
-
-        if (type == 0)
-            *rat_in = val;
-        else if (type == 1)
-            I_RAT_add(val,*rat_in,rat_in);
-        else
-            *(int_in+j) = val.num;
+        
+        /* position on the line after the last one read */
+        if (n > 0) 
+        {
+            in_pos = (char *) memchr(start[n-1],'\n',in_end-start[n-1])+1;
+            *line = lnum[n-1];
+        }
+        done += n;
     }
+    
+    allo(CP start,U SECT_CHUNK*sizeof(char *),0);
+    allo(CP lnum,U SECT_CHUNK*sizeof(int),0);
+    allo(CP err,U SECT_CHUNK*sizeof(int),0);
+    
+    return(done);
+}
 
-    /* 
-     * change by M.S. 1.7.92:
-     * the following three lines lead to the rejection of
-     * "(..) 1 1  # statistical part\n"
-     * As for inequality-lines, the comment sign # should also be allowed
-     * for point-lines.
-     *
-     *  for (ch = getc(fp); ch != '\n' ; ch = getc(fp))
-     *    if (ch != ' ') 
-     *      msg("%sline : %i invalid format of input file ","",line);
-     */
-    ch = *(in_line++);
-    while (ch != '\n'  && ch != '#') 
+
+
+
+
+
+
+
+
+
+
+
+
+
+int file_zip( char *fname )
+/*****************************************************************/
+/*
+ * Return i+1, if "fname" ends with the suffix of the compressed
+ * files zip_tab[i] (e.g. ".gz"), and 0 otherwise.
+ */
+{
+    int i,l,e;
+    
+    l = strlen(fname);
+    for (i = 0; i < ZIP_N; i++) 
     {
-        if (ch >= '0' && ch <= '9')
-            msg("%s, line %i : dimension error",fname,line);
-        /* too many numbers on the line */
-        else if (ch != ' ' && ch != '\t') 
-            msg("%s, line %i : invalid format of input file ",
-                fname,line);
-        ch = *(in_line++);
+        e = strlen(zip_tab[i].ext);
+        if (l > e && !strcmp(fname+l-e,zip_tab[i].ext))
+            return(i+1);
     }
-    
-    return(1);
+    return(0);
 }
 
 
@@ -187,12 +1080,25 @@ int scan_line( RAT *rat_in, int type, int d, int line,
 
 
 
-
-int nstrcmp( char *a, char *b1, char *b2, char *b3, char *b4, char *b5, char *b6, char *b7 )
+int file_ext( char *fname, char *ext )
+/*****************************************************************/
+/*
+ * Return 1, if "fname" ends with the extension "ext" (e.g. ".poi"),
+ * 2, if it ends with the binary counterpart of "ext" (e.g. ".poib"),
+ * and 0 otherwise. The suffix of a compressed file is ignored.
+ */
 {
-    return(strcmp(a,b1) && strcmp(a,b2) && strcmp(a,b3) && strcmp(a,b4) &&
-           strcmp(a,b5) && strcmp(a,b6) && strcmp(a,b7));
-} 
+    int l,e,z;
+    
+    z = file_zip(fname);
+    l = strlen(fname) - ((z) ? strlen(zip_tab[z-1].ext) : 0);
+    e = strlen(ext);
+    if (l >= e && !strncmp(fname+l-e,ext,e))
+        return(1);
+    if (l > e && fname[l-1] == 'b' && !strncmp(fname+l-e-1,ext,e))
+        return(2);
+    return(0);
+}
 
 
 
@@ -201,97 +1107,113 @@ int nstrcmp( char *a, char *b1, char *b2, char *b3, char *b4, char *b5, char *b6
 
 
 
-int scan_line2( int line, char fname[], char *in_line, char scanned_inline[] )
+
+void bin_open( char *fname, struct bin_view *v )
 /*****************************************************************/
 /*
- * Former get_line().
- * From a string "in_line",
- * remove all brackets and text inside.
- * Put a '+' in front the first 'x'.
- * Remove all blanks.
- * Output is string scanned_inline.
- * 
- * Change by M.S. 1.6.92:
- * remove also tabs
- *
- * Return 1, if line begins with a non-number (not counting blanks)
- * otherwise return 0.
+ * Map the binary file "fname" (.poib or .ieqb) into memory and set 
+ * the pointers of "v" to its sections (see inout.h). 
+ * Nothing is copied, the file stays mapped until bin_close().
  */
 {
-    int i = 0;
-    char ch;
+    struct bin_head *h;
+    size_t off;
+    int i,k,*mp;
     
-    ch = *(in_line++);
+    open_input(fname,"rb");
+    h = v->head = (struct bin_head *) in_buf;
+    if (in_size < sizeof(struct bin_head) || memcmp(h->magic,BIN_MAGIC,8))
+        msg( "%s : invalid format of binary file", fname, 0 );
+    if (h->order != BIN_ORDER)
+        msg( "%s : binary file with different byte order", fname, 0 );
+    if ((h->kind != BIN_POI && h->kind != BIN_IEQ)
+        || (h->kind == BIN_IEQ) != (file_ext(fname,".ieq") == 2)
+        || h->ndim <= 0 || h->cols != h->ndim+1+h->kind 
+        || h->rows < 0 || h->nmp < 0 || h->markw < 0)
+        msg( "%s : invalid format of binary file", fname, 0 );
     
-    for (  ; ch != '\n'; ch = *(in_line++)) 
+    off = sizeof(struct bin_head);
+    v->valid = 0;
+    if (h->flags & BIN_VALID) 
     {
-        if (ch == 'x' && i == 0)
-            scanned_inline[i++] = '+';
-        if (i < MAXLINE-1) 
+        v->valid = (struct bin_ent *) (in_buf+off);
+        off += h->ndim*sizeof(struct bin_ent);
+    }
+    v->sys = (struct bin_ent *) (in_buf+off);
+    off += (size_t) h->rows*h->cols*sizeof(struct bin_ent);
+    
+    v->mp = (int *) (in_buf+off);
+    for (i = 0; i < h->nmp && off+4*sizeof(int) <= in_size; i++) 
+    {
+        mp = (int *) (in_buf+off);
+        off += (4+abs(mp[2])+mp[3])*sizeof(int);
+    }
+    
+    v->mark = (h->markw) ? (unsigned *) (in_buf+off) : 0;
+    off += (size_t) h->rows*h->markw*szU;
+    for (k = 0; k < 3; k++) 
+    {
+        v->list[k] = 0;
+        if (h->flags & (BIN_ELIM << k)) 
         {
-            /* || (i > 0 ? in_line[i-1] != ' ' : 1)) */
-            if (ch != ' ' && ch != '\t') 
-                scanned_inline[i++] = ch;
+            v->list[k] = (int *) (in_buf+off);
+            off += h->ndim*sizeof(int);
         }
-        else 
-            msg("%s, line %i : line too long ",fname,line);
     }
-    
-    scanned_inline[i] = '\0';
-    /* scanned_inline ends with "\0", but not with "\n\0" */
-    ch = scanned_inline[0];
-    if ((ch < '0' || ch > '9') && ch != '+' && ch !=  '-')
-        return(0);
-    return (1);
-}     
+    if (i < h->nmp || off > in_size)
+        msg( "%s : binary file too short", fname, 0 );
+}
+
+
 
 
 
 
 
 
+void bin_close()
+{
+    close_input();
+}
+
+
+
 
 
 
 
 
-int get_line( FILE *fp, char fname[], char in_line[], int *line )
+static void input_ok( char *fname, int ndim, int ieqs, int n1, int n2 )
 /*****************************************************************/
 /*
- * Read a line from input file fp into string in_line,
- * without changing this string.
- * Return 0 if in_line consists only of blanks, tabs, and one newline,
- * otherwise return 1.
+ * Report the numbers of (in)equalities or points read.
  */
 {
-    char ch;
-    char *ptr;
-    int i, nonempty;
-    
-    (*line)++;
-    i = 1;
-    nonempty = 0;
-    ptr = in_line;
-    do 
+    fprintf(prt,"input file %s o.k.\n",fname);
+    fprintf(prt,  "dimension              : %4i \n",ndim);
+
+    /* 17.01.1994: include logging on file porta.log */
+    porta_log( "input file %s o.k.\n",fname);
+    porta_log( "dimension              : %4i \n",ndim);
+
+    if (ieqs) 
     {
-        ch = (char)getc(fp);
-        *ptr = (char) ch;
-        ptr++;
-        if (i++ >= MAXLINE) 
-            msg("%s, line %i : line too long ",fname,*line);
-        if (ch != ' ' &&  ch != '\t' && ch != '\n')
-            nonempty = 1;
-    } 
-    while ( ch != '\n' && (int) ch != EOF);
-    *ptr = '\0';
-    if ((int) ch == EOF)
+        fprintf(prt,"number of equations    : %4i \n",n1);
+        fprintf(prt,"number of inequalities : %4i \n\n",n2);
+
+        /* 17.01.1994: include logging on file porta.log */
+        porta_log( "number of equations    : %4i \n",n1);
+        porta_log( "number of inequalities : %4i \n\n",n2);
+    }
+    else 
     {
-        msg("%s, line %i: invalid format",fname,*line);
-        return 0; // dummy
+        fprintf(prt,"number of cone-points  : %4i \n",n1);
+        fprintf(prt,"number of conv-points  : %4i \n\n",n2);
+
+        /* 17.01.1994: include logging on file porta.log */
+        porta_log( "number of cone-points  : %4i \n",n1);
+        porta_log( "number of conv-points  : %4i \n\n",n2);
     }
-    else
-        return (nonempty);
-    /* in_line ends with "\n\0" */
 }
 
 
@@ -301,14 +1223,167 @@ int get_line( FILE *fp, char fname[], char in_line[], int *line )
 
 
 
+static int read_bin_file( char *fname, FILE *outfp, int *ndim, RAT **ar, 
+                          int *nel_ar, char *intkey1, int **intli1, 
+                          char *intkey2, int **intli2, char *RATkey1, 
+                          RAT **RATli1 )
+/*****************************************************************/
+/*
+ * Read the binary file "fname" (.poib or .ieqb), see read_input_file().
+ * Where the table entries have the layout of RAT, 
+ * the table is copied into "ar" as a whole. It is copied, not adopted:
+ * "ar" is resized with RATallo() and changed in place by the callers,
+ * and it needs one row more than the file holds.
+ * If "outfp" exists, the keyword sections are written to outfp as text.
+ */
+{
+    struct bin_view v;
+    struct bin_ent *e;
+    RAT *r;
+    int i,j,k,n,rowl,ieqs,ndat,last = -1,nflag = 0;
+    static char *keys[3] = 
+        { "ELIMINATION_ORDER", "LOWER_BOUNDS", "UPPER_BOUNDS" };
+    
+    bin_open(fname,&v);
+    ieqs = (v.head->kind == BIN_IEQ);
+    *ndim = v.head->ndim;
+    rowl = v.head->cols;
+    n = v.head->rows;
+    ndat = rowl-1;
+    if (v.head->nmp)
+        msg( "%s : coefficients beyond the integer range can not be read",
+             fname, 0 );
+    
+    *nel_ar = (n+1)*rowl;
+    *ar = (RAT *) RATallo(*ar,0,*nel_ar);
+    if (sizeof(RAT) == sizeof(struct bin_ent) && sizeof(long) == 8)
+        memcpy(*ar,v.sys,(size_t) n*rowl*sizeof(RAT));
+    else
+        for (k = 0; k < n*rowl; k++) 
+        {
+            (*ar)[k].num = v.sys[k].num;
+            (*ar)[k].den.i = v.sys[k].den;
+        }
+    
+    for (i = 0, r = *ar; i < n; i++, r += rowl) 
+    {
+        for (j = 0; j < ndat; j++) 
+        {
+            if (r[j].den.i <= 0)
+                msg( "%s, row %i : invalid denominator", fname, i+1 );
+            if (r[j].num > INT_MAX || r[j].num < -INT_MAX)
+                msg( "%s, row %i : arithmetic overflow", fname, i+1 );
+        }
+        if ((r[ndat].num != 0 && r[ndat].num != 1) || r[ndat].den.i != 1)
+            msg( "%s, row %i : invalid format", fname, i+1 );
+        if (r[ndat].num) 
+        {
+            nflag++;
+            last = i;
+        }
+    }
+    
+    /* 
+     * ar6 is the last conv-point of a .poib file,
+     * the VALID point of a .ieqb file (unless asked for by RATkey1), or 0.
+     */
+    ar6 = (RAT *) RATallo(ar6,0,*ndim);
+    for (j = 0; j < *ndim; j++) 
+    {
+        ar6[j].num = 0;
+        ar6[j].den.i = 1;
+    }
+    if (!ieqs && last >= 0)
+        for (j = 0; j < *ndim; j++)
+            ar6[j] = (*ar)[last*rowl+j];
+    if (ieqs && v.valid) 
+    {
+        if (strcmp(RATkey1,"VALID") == 0)
+            r = *RATli1 = (RAT *) RATallo((RAT *) 0,0,*ndim);
+        else
+            r = ar6;
+        for (j = 0, e = v.valid; j < *ndim; j++, e++) 
+        {
+            if (e->den <= 0)
+                msg( "%s : invalid denominator in VALID", fname, 0 );
+            r[j].num = e->num;
+            r[j].den.i = e->den;
+        }
+    }
+    
+    if (outfp) 
+    {
+        fprintf(outfp,"DIM = %d\n\n",*ndim);
+        if (ieqs && v.valid) 
+        {
+            fprintf(outfp,"VALID\n");
+            for (j = 0; j < *ndim; j++) 
+            {
+                fprintf(outfp,"%lld",v.valid[j].num);
+                if (v.valid[j].den != 1)
+                    fprintf(outfp,"/%d",v.valid[j].den);
+                fprintf(outfp," ");
+            }
+            fprintf(outfp,"\n\n");
+        }
+        for (k = 0; k < 3; k++)
+            if (v.list[k]) 
+            {
+                fprintf(outfp,"%s\n",keys[k]);
+                for (j = 0; j < *ndim; j++)
+                    fprintf(outfp,"%d ",v.list[k][j]);
+                fprintf(outfp,"\n\n");
+            }
+    }
+    
+    for (k = 0; k < 3; k++)
+        if (v.list[k]) 
+        {
+            if (is_set(Sort)) 
+            {
+                in_list[k] = (int *) allo(CP in_list[k],0,*ndim*sizeof(int));
+                memcpy(in_list[k],v.list[k],*ndim*sizeof(int));
+            }
+            if (strcmp(intkey1,keys[k]) == 0) 
+            {
+                *intli1 = (int *) allo(*intli1,0,*ndim*sizeof(int));
+                memcpy(*intli1,v.list[k],*ndim*sizeof(int));
+            }
+            else if (strcmp(intkey2,keys[k]) == 0) 
+            {
+                *intli2 = (int *) allo(*intli2,0,*ndim*sizeof(int));
+                memcpy(*intli2,v.list[k],*ndim*sizeof(int));
+            }
+        }
+    
+    bin_close();
+    
+    if (ieqs) 
+    {
+        equa = n-nflag;
+        ineq = nflag;
+    }
+    input_ok(fname,*ndim,ieqs,n-nflag,nflag);
+    
+    return(n);
+}
+
+
+
+
 
 
 
 
+/*
+ * read_input_file() and read_eqie() scan the lines read by get_line().
+ */
+#define in_line ln_buf
+#define scanned_inline sq_buf
 
 
 
-int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar, 
+int read_input_file( char *fname, FILE *outfp, int *ndim, RAT **ar, int *nel_ar, 
                      char *intkey1, int **intli1, char *intkey2, int **intli2,
                      char *RATkey1, RAT **RATli1 )
 /*****************************************************************/
@@ -328,14 +1403,12 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
  * and END.
  */
 {
-    int i,j,ieqs,nonempty,arrows=0,arrowl=0,cone = 0,conv = 0,line;
+    int i,j,k,ieqs,nonempty,arrows=0,arrowl=0,ncone = 0,nconv = 0,line;
     int *hip;
     char *in,*end = "END",
     equalities[22],
     convstr[13],conestr[13],key_eli[18],key_val[6],key_low[13],key_upp[13], 
     *comm = "COMMENT" ;
-    char scanned_inline[MAXLINE];
-    char in_line[MAXLINE];
     RAT val;
 
     line = 0;
@@ -346,9 +1419,10 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
     strcpy (key_val,"VALID");
     strcpy (key_upp,"UPPER_BOUNDS");
     strcpy (key_low,"LOWER_BOUNDS");
-    fp = fopen(fname,"r");
-    if (fp == 0)
-        msg( "%s : no such file", fname, 0 );
+    if (file_ext(fname,".poi") == 2 || file_ext(fname,".ieq") == 2)
+        return(read_bin_file(fname,outfp,ndim,ar,nel_ar,intkey1,intli1,
+                             intkey2,intli2,RATkey1,RATli1));
+    open_input(fname,"r");
     
     /* 
      * Read the first line into string "in_line". Leading blanks are skipped.
@@ -357,7 +1431,7 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
     
     do 
     {
-        nonempty = get_line(fp,fname,in_line,&line );
+        nonempty = get_line(fname,&line);
     } 
     while (!nonempty);
     
@@ -365,8 +1439,8 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
     if (strncmp(scanned_inline,"DIM=",4) == 0) 
     {
         in = scanned_inline+4;
-        *dim = atoi(in);
-        if (*dim == 0) 
+        *ndim = atoi(in);
+        if (*ndim == 0) 
             msg("%s, line %i : dimension error",fname,line);
         if (outfp) 
         {
@@ -376,12 +1450,12 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
             porta_log( "%s",in_line);
         }
     }
-    ieqs = (strcmp(fname+strlen(fname)-4,".ieq") == 0);
+    ieqs = (file_ext(fname,".ieq") == 1);
     if( ieqs ) 
     {
         equa = ineq = 0;
         convstr[0] = conestr[0] = '\n';
-        arrowl = *dim+2;
+        arrowl = *ndim+2;
         if (!strcmp(intkey1,"ELIMINATION_ORDER") || !strcmp(intkey2,"ELIMINATION_ORDER"))
             key_eli[0] =  '\n'; 
         if (!strcmp(intkey1,"LOWER_BOUNDS") || !strcmp(intkey2,"LOWER_BOUNDS"))
@@ -402,9 +1476,9 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
          * so that the keywords "CONV_SECTION" and "CONE_SECTION" 
          * result in an error message, if they appear in the .ieq file.
          */
-        cone = conv = 0;
+        ncone = nconv = 0;
         key_val[0] = key_upp[0] = key_low[0] = key_eli[0] = equalities[0] = '\n';
-        arrowl = *dim+1;
+        arrowl = *ndim+1;
     }
     
     /* 
@@ -412,15 +1486,15 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
      * It is overwritten by a point in the CONV_SECTION,
      * or by a point in the VALID section.
      */
-    ar6 = (RAT *) RATallo(ar6,0,*dim);
-    for (j = 0; j < *dim; j++) 
+    ar6 = (RAT *) RATallo(ar6,0,*ndim);
+    for (j = 0; j < *ndim; j++) 
     {
         ar6[j].num = 0;
         ar6[j].den.i = 1;
     }
     
     /* Read the next line into string "in_line" and scan it */
-    nonempty = get_line(fp,fname,in_line,&line );
+    nonempty = get_line(fname,&line);
     scan_line(&val,3,0,line,fname,in_line,scanned_inline);
     do 
     {
@@ -433,7 +1507,7 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 /* 17.01.1994: include logging on file porta.log */
                 porta_log( "%s",in_line);
             }
-            nonempty = get_line(fp,fname,in_line,&line);
+            nonempty = get_line(fname,&line);
             scan_line(&val,3,0,line,fname,in_line,scanned_inline);
         }
         else if (strncmp(scanned_inline,comm,7) == 0) 
@@ -452,7 +1526,7 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                     /* 17.01.1994: include logging on file porta.log */
                     porta_log( "%s",in_line);
                 }
-                nonempty = get_line(fp,fname,in_line,&line);
+                nonempty = get_line(fname,&line);
                 scan_line(&val,3,0,line,fname,in_line,scanned_inline);
             } 
             while (nstrcmp(scanned_inline,conestr,equalities,end,
@@ -483,10 +1557,10 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                RATkey1[0] = '\n';
                *RATli1 = (RAT *) RATallo(*RATkey1,0,*dim);
                */
-            *RATli1 = (RAT *) RATallo(CP 0,0,*dim);
+            *RATli1 = (RAT *) RATallo((RAT *) 0,0,*ndim);
             do 
             {
-                nonempty = get_line(fp,fname,in_line,&line);
+                nonempty = get_line(fname,&line);
                 if(outfp)
                 {
                     fprintf(outfp,"%s",in_line);
@@ -496,8 +1570,8 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 }
             } 
             while (!nonempty);
-            scan_line(*RATli1,1,*dim,line,fname,in_line,scanned_inline);
-            nonempty = get_line(fp,fname,in_line,&line);
+            scan_line(*RATli1,1,*ndim,line,fname,in_line,scanned_inline);
+            nonempty = get_line(fname,&line);
             scan_line(&val,3,0,line,fname,in_line,scanned_inline);
         }
         else if (strcmp(scanned_inline,key_val) == 0) 
@@ -523,7 +1597,7 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
              */
             do 
             {
-                nonempty = get_line(fp,fname,in_line,&line);
+                nonempty = get_line(fname,&line);
                 if(outfp)
                 {
                     fprintf(outfp,"%s",in_line);
@@ -533,8 +1607,8 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 }
             } 
             while (!nonempty);
-            scan_line(ar6,1,*dim,line,fname,in_line,scanned_inline);
-            nonempty = get_line(fp,fname,in_line,&line);
+            scan_line(ar6,1,*ndim,line,fname,in_line,scanned_inline);
+            nonempty = get_line(fname,&line);
             scan_line(&val,3,0,line,fname,in_line,scanned_inline);
             /* change by M.S. 31.5.92: 
              * "ar6" is also used when reading the CONV_SECTION, so don't free it.
@@ -551,10 +1625,10 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 porta_log( "%s",in_line);
             }
             intkey1[0] = '\n';
-            *intli1 = (int *) allo(*intli1,0,*dim*sizeof(int));
+            *intli1 = (int *) allo(*intli1,0,*ndim*sizeof(int));
             do 
             {
-                nonempty = get_line(fp,fname,in_line,&line);
+                nonempty = get_line(fname,&line);
                 if(outfp)
                 { 
                     fprintf(outfp,"%s",in_line);
@@ -564,8 +1638,8 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 }
             } 
             while (!nonempty);
-            scan_line((RAT *)*intli1,2,*dim,line,fname,in_line,scanned_inline);
-            nonempty = get_line(fp,fname,in_line,&line);
+            scan_line((RAT *)*intli1,2,*ndim,line,fname,in_line,scanned_inline);
+            nonempty = get_line(fname,&line);
             scan_line(&val,3,0,line,fname,in_line,scanned_inline);
         }
         else if (strcmp(scanned_inline,intkey2) == 0) 
@@ -578,10 +1652,10 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 porta_log( "%s",in_line);
             }
             intkey2[0] = '\n';
-            *intli2 = (int *) allo(*intli2,0,*dim*sizeof(int));
+            *intli2 = (int *) allo(*intli2,0,*ndim*sizeof(int));
             do 
             {
-                nonempty = get_line(fp,fname,in_line,&line);
+                nonempty = get_line(fname,&line);
                 if(outfp)
                 { 
                     fprintf(outfp,"%s",in_line);
@@ -591,8 +1665,8 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 }
             } 
             while (!nonempty);
-            scan_line((RAT *)*intli2,2,*dim,line,fname,in_line,scanned_inline);
-            nonempty = get_line(fp,fname,in_line,&line);
+            scan_line((RAT *)*intli2,2,*ndim,line,fname,in_line,scanned_inline);
+            nonempty = get_line(fname,&line);
             scan_line(&val,3,0,line,fname,in_line,scanned_inline);
         }
         else if (!strcmp(scanned_inline,key_eli) 
@@ -609,13 +1683,15 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 /* 17.01.1994: include logging on file porta.log */
                 porta_log( "%s",in_line);
             }
+            k = (!strcmp(scanned_inline,key_eli)) ? 0 
+                : (!strcmp(scanned_inline,key_low)) ? 1 : 2;
             if (!strcmp(scanned_inline,key_eli))   key_eli[0] = '\n';
             if (!strcmp(scanned_inline,key_low))   key_low[0] = '\n';
             if (!strcmp(scanned_inline,key_upp))   key_upp[0] = '\n';
-            hip = (int *) allo(CP 0,0,*dim*sizeof(int));
+            hip = (int *) allo(CP 0,0,*ndim*sizeof(int));
             do 
             {
-                nonempty = get_line(fp,fname,in_line,&line);
+                nonempty = get_line(fname,&line);
                 if(outfp)
                 { 
                     fprintf(outfp,"%s",in_line);
@@ -625,10 +1701,18 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 }
             } 
             while (!nonempty);
-            scan_line((RAT *)hip,2,*dim,line,fname,in_line,scanned_inline);
-            nonempty = get_line(fp,fname,in_line,&line);
+            scan_line((RAT *)hip,2,*ndim,line,fname,in_line,scanned_inline);
+            nonempty = get_line(fname,&line);
             scan_line(&val,3,0,line,fname,in_line,scanned_inline);
-            hip = (int *) allo(hip,*dim*sizeof(int),0);
+            if (is_set(Sort)) 
+            {
+                /* keep the line for a binary output file */
+                if (in_list[k])
+                    allo(CP in_list[k],*ndim*sizeof(int),0);
+                in_list[k] = hip;
+            }
+            else
+                hip = (int *) allo(hip,*ndim*sizeof(int),0);
         }
         else if (strcmp(scanned_inline, convstr) == 0) 
         {
@@ -642,16 +1726,20 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
             *ar = (RAT *) RATallo(*ar,arrows*arrowl,
                                   (arrows+INCR_INSYS_ROW)*arrowl);
             arrows += INCR_INSYS_ROW;
+            i = read_sect(ar,&arrows,arrowl,nconv+ncone,*ndim,0,&line,fname);
+            for (j = nconv+ncone; j < nconv+ncone+i; j++)
+                (*ar+j*arrowl+*ndim)->num = 1;
+            nconv += i;
             do 
             {
-                nonempty = get_line(fp,fname,in_line,&line);
+                nonempty = get_line(fname,&line);
             } 
             while (!nonempty);
-            while (scan_line(*ar+(conv+cone)*arrowl,0,*dim,line,fname,
+            while (scan_line(*ar+(nconv+ncone)*arrowl,0,*ndim,line,fname,
                              in_line,scanned_inline)) 
             {
-                (*ar+(conv+cone)*arrowl+*dim)->num = 1;
-                if (conv+cone+2 > arrows) 
+                (*ar+(nconv+ncone)*arrowl+*ndim)->num = 1;
+                if (nconv+ncone+2 > arrows) 
                 {
                     *ar = (RAT *) RATallo(*ar,arrows*arrowl,
                                     (arrows+INCR_INSYS_ROW)*arrowl);
@@ -659,14 +1747,14 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 }
                 do 
                 {
-                    nonempty = get_line(fp,fname,in_line,&line);
+                    nonempty = get_line(fname,&line);
                 } 
                 while (!nonempty);
-                conv++;
+                nconv++;
             }
             /* repeat the last point in array "ar6" */
-            for (j = 0; j < *dim; j++)
-                ar6[j] = (*ar+(conv+cone-1)*arrowl)[j];
+            for (j = 0; j < *ndim; j++)
+                ar6[j] = (*ar+(nconv+ncone-1)*arrowl)[j];
         }
         else if ((strcmp(scanned_inline, conestr) == 0)) 
         {
@@ -678,15 +1766,16 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
             *ar = (RAT *) RATallo(*ar,arrows*arrowl,
                                   (arrows+INCR_INSYS_ROW)*arrowl);
             arrows += INCR_INSYS_ROW;
+            ncone += read_sect(ar,&arrows,arrowl,nconv+ncone,*ndim,0,&line,fname);
             do 
             {
-                nonempty = get_line(fp,fname,in_line,&line);
+                nonempty = get_line(fname,&line);
             } 
             while (!nonempty);
-            while (scan_line(*ar+(conv+cone)*arrowl,0,*dim,line,fname,
+            while (scan_line(*ar+(nconv+ncone)*arrowl,0,*ndim,line,fname,
                              in_line,scanned_inline)) 
             {
-                if (conv+cone+2 > arrows) 
+                if (nconv+ncone+2 > arrows) 
                 {
                     *ar = (RAT *) RATallo(*ar,arrows*arrowl,
                                           (arrows+INCR_INSYS_ROW)*arrowl);
@@ -694,10 +1783,10 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
                 }
                 do 
                 {
-                    nonempty = get_line(fp,fname,in_line,&line);
+                    nonempty = get_line(fname,&line);
                 } 
                 while (!nonempty);
-                cone++;
+                ncone++;
             }
         }
         else if ( (strcmp(scanned_inline, equalities) == 0)) 
@@ -710,45 +1799,21 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
             *ar = (RAT *) RATallo(*ar,arrows*arrowl,
                                   (arrows+INCR_INSYS_ROW)*arrowl);
             arrows += INCR_INSYS_ROW;
-            read_eqie(ar,*dim,&equa,&ineq,&arrows,&line,
-                      fname,in_line,scanned_inline);
+            read_eqie(ar,*ndim,&equa,&ineq,&arrows,&line,fname);
             nonempty = 1;
         }
         else if (strcmp(scanned_inline,end) == 0)
         {
-            i =  (ieqs) ? equa+ineq : conv+cone;
+            i =  (ieqs) ? equa+ineq : nconv+ncone;
             
             *nel_ar = (i+1)*arrowl;
             
             *ar = (RAT *) RATallo(*ar,arrows*arrowl,*nel_ar);
             
-            fclose(fp);
+            close_input();
             
-            fprintf(prt,"input file %s o.k.\n",fname);
-            fprintf(prt,  "dimension              : %4i \n",*dim);
-
-            /* 17.01.1994: include logging on file porta.log */
-            porta_log( "input file %s o.k.\n",fname);
-            porta_log( "dimension              : %4i \n",*dim);
-
-            if (ieqs) 
-            {
-                fprintf(prt,"number of equations    : %4i \n",equa);
-                fprintf(prt,"number of inequalities : %4i \n\n",ineq);
-
-                /* 17.01.1994: include logging on file porta.log */
-                porta_log( "number of equations    : %4i \n",equa);
-                porta_log( "number of inequalities : %4i \n\n",ineq);
-            }
-            else 
-            {
-                fprintf(prt,"number of cone-points  : %4i \n",cone);
-                fprintf(prt,"number of conv-points  : %4i \n\n",conv);
-
-                /* 17.01.1994: include logging on file porta.log */
-                porta_log( "number of cone-points  : %4i \n",cone);
-                porta_log( "number of conv-points  : %4i \n\n",conv);
-            }
+            input_ok(fname,*ndim,ieqs,(ieqs) ? equa : ncone,
+                     (ieqs) ? ineq : nconv);
             
             return (i);
             
@@ -772,8 +1837,8 @@ int read_input_file( char *fname, FILE *outfp, int *dim, RAT **ar, int *nel_ar,
 
 
 
-void read_eqie( RAT **ar, int dim, int *equa, int *ineq, int *maxrows, int *line,
-               char *fname, char in_line[], char *scanned_inline )
+void read_eqie( RAT **ar, int ndim, int *nequa, int *nineq, int *maxrows, int *line,
+               char *fname )
 /*****************************************************************/
 /*
  * Read the INEQUALITY_SECTION into the table "ar".
@@ -788,195 +1853,55 @@ void read_eqie( RAT **ar, int dim, int *equa, int *ineq, int *maxrows, int *line
  *   "x1 -x2 <= 4"
  */
 {
-    char *p,*in;
-    int i,rs=0,index=0,j,sysrow, numberread,nonempty;
+    int i,j,sysrow,nonempty,err;
     RAT val;
 
-    sysrow = dim+2; /* row length of array "ar" */
-    do 
-    {
-        nonempty = get_line(fp,fname,in_line,line);
-    } 
-    while (!nonempty);
-    for (i = 0; scan_line(&val,3,dim,*line,
-                          fname,in_line,scanned_inline);
-         i++) 
-    {
-        /* 
-         * scan_line() reads an inequality into string "scanned_inline",
-         * with a little formatting.
-         * "val" is not used.
-         */
-        p = in = scanned_inline;
-        rs = 0;     /* rs records the type of inequality,
-                     * rs = 0 means: type not yet known. */
-        
-        /* scan string "scanned_inline" up to '\0' or '#' */
-        while (*p != '\0' && *p != '#' ) 
-        {
-            
-            val.den.i = 1;
-            val.num = 1;
-            if (*p == '-')
-                val.num = -1;
-        
-            /* 
-             * If: {+,-} has been read,
-             *     or {<,=,>} followed by {x,0,1,..,9} has been read,
-             *     or it is the beginning of the line. then ...
-             */
-            if ( *p == '-' || *p == '+'  || 
-                (p == scanned_inline || 
-                 (p != scanned_inline && (*(p-1)=='<' || *(p-1)=='=' || *(p-1)=='>')) 
-                 && ((*p < 58 && *p > 47) || *p =='x') )     ) 
-            {
-                numberread = 0;
-                if ( *p == '-' || *p == '+')    p++;
-                in = p;
-                while (*p > 47 && *p < 58)
-                    p++;
-                if (in != p) 
-                {
-                    /* in points to a number, p to the next non-number */
-                    numberread = 1;
-                    val.num *= atoi(in);
-                    if (*p == '/') 
-                    {
-                        p++;
-                        in = p;
-                        while (*p > 47 && *p < 58) p++;
-                        if (p == in)
-                            msg("%s, line %i : invalid denominator",
-                                fname,*line);
-                        if ((val.den.i = atoi(in)) <= 0)
-                            msg("%s, line %i : invalid denominator",
-                                fname,*line);
-                    }   
-                } /* if (in != p) */
-
-                if (*p == 'x') 
-                {
-                    p++;
-                    in = p;
-                    while (*p > 47 && *p < 58) p++;
-                    if (p == in) 
-                        msg("%s, line %i : invalid format",fname,*line);
-                    index = atoi(in)-1;
-                    if (index > dim-1 || index < 0)
-                        msg("%s, line %i : only variable names x1,...,xdim allowed",
-                            fname,*line);
-                }
-                /* 
-                 * Change by M.S. 1.6.92:
-                 * The following four lines of code are changed.
-                 *
-                 * In the case (*p in {+,-}), 
-                 * something like "10 +", but not "x10 +" has been encountered.
-                 * In the case (rs==0 && *p in {<,>,>} ),
-                 * something like "10 <", but not "x10 <" has been encountered.
-                 * In both cases, the number "10" is interpreted as part of
-                 * the right-hand side.
-                 * But it should be tested, 
-                 * whether a number has actually been read.
-                 * Otherwise
-                 * "x1++x2 <= 20\n"  is interpreted as
-                 * "x1+1+x2 <= 20\n".
-                 */
-                else if (numberread && (*p == '+' || *p == '-'  || 
-                          ((rs == 0) && (*p =='<'||*p == '>'||*p == '=')))) 
-                {
-                    index = dim;
-                }
-                /* The following four lines mean:
-                 * If "<=" or ">=" or "==" has already been read (i.e. rs > 0),
-                 * and if p points to the end of the line,
-                 * then interpret the number in val as the right hand side.
-                 * to be stored in the dim-th position of the current row
-                 * of table "ar".
-                 */
-                else if (numberread && rs && (*(p) == '\0' || *(p) == '#'))  
-                {
-                    index = dim;
-                }
-                else 
-                    msg("%s, line %i : invalid format",fname,*line);
-            } /* if ......... */
-
-            else if ((p != scanned_inline) 
-                     && (*p == '<' || *p == '>' || *p == '=')) 
-            {
-                /* 
-                 * Record the type of inequality:
-                 * rs = 1   if it is an equation ("=" or "==")
-                 * rs = 2   if it is a "<=" inequality (may also be written "=<")
-                 * rs = 3   if it is a ">=" inequality (may also be written "=>")
-                 */
-                if (++rs > 1) 
-                    msg("%s, line %i : invalid format",fname,*line);
-                if ((*p == '=') && (*(p+1) == '='))
-                    p++;
-                else if ((*p == '=') && (*(p+1) != '>') && (*(p+1) != '<'));
-                else if ((*p == '=' && *(p+1) == '>') ||
-                         (*p == '>' && *(p+1) == '=')) 
-                {
-                    rs++;rs++;
-                    p++;
-                }
-                else if ((*p == '=' && *(p+1) == '<') ||
-                         (*p == '<' && *(p+1) == '=')) 
-                {
-                    rs++; 
-                    p++;
-                }
-                else
-                    msg("%s, line %i : invalid format",fname,*line);
-                p++;
-                index = -1;
-            } /* else if < = > */
-            
-            else 
-                msg("%s, line %i : invalid format",fname,*line);
-            
-            if (index > -1)  
-            { /* not "< > =" */ 
-                if (index == dim) val.num *= -1;
-                if (rs ) 
-                    I_RAT_sub(*(*ar+i*sysrow+index),val,*ar+i*sysrow+index);
-                else
-                    I_RAT_add(*(*ar+i*sysrow+index),val,*ar+i*sysrow+index);
-            }
-            
-        } /* while */
-        
-        /* transform ">=" into "<=" by multiplying the inequality with -1 */
-        if (rs == 3 ) 
-        {  /* >= */
-            for (j = 0; j <= dim; j++)
-                (*ar+i*sysrow+j)->num = -(*ar+i*sysrow+j)->num;
-            rs -= 1;
-        }
-        (*ar+(i+1)*sysrow-1)->num  =  --rs; 
+    sysrow = ndim+2; /* row length of array "ar" */
+    
+    /* the bulk of the section is read by read_sect() */
+    i = read_sect(ar,maxrows,sysrow,0,ndim,3,line,fname);
+    for (j = 0; j < i; j++)
+        ((*ar+(j+1)*sysrow-1)->num == 1) ? (*nineq)++ : (*nequa)++;
+    
+    do 
+    {
+        nonempty = get_line(fname,line);
+    } 
+    while (!nonempty);
+    for (; scan_line(&val,3,ndim,*line,
+                     fname,in_line,scanned_inline);
+         i++) 
+    {
+        /* 
+         * scan_line() reads an inequality into string "scanned_inline",
+         * with a little formatting.
+         * "val" is not used.
+         */
+        if ((err = scan_eqie(*ar+i*sysrow,ndim,scanned_inline,0)))
+            msg(scan_msg[err],fname,*line);
     
         /* 
-         * Now rs = 0 if the line was an equation,
-         * and rs = 1 if the line was an inequality.
-         * The last line stored rs into the "dim+1"th position of ar[i].
+         * Now the "dim+1"th position of ar[i] is 0 if the line was 
+         * an equation, and 1 if the line was an inequality.
          */
-        (rs == 1) ? (*ineq)++ : (*equa)++;
+        ((*ar+(i+1)*sysrow-1)->num == 1) ? (*nineq)++ : (*nequa)++;
         
-        if ((*ineq)+(*equa)+2 > *maxrows) 
+        if ((*nineq)+(*nequa)+2 > *maxrows) 
         {
-            *ar = (RAT *) RATallo(*ar,(*maxrows)*(dim+2),(*maxrows+INCR_INSYS_ROW)*(dim+2));
+            *ar = (RAT *) RATallo(*ar,(*maxrows)*(ndim+2),(*maxrows+INCR_INSYS_ROW)*(ndim+2));
             *maxrows += INCR_INSYS_ROW;
         }
         do 
         {
-            nonempty = get_line(fp,fname,in_line,line);
+            nonempty = get_line(fname,line);
         } 
         while (!nonempty);
     }  /* for i */
 }
 
+#undef in_line
+#undef scanned_inline
+
 
 
 
@@ -994,6 +1919,8 @@ FILE *wfopen( char *fname )
     
     struct stat statbuf;
     char command[BUFSIZ];
+    FILE *ofp;
+    int i,z;
     
     if( !stat(fname,&statbuf) ) 
     {
@@ -1027,6 +1954,15 @@ FILE *wfopen( char *fname )
 #endif // WIN32
     }
 
+    if ((z = file_zip(fname)) != 0) 
+    {
+        for (i = 0; i < 8 && wf_pipe[i]; i++);
+        if (i == 8 || (ofp = zip_open(fname,z,1,wf_pid+i)) == 0)
+            msg( "%s : cannot open compressed file", fname, 0 );
+        return( wf_pipe[i] = ofp );
+    }
+    if (file_ext(fname,".poi") == 2 || file_ext(fname,".ieq") == 2)
+        return( fopen(fname,"wb") );
     return( fopen(fname,"w") );
     
 }
@@ -1038,61 +1974,139 @@ FILE *wfopen( char *fname )
 
 
 
-void write_ieq_file( char *fname, FILE *fp, int equa, int feq, int eqrl, 
-                     int *eqindx, int ineq, int fie, int ierl, int *ieindx )
+void wfclose( FILE *ofp )
+/*****************************************************************/
+/*
+ * Close a file opened by wfopen(), waiting for the compression
+ * of a compressed file to finish.
+ */
+{
+    int i;
+    
+    for (i = 0; i < 8 && wf_pipe[i] != ofp; i++);
+    if (i == 8) 
+    {
+        fclose(ofp);
+        return;
+    }
+    wf_pipe[i] = 0;
+    if (zip_close(ofp,wf_pid[i]))
+        msg( "cannot write compressed file", "", 0 );
+}
+
+
+
+
+
+
+
+
+void out_name( char *filename, char *fname, char *ext )
+/*****************************************************************/
+/*
+ * The name of the output file: "fname" followed by "ext". If "fname"
+ * is a compressed file, the text output file is compressed likewise
+ * ("fname" x.poi.gz gives x.poi.ieq.gz). Binary files are written
+ * uncompressed, since bin_end() has to seek back to the header.
+ */
+{
+    int z,l;
+    
+    strcpy(filename,fname);
+    if ((z = file_zip(fname)) == 0) 
+    {
+        strcat(filename,ext);
+        return;
+    }
+    l = strlen(fname)-strlen(zip_tab[z-1].ext);
+    strcpy(filename+l,ext);
+    if (ext[strlen(ext)-1] != 'b')
+        strcat(filename,zip_tab[z-1].ext);
+}
+
+
+
+
+
+
+
+
+void write_ieq_file( char *fname, FILE *ofp, int nequa, int feq, int eqrl, 
+                     int *eqindx, int nineq, int fie, int ierl, int *ieindx )
 {
     char filename[100];
-    int i, start;
+    int i, start, bin;
     
-    fprintf(prt,"\nnumber of equations    : %4i \n",equa);
-    fprintf(prt,"number of inequalities : %4i \n\n",ineq);
+    fprintf(prt,"\nnumber of equations    : %4i \n",nequa);
+    fprintf(prt,"number of inequalities : %4i \n\n",nineq);
     
     /* 17.01.1994: include logging on file porta.log */
-    porta_log( "\nnumber of equations    : %4i \n",equa);
-    porta_log( "number of inequalities : %4i \n\n",ineq);
+    porta_log( "\nnumber of equations    : %4i \n",nequa);
+    porta_log( "number of inequalities : %4i \n\n",nineq);
     
-    strcpy(filename,fname);
-    strcat(filename,".ieq");
+    bin = is_set(Binary_out);
+    out_name(filename,fname,(bin) ? ".ieqb" : ".ieq");
     
-    if (!fp) 
+    if (bin) 
     {
-        fp = wfopen(filename);
-        fprintf(fp, "DIM = %d\n\n",dim);
+        ofp = wfopen(filename);
+        bin_begin(ofp,BIN_IEQ,dim,nequa+nineq,
+                  (is_set(Traf) || is_set(Sort)) ? ar6 : 0,
+                  (is_set(Sort)) ? in_list : 0,
+                  is_set(Validity_table_out) ? points : 0);
+        for (i = feq; i < feq+nequa; i++)
+            bin_row(ofp,porta_list[i]->sys,eqrl,eqindx,0,0);
+        for (i = fie; i < fie+nineq; i++)
+            bin_row(ofp,porta_list[i]->sys,ierl,ieindx,1,porta_list[i]->mark);
+        bin_end(ofp);
+        wfclose(ofp);
+        
+        fprintf(prt,"output written to file %s\n\n",filename);
+        
+        /* 17.01.1994: include logging on file porta.log */
+        porta_log( "output written to file %s\n\n",filename);
+        return;
+    }
+    
+    if (!ofp) 
+    {
+        ofp = wfopen(filename);
+        fprintf(ofp, "DIM = %d\n\n",dim);
         
         if (is_set(Traf) ) 
         {
-            fprintf(fp, "VALID\n");
+            fprintf(ofp, "VALID\n");
             for (i = 0; i< dim; i++) 
             {
-                fprintf(fp, "%ld", ar6[i].num);
+                fprintf(ofp, "%ld", ar6[i].num);
                 if (ar6[i].den.i > 1)
-                    fprintf(fp, "/%i ", ar6[i].den.i);
+                    fprintf(ofp, "/%i ", ar6[i].den.i);
                 else
-                    fprintf(fp, " ");
+                    fprintf(ofp, " ");
             }
-            fprintf(fp, "\n\n");
+            fprintf(ofp, "\n\n");
         }
     }
     
-    fprintf(fp, "INEQUALITIES_SECTION\n");
+    fprintf(ofp, "INEQUALITIES_SECTION\n");
 
     start=1;
-    if (equa) 
+    if (nequa) 
     {
-        writesys(fp,feq,feq+equa,eqrl,0,eqindx,'=',&start);
-        fprintf(fp,"\n");
+        writesys(ofp,feq,feq+nequa,eqrl,0,eqindx,'=',&start);
+        fprintf(ofp,"\n");
     }
     start=1;
 //    if (ineq) writesys(fp,fie,fie+ineq,ierl,0,ieindx,'<',&start); // J-D B: No, we want the output to be in a particular table form -> let's use a new format
-    if (ineq) writesys(fp,fie,fie+ineq,ierl,2,ieindx,'<',&start);
-    fprintf(fp,"\n");
+    if (nineq) writesys(ofp,fie,fie+nineq,ierl,2,ieindx,'<',&start);
+    fprintf(ofp,"\n");
     
-    fprintf(fp, "END\n");
+    fprintf(ofp, "END\n");
     
     if (is_set(Validity_table_out)) 
-        writepoionie(fp,fie,fie+ineq,points,0); 
+        writepoionie(ofp,fie,fie+nineq,points,0); 
     
-    fclose(fp);
+    wfclose(ofp);
     
     fprintf(prt,"output written to file %s\n\n",filename);
 
@@ -1108,66 +2122,94 @@ void write_ieq_file( char *fname, FILE *fp, int equa, int feq, int eqrl,
 
 
 
-void write_poi_file( char *fname, FILE *fp, int dim, int lr, int flr, 
-                     int cone, int fce, int conv, int fcv )
+void write_poi_file( char *fname, FILE *ofp, int ndim, int lr, int flr, 
+                     int ncone, int fce, int nconv, int fcv )
 {
     char filename[100];
-    int i,j,start;
+    int i,j,k,start,bin;
     
-    fprintf(prt,"\nnumber of cone-points  : %4i \n",cone+2*lr);
-    fprintf(prt,"number of conv-points  : %4i \n\n",conv);
+    fprintf(prt,"\nnumber of cone-points  : %4i \n",ncone+2*lr);
+    fprintf(prt,"number of conv-points  : %4i \n\n",nconv);
     
     /* 17.01.1994: include logging on file porta.log */
-    porta_log( "\nnumber of cone-points  : %4i \n",cone+2*lr);
-    porta_log( "number of conv-points  : %4i \n\n",conv);
+    porta_log( "\nnumber of cone-points  : %4i \n",ncone+2*lr);
+    porta_log( "number of conv-points  : %4i \n\n",nconv);
     
-    strcpy(filename,fname);
-    strcat(filename,".poi");          
+    bin = is_set(Binary_out);
+    out_name(filename,fname,(bin) ? ".poib" : ".poi");
+    
+    if (bin) 
+    {
+        ofp = wfopen(filename);
+        bin_begin(ofp,BIN_POI,ndim,ncone+2*lr+nconv,0,0,
+                  is_set(Validity_table_out) ? points-1 : 0);
+        /* CONE(xi,-xi,....) */
+        for (k = 0; k < 2; k++) 
+        {
+            for (i = flr; i < flr+lr; i++)
+                bin_row(ofp,porta_list[i]->sys,ndim,0,0,0);
+            for (i = flr; i < flr+lr; i++)
+                for (j = 0; j < ndim; j++) 
+                    (porta_list[i]->sys+j)->num *= -1;
+        }
+        for (i = fce; i < fce+ncone; i++)
+            bin_row(ofp,porta_list[i]->sys,ndim,0,0,porta_list[i]->mark);
+        for (i = fcv; i < fcv+nconv; i++)
+            bin_row(ofp,porta_list[i]->sys,ndim,0,1,porta_list[i]->mark);
+        bin_end(ofp);
+        wfclose(ofp);
+        
+        fprintf(prt,"output written to file %s\n\n",filename);
+        
+        /* 17.01.1994: include logging on file porta.log */
+        porta_log( "output written to file %s\n\n",filename);
+        return;
+    }
     
-    if (!fp) 
+    if (!ofp) 
     {
-        fp = wfopen(filename);
-        fprintf(fp, "DIM = %d\n\n",dim);
+        ofp = wfopen(filename);
+        fprintf(ofp, "DIM = %d\n\n",ndim);
     }
     
     start = 1;
-    if (cone > 0 || lr > 0)  
+    if (ncone > 0 || lr > 0)  
     {
-        fprintf(fp, "CONE_SECTION\n");
+        fprintf(ofp, "CONE_SECTION\n");
         if (lr > 0) 
         {   
             /* CONE(xi,-xi,....) */
-            writesys(fp,flr,flr+lr,dim,1,0,' ',&start);
+            writesys(ofp,flr,flr+lr,ndim,1,0,' ',&start);
             for (i = flr; i < flr+lr; i++)
-                for (j = 0; j < dim; j++) 
+                for (j = 0; j < ndim; j++) 
                     (porta_list[i]->sys+j)->num *= -1;
-            writesys(fp,flr,flr+lr,dim,1,0,' ',&start);
+            writesys(ofp,flr,flr+lr,ndim,1,0,' ',&start);
             for (i = flr; i < flr+lr; i++)
-                for (j = 0; j < dim; j++) 
+                for (j = 0; j < ndim; j++) 
                     (porta_list[i]->sys+j)->num *= -1;
         }
-        writesys(fp,fce,fce+cone,dim,1,0,' ',&start);
-        fprintf(fp,"\n");
+        writesys(ofp,fce,fce+ncone,ndim,1,0,' ',&start);
+        fprintf(ofp,"\n");
     }
     
-    if (conv > 0) 
+    if (nconv > 0) 
     {
         start = 1;
-        fprintf(fp, "CONV_SECTION\n");
-        writesys(fp,fcv,fcv+conv,dim,1,0,' ',&start);
-        fprintf(fp,"\n");
+        fprintf(ofp, "CONV_SECTION\n");
+        writesys(ofp,fcv,fcv+nconv,ndim,1,0,' ',&start);
+        fprintf(ofp,"\n");
     }
-    fprintf(fp, "END\n");
+    fprintf(ofp, "END\n");
     
     if (is_set(Validity_table_out)) 
-        writepoionie(fp,0,ineq,points-1,1); 
+        writepoionie(ofp,0,ineq,points-1,1); 
     
     fprintf(prt,"output written to file %s\n\n",filename);
     
     /* 17.01.1994: include logging on file porta.log */
     porta_log( "output written to file %s\n\n",filename);
     
-    fclose(fp);
+    wfclose(ofp);
 }
 
   
@@ -1178,6 +2220,371 @@ void write_poi_file( char *fname, FILE *fp, int dim, int lr, int flr,
 
 
 
+/*
+ * The binary file being written (see bin_begin()).
+ */
+#define bw_head (porta_cur->bw_head)
+#define bw_row (porta_cur->bw_row)
+#define bw_mp (porta_cur->bw_mp)
+#define bw_mark (porta_cur->bw_mark)
+#define bw_mplen (porta_cur->bw_mplen)
+#define bw_mpcap (porta_cur->bw_mpcap)
+#define bw_n (porta_cur->bw_n)
+#define bw_rows (porta_cur->bw_rows)
+#define bw_list (porta_cur->bw_list)
+
+
+
+
+
+
+
+
+static void bin_put( RAT *x, struct bin_ent *e, int row, int col )
+/*****************************************************************/
+/*
+ * Store x into the table entry e, or, if x exceeds the integer range,
+ * into a multiple precision entry for row "row" and column "col".
+ */
+{
+    int nl,dl;
+    unsigned *p;
+    
+    e->pad = 0;
+    if (!MP_realised) 
+    {
+        e->num = x->num;
+        e->den = x->den.i;
+        return;
+    }
+    if (!x->num) 
+    {
+        e->num = 0;
+        e->den = 1;
+        return;
+    }
+    nl = get_numlen(x);
+    dl = get_denlen(x);
+    if (nl == 1 && dl <= 1 && x->den.p[0] <= INT_MAX 
+        && (!dl || x->den.p[1] <= INT_MAX)) 
+    {
+        e->num = (x->num < 0) ? -(long long) x->den.p[0] : x->den.p[0];
+        e->den = (dl) ? x->den.p[1] : 1;
+        return;
+    }
+    
+    if (bw_mplen+4+nl+dl > bw_mpcap) 
+    {
+        bw_mp = UP allo(CP bw_mp,U bw_mpcap*szU,U (bw_mpcap+4+nl+dl+BUFSIZ)*szU);
+        bw_mpcap += 4+nl+dl+BUFSIZ;
+    }
+    p = bw_mp+bw_mplen;
+    p[0] = row;
+    p[1] = col;
+    p[2] = (x->num < 0) ? -nl : nl;
+    p[3] = dl;
+    memcpy(p+4,x->den.p,(nl+dl)*szU);
+    bw_mplen += 4+nl+dl;
+    bw_head.nmp++;
+    e->num = e->den = 0;
+}
+
+
+
+
+
+
+
+
+void bin_begin( FILE *ofp, int kind, int ndim, int rows, RAT *valid, 
+                int **lists, int npoints )
+/*****************************************************************/
+/*
+ * Start the binary file "fp" (.poib or .ieqb) with "rows" rows.
+ * The point "valid" and the lines lists[0..2] (ELIMINATION_ORDER, 
+ * LOWER_BOUNDS, UPPER_BOUNDS) are stored, if given, and incidence 
+ * marks for "npoints" points, if npoints > 0.
+ * The rows are appended by bin_row(), bin_end() completes the file.
+ */
+{
+    int j;
+    
+    memset(&bw_head,0,sizeof(bw_head));
+    memcpy(bw_head.magic,BIN_MAGIC,8);
+    bw_head.order = BIN_ORDER;
+    bw_head.kind = kind;
+    bw_head.ndim = ndim;
+    bw_head.cols = ndim+1+kind;
+    bw_head.npoints = npoints;
+    bw_head.markw = (npoints > 0) ? npoints/32+1 : 0;
+    bw_head.flags = (valid) ? BIN_VALID : 0;
+    for (j = 0; lists && j < 3; j++)
+        if (lists[j])
+            bw_head.flags |= (BIN_ELIM << j);
+    bw_list = lists;
+    bw_rows = rows;
+    bw_n = 0;
+    bw_mp = 0;
+    bw_mplen = bw_mpcap = 0;
+    
+    bw_row = (struct bin_ent *) allo(CP 0,0,U bw_head.cols*sizeof(struct bin_ent));
+    bw_mark = 0;
+    if (bw_head.markw) 
+    {
+        bw_mark = UP allo(CP 0,0,U rows*bw_head.markw*szU);
+        memset(bw_mark,0,rows*bw_head.markw*szU);
+    }
+    
+    fwrite(&bw_head,sizeof(bw_head),1,ofp);
+    if (valid) 
+    {
+        /* as in write_ieq_file(), "valid" has integer values */
+        for (j = 0; j < ndim; j++) 
+        {
+            bw_row[j].num = valid[j].num;
+            bw_row[j].den = valid[j].den.i;
+            bw_row[j].pad = 0;
+        }
+        fwrite(bw_row,sizeof(struct bin_ent),ndim,ofp);
+    }
+}
+
+
+
+
+
+
+
+
+void bin_row( FILE *ofp, RAT *ptr, int n, int *indx, int flag, unsigned *mark )
+/*****************************************************************/
+/*
+ * Append a row to the binary file "fp".
+ * For a .poib file, "ptr" holds the n = dim coordinates of a point.
+ * For a .ieqb file, "ptr" holds the coefficients of the n-1 variables
+ * indx[0],...,indx[n-2] (0,...,n-2, if indx = 0) and the right hand side.
+ * "flag" is stored into the last column, "mark" into the incidence marks.
+ */
+{
+    int j,k,d;
+    
+    if (bw_n >= bw_rows)
+        return;
+    d = bw_head.ndim;
+    for (j = 0; j < bw_head.cols; j++) 
+    {
+        bw_row[j].num = 0;
+        bw_row[j].den = 1;
+        bw_row[j].pad = 0;
+    }
+    if (bw_head.kind == BIN_POI)
+        for (j = 0; j < n; j++)
+            bin_put(ptr+j,bw_row+j,bw_n,j);
+    else 
+    {
+        for (j = 0; j < n-1; j++) 
+        {
+            k = (indx) ? indx[j] : j;
+            bin_put(ptr+j,bw_row+k,bw_n,k);
+        }
+        bin_put(ptr+n-1,bw_row+d,bw_n,d);
+    }
+    bw_row[bw_head.cols-1].num = flag;
+    fwrite(bw_row,sizeof(struct bin_ent),bw_head.cols,ofp);
+    
+    if (mark && bw_mark)
+        memcpy(bw_mark+bw_n*bw_head.markw,mark,bw_head.markw*szU);
+    bw_n++;
+}
+
+
+
+
+
+
+
+
+void bin_end( FILE *ofp )
+/*****************************************************************/
+/*
+ * Append the multiple precision entries, the incidence marks and the
+ * lines to the binary file "fp", and complete the header.
+ */
+{
+    int j;
+    
+    bw_head.rows = bw_n;
+    if (bw_mplen)
+        fwrite(bw_mp,szU,bw_mplen,ofp);
+    if (bw_mark)
+        fwrite(bw_mark,szU,(size_t) bw_n*bw_head.markw,ofp);
+    for (j = 0; j < 3; j++)
+        if (bw_head.flags & (BIN_ELIM << j))
+            fwrite(bw_list[j],sizeof(int),bw_head.ndim,ofp);
+    fseek(ofp,0,SEEK_SET);
+    fwrite(&bw_head,sizeof(bw_head),1,ofp);
+    fseek(ofp,0,SEEK_END);
+    
+    allo(CP bw_row,U bw_head.cols*sizeof(struct bin_ent),0);
+    if (bw_mp)
+        allo(CP bw_mp,U bw_mpcap*szU,0);
+    if (bw_mark)
+        allo(CP bw_mark,U bw_rows*bw_head.markw*szU,0);
+    bw_row = 0;
+    bw_mp = bw_mark = 0;
+}
+
+
+
+
+
+
+
+
+
+/*
+ * Output buffer of writesys() and I_RAT_writeline(). The lines are
+ * formatted into ob_buf and written with fwrite() whenever more than
+ * OB_FLUSH characters have gathered, or at the end of a line written
+ * outside writesys() (ob_fp == 0).
+ */
+#define OB_FLUSH 1048576
+
+#define ob_buf (porta_cur->ob_buf)
+#define ob_len (porta_cur->ob_len)
+#define ob_cap (porta_cur->ob_cap)
+#define ob_fp (porta_cur->ob_fp)
+
+
+
+
+
+
+
+
+static void ob_need( size_t n )
+/*****************************/
+{
+    size_t cap;
+    
+    if (ob_len+n <= ob_cap) 
+        return;
+    for (cap = ob_cap ? ob_cap : OB_FLUSH+4096; cap < ob_len+n; cap *= 2);
+    ob_buf = allo(CP ob_buf,U ob_cap,U cap);
+    ob_cap = cap;
+}
+
+
+
+
+
+void free_io_buffers()
+/*****************************/
+/*
+ * Free the output buffer (see free_porta_context()).
+ */
+{
+    if (ob_buf)
+        allo(CP ob_buf,U ob_cap,0);
+    ob_buf = 0;
+    ob_len = ob_cap = 0;
+}
+
+
+
+
+
+
+
+
+static void ob_flush( FILE *ofp )
+/******************************/
+{
+    if (ob_len)
+        fwrite(ob_buf,1,ob_len,ofp);
+    ob_len = 0;
+}
+
+
+
+
+
+
+
+
+static void ob_spaces( int n )
+/****************************/
+{
+    if (n <= 0) 
+        return;
+    ob_need(n);
+    memset(ob_buf+ob_len,' ',n);
+    ob_len += n;
+}
+
+
+
+
+
+
+
+
+static void ob_str( char *s )
+/***************************/
+{
+    size_t n = strlen(s);
+    
+    ob_need(n);
+    memcpy(ob_buf+ob_len,s,n);
+    ob_len += n;
+}
+
+
+
+
+
+
+
+
+static void ob_int( long val, int width )
+/***************************************/
+/*
+ * Append val as printf("%*ld",width,val) does: right justified in
+ * width characters, left justified in -width characters if width < 0.
+ */
+{
+    char tmp[24], *t = tmp+sizeof(tmp);
+    unsigned long u;
+    int n, pad;
+    
+    u = (val < 0) ? -(unsigned long) val : (unsigned long) val;
+    do 
+    {
+        *--t = '0' + (char) (u % 10);
+        u /= 10;
+    } while (u);
+    if (val < 0)
+        *--t = '-';
+    n = (int) (tmp+sizeof(tmp)-t);
+    pad = ((width < 0) ? -width : width) - n;
+    
+    ob_need(n+((pad > 0) ? pad : 0));
+    if (width > 0)
+        ob_spaces(pad);
+    memcpy(ob_buf+ob_len,t,n);
+    ob_len += n;
+    if (width < 0)
+        ob_spaces(pad);
+}
+
+
+
+
+
+
+
+
+
 void max_vals( RAT *max, RAT *ptr, int col )
 { 
     int j,k;
@@ -1241,15 +2648,15 @@ void width_line( RAT *max, int col, int format )
 
 // RAT *max; // J-D B : seems not needed as a global variable, so definition put inside the writesys function...
 
-void writesys( FILE *fp, int frow, int lrow, int rowl, int format, 
+void writesys( FILE *ofp, int frow, int lrow, int rowl, int format, 
                int *indx, char eqie, int *start )
 {
     int i,j;
-    RAT *max;
+    RAT *max = 0;
     
-    if (!MP_realised) 
+    if (!MP_realised && !is_set(Unaligned_out)) 
     {
-        max = (RAT *) RATallo(CP 0,0,U rowl);
+        max = (RAT *) RATallo((RAT *) 0,0,U rowl);
         for (j = 0; j < rowl; j++) 
             max[j].num =  max[j].den.i = 0;
         
@@ -1261,6 +2668,7 @@ void writesys( FILE *fp, int frow, int lrow, int rowl, int format,
     
 	fprintf(prt, "\n  format = %i\n\n", format);
 
+    ob_fp = ofp;
     for (i = frow; i < lrow; i++)
     {
         /*
@@ -1268,15 +2676,23 @@ void writesys( FILE *fp, int frow, int lrow, int rowl, int format,
         */
 //        fprintf(fp,"(%3d) ",*start); // J-D B: We don't want to see the inequaliy/point number in fact.
         (*start)++;     
-        (* writeline)(fp,rowl,porta_list[i]->sys,format,max,eqie,indx);
+        if (MP_realised)
+            /* L_RAT_writeline() writes to fp directly */
+            ob_flush(ofp);
+        (* writeline)(ofp,rowl,porta_list[i]->sys,format,max,eqie,indx);
         if (option & Statistic_of_coefficients) 
-            writestatline(fp,(int *)porta_list[i]->ptr);
-        fprintf(fp,"\n");
+            writestatline(ofp,(int *)porta_list[i]->ptr);
+        ob_need(1);
+        ob_buf[ob_len++] = '\n';
+        if (ob_len > OB_FLUSH)
+            ob_flush(ofp);
     } /* for i */
+    ob_flush(ofp);
+    ob_fp = 0;
 /*
     fprintf(fp,"\n");
 */
-    if (!MP_realised) RATallo(max,rowl,0);
+    if (max) RATallo(max,rowl,0);
 }
 
 
@@ -1287,16 +2703,24 @@ void writesys( FILE *fp, int frow, int lrow, int rowl, int format,
 
 
 
-void writestatline( FILE *fp, int *ptr )
+void writestatline( FILE *ofp, int *ptr )
 {
     int j;
     
-    fprintf(fp,"# -5..-1,1..5 :");
+    ob_str("# -5..-1,1..5 :");
     for (j = -5; j < 0; j++)
-        fprintf(fp, " %2d", *(ptr+j));
-    fprintf(fp,"   ");
+    {
+        ob_str(" ");
+        ob_int(*(ptr+j),2);
+    }
+    ob_str("   ");
     for (j = 1; j < 6; j++)
-        fprintf(fp, " %2d", *(ptr+j));
+    {
+        ob_str(" ");
+        ob_int(*(ptr+j),2);
+    }
+    if (ofp != ob_fp)
+        ob_flush(ofp);
     
 }
 
@@ -1308,10 +2732,11 @@ void writestatline( FILE *fp, int *ptr )
 
 
 
-void I_RAT_writeline( FILE *fp, int col, RAT *ptr, int format, 
+void I_RAT_writeline( FILE *ofp, int col, RAT *ptr, int format, 
                       RAT *max, char ie_eq, int *indx )
 {
-    int j,l, ind = 0;
+    int j, ind = 0;
+    char s[8];
     
 //	fprintf(prt, "\n  format = %i\n\n", format);
 
@@ -1331,49 +2756,50 @@ void I_RAT_writeline( FILE *fp, int col, RAT *ptr, int format,
             
             if  (((ptr+j)->num == 0 && j != col-1 )) 
             {
-                for (l = 0; l <= (max?( max[j].num+max[j].den.i+3):-1); l++) 
-                    fprintf(fp," ");
-                if (max && ind > 99)  fprintf(fp," ");
-                if (max && ind  > 9) fprintf(fp," ");
+                if (max)
+                    ob_spaces(max[j].num+max[j].den.i+4);
+                if (max && ind > 99)  ob_spaces(1);
+                if (max && ind  > 9) ob_spaces(1);
             }
             
             else if (j == col-1 ) 
             {   /* right hand side */
-                fprintf(fp," %c= ",ie_eq);
-                if ((ptr+j)->den.i == 1)
-                    fprintf( fp, "%*ld", 
-                             (int)(max ? max[j].num : 1),
-                             (ptr+j)->num );
-                else
-                    fprintf( fp,"%*ld/%*d   ", 
-                             (int)(max ? max[j].num : 1), (ptr+j)->num, 
-                             (int)(max ? max[j].den.i : 1), (ptr+j)->den.i );
+                sprintf(s," %c= ",ie_eq);
+                ob_str(s);
+                ob_int((ptr+j)->num,(int)(max ? max[j].num : 1));
+                if ((ptr+j)->den.i != 1)
+                {
+                    ob_str("/");
+                    ob_int((ptr+j)->den.i,(int)(max ? max[j].den.i : 1));
+                    ob_str("   ");
+                }
             } 
             
             else 
             {
                 
                 if ((ptr+j)->num < 0)
-                    fprintf(fp,"-");
+                    ob_str("-");
                 else if ((ptr+j)->num > 0)
-          fprintf(fp,"+");
+                    ob_str("+");
                 
                 if ((abs((ptr+j)->num) == 1) && ((ptr+j)->den.i == 1)) 
                 {
                     if (max)  
-                        for (l = 0; l < max[j].num+max[j].den.i+1; l++) 
-                            fprintf(fp," ");
+                        ob_spaces(max[j].num+max[j].den.i+1);
                 }
                 else if ((ptr+j)->den.i == 1)
-                    fprintf( fp, "%*d",
-                             (int)(max ? (max[j].num+max[j].den.i+1) : 1),
-                             abs((ptr+j)->num) );
+                    ob_int(abs((ptr+j)->num),
+                           (int)(max ? (max[j].num+max[j].den.i+1) : 1));
                 else
-                    fprintf( fp, "%*d/%*d",
-                             (int)(max ? max[j].num : 1), abs((ptr+j)->num),
-                             (int)(max ? max[j].den.i : 1), (ptr+j)->den.i);
+                {
+                    ob_int(abs((ptr+j)->num),(int)(max ? max[j].num : 1));
+                    ob_str("/");
+                    ob_int((ptr+j)->den.i,(int)(max ? max[j].den.i : 1));
+                }
                 
-                fprintf(fp,"x%i",(indx)?(indx[j]+1):j+1);
+                ob_str("x");
+                ob_int((indx)?(indx[j]+1):j+1,0);
             } /* else */
             
         } /* for j */
@@ -1384,28 +2810,30 @@ void I_RAT_writeline( FILE *fp, int col, RAT *ptr, int format,
 		// First we write the constant:
 		j = col-1;
         if (max && (ptr+j)->den.i == 1) 
-            for (l = 0; l < max[j].den.i+1; l++)
-                fprintf(fp," ");
+            ob_spaces(max[j].den.i+1);
         
-        fprintf( fp, "%*ld", (int)(max ? max[j].num : 1), (ptr+j)->num );
+        ob_int((ptr+j)->num,(int)(max ? max[j].num : 1));
         if ((ptr+j)->den.i != 1)
-            fprintf( fp, "/%*d", 
-                     (int)(max ? max[j].den.i : 1), (ptr+j)->den.i);
-        fprintf(fp," ");
+        {
+            ob_str("/");
+            ob_int((ptr+j)->den.i,(int)(max ? max[j].den.i : 1));
+        }
+        ob_str(" ");
 
 		// Now we write the inequality coefficients
         for (j = 0; j < col-1; j++)
         {
             
             if (max && (ptr+j)->den.i == 1) 
-                for (l = 0; l < max[j].den.i+1; l++)
-                    fprintf(fp," ");
+                ob_spaces(max[j].den.i+1);
             
-            fprintf( fp, "%*ld", (int)(max ? max[j].num : 1), -((ptr+j)->num) );
+            ob_int(-((ptr+j)->num),(int)(max ? max[j].num : 1));
             if ((ptr+j)->den.i != 1)
-                fprintf( fp, "/%*d", 
-                         (int)(max ? max[j].den.i : 1), (ptr+j)->den.i);
-            fprintf(fp," ");
+            {
+                ob_str("/");
+                ob_int((ptr+j)->den.i,(int)(max ? max[j].den.i : 1));
+            }
+            ob_str(" ");
         }
     }
     else /* matrix format */
@@ -1414,16 +2842,19 @@ void I_RAT_writeline( FILE *fp, int col, RAT *ptr, int format,
         {
             
             if (max && (ptr+j)->den.i == 1) 
-                for (l = 0; l < max[j].den.i+1; l++)
-                    fprintf(fp," ");
+                ob_spaces(max[j].den.i+1);
             
-            fprintf( fp, "%*ld", (int)(max ? max[j].num : 1), (ptr+j)->num );
+            ob_int((ptr+j)->num,(int)(max ? max[j].num : 1));
             if ((ptr+j)->den.i != 1)
-                fprintf( fp, "/%*d", 
-                         (int)(max ? max[j].den.i : 1), (ptr+j)->den.i);
-            fprintf(fp," ");
+            {
+                ob_str("/");
+                ob_int((ptr+j)->den.i,(int)(max ? max[j].den.i : 1));
+            }
+            ob_str(" ");
         }
     
+    if (ofp != ob_fp)
+        ob_flush(ofp);
     
 }
 
@@ -1434,7 +2865,7 @@ void I_RAT_writeline( FILE *fp, int col, RAT *ptr, int format,
 
 
 
-void writepoionie( FILE *fp, int fineq, int lineq, int points, int poi_ieq )
+void writepoionie( FILE *ofp, int fineq, int lineq, int npoints, int poi_ieq )
 { 
   int i,ie,j,k,out,kk,*sumie,max;
   char *colstr = "POINTS",*rowstr = "INEQS ",*h;
@@ -1446,73 +2877,73 @@ void writepoionie( FILE *fp, int fineq, int lineq, int points, int poi_ieq )
       rowstr = h;
   }
   
-  sumie = (int*) allo(CP NULL,0,U points*sizeof(int),0);
-  for (i = 0 ; i < points; i++) sumie[i] = 0;
+  sumie = (int*) allo(CP NULL,0,U npoints*sizeof(int),0);
+  for (i = 0 ; i < npoints; i++) sumie[i] = 0;
   
-  fprintf(fp,"\nstrong validity table : \n");
+  fprintf(ofp,"\nstrong validity table : \n");
   for (j = 0 ; j < 8; j++) {
   switch(j) 
   {
-  case 0 : fprintf(fp,"\\ %c      |",*colstr++);break;
-  case 1 : fprintf(fp," \\ %c     |",*colstr++); break;
-  case 2 : fprintf(fp,"%c \\ %c    |",*rowstr++,*colstr++);break;
-  case 3 : fprintf(fp," %c \\ %c   | ",*rowstr++,*colstr++);break;
-  case 4 : fprintf(fp,"  %c \\ %c  |",*rowstr++,*colstr++);break;
-  case 5 : fprintf(fp,"   %c \\ %c |",*rowstr++,*colstr++);break;
-  case 6 : fprintf(fp,"    %c \\  |",*rowstr++);break;
-  case 7 : fprintf(fp,"     %c \\ |",*rowstr++);break;
+  case 0 : fprintf(ofp,"\\ %c      |",*colstr++);break;
+  case 1 : fprintf(ofp," \\ %c     |",*colstr++); break;
+  case 2 : fprintf(ofp,"%c \\ %c    |",*rowstr++,*colstr++);break;
+  case 3 : fprintf(ofp," %c \\ %c   | ",*rowstr++,*colstr++);break;
+  case 4 : fprintf(ofp,"  %c \\ %c  |",*rowstr++,*colstr++);break;
+  case 5 : fprintf(ofp,"   %c \\ %c |",*rowstr++,*colstr++);break;
+  case 6 : fprintf(ofp,"    %c \\  |",*rowstr++);break;
+  case 7 : fprintf(ofp,"     %c \\ |",*rowstr++);break;
   }
   /*  fprintf(fp,"\n"); */
   
   if (j != 3) 
   {
-      for (i = 0; i < points+(points-1)/5+2;i++) fprintf(fp," ");
-      fprintf(fp,"|\n");
+      for (i = 0; i < npoints+(npoints-1)/5+2;i++) fprintf(ofp," ");
+      fprintf(ofp,"|\n");
   }
   else 
   {
-      for (i = 1; i <= points; i += 5)
-          fprintf(fp,"%-*d",(points/(i+5)) ? 6 : ((points%5) ? points%5+1: 6),i);
-      fprintf(fp,"| #\n");
+      for (i = 1; i <= npoints; i += 5)
+          fprintf(ofp,"%-*d",(npoints/(i+5)) ? 6 : ((npoints%5) ? npoints%5+1: 6),i);
+      fprintf(ofp,"| #\n");
   } 
 }
   
-  for (i = 0; i < points+(points-1)/5+16;i++) fprintf(fp,"-");
-  fprintf(fp,"\n");
+  for (i = 0; i < npoints+(npoints-1)/5+16;i++) fprintf(ofp,"-");
+  fprintf(ofp,"\n");
   
   for (i = fineq, ie = 0; i < lineq; i++, ie++) 
   {
-      fprintf(fp,"%-9d| ",ie+1);
-      writemark( fp, porta_list[i]->mark, points, sumie );
+      fprintf(ofp,"%-9d| ",ie+1);
+      writemark( ofp, porta_list[i]->mark, npoints, sumie );
   }
   
-  fprintf(fp,"          ");
-  for (i = 0; i < points+(points-1)/5+6;i++) fprintf(fp,".");
-  fprintf(fp,"\n");
+  fprintf(ofp,"          ");
+  for (i = 0; i < npoints+(npoints-1)/5+6;i++) fprintf(ofp,".");
+  fprintf(ofp,"\n");
   max = 0;
-  for (i = 0; i < points; i++)
+  for (i = 0; i < npoints; i++)
       if (sumie[i] > max) max = sumie[i];
   for (j = 0; max > 0; max /= 10,j++) 
   {
-      (j == 0) ? fprintf(fp,"#        | ") : fprintf(fp,"         | ");
-      for (i = 0; i < points; i++) 
+      (j == 0) ? fprintf(ofp,"#        | ") : fprintf(ofp,"         | ");
+      for (i = 0; i < npoints; i++) 
       {
           if ((out = sumie[i]) > 0) 
           {
               for (k = 10000; sumie[i]/k == 0 && k>9; k /= 10);
               for (kk = 0; kk < j && k > 9;kk++, k /= 10)
                   out = out%k;
-              fprintf(fp,"%d",out/k);
+              fprintf(ofp,"%d",out/k);
               if (k == 1) sumie[i] = -1 ;
           }
-          else fprintf(fp," ");  
-          if ((i+1)%5 == 0) fprintf(fp," ");
+          else fprintf(ofp," ");  
+          if ((i+1)%5 == 0) fprintf(ofp," ");
       }
-      fprintf(fp,"\n");
+      fprintf(ofp,"\n");
   }
-  fprintf(fp,"\n");
+  fprintf(ofp,"\n");
   
-  free(sumie);
+  allo(CP sumie,U npoints*sizeof(int),0);
 }
 
 
@@ -1523,7 +2954,7 @@ void writepoionie( FILE *fp, int fineq, int lineq, int points, int poi_ieq )
 
 
 
-void writemark( FILE *fp, unsigned *ptr, int n, int *sumie )
+void writemark( FILE *ofp, unsigned *ptr, int n, int *sumie )
 {
     int b,i,sumpoi;
     unsigned m,out;
@@ -1536,18 +2967,18 @@ void writemark( FILE *fp, unsigned *ptr, int n, int *sumie )
         {
             out = m & 1;
             if (out)
-                fprintf(fp,"*");
+                fprintf(ofp,"*");
             else
-                fprintf(fp,".");
+                fprintf(ofp,".");
             if (out == 1) 
             {
                 sumpoi++;
                 if (sumie != 0)
                     *(sumie+b*32+i) += 1;
             }
-            if ((b*32+i+1) % 5 == 0 && (b*32+i+1) != n) fprintf(fp," ");
+            if ((b*32+i+1) % 5 == 0 && (b*32+i+1) != n) fprintf(ofp," ");
             m >>= 1;
         }
     }
-    fprintf(fp," :%3d\n",sumpoi);
+    fprintf(ofp," :%3d\n",sumpoi);
 }
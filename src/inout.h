@@ -39,10 +39,48 @@ REVISED BY ANDREAS LOEBEL
 #include "porta.h"
 
 
+/*
+ * Binary polytope files (.poib and .ieqb).
+ * The header is followed by
+ *   - the VALID point (dim entries),          if BIN_VALID is set in flags,
+ *   - the table of rows*cols entries,
+ *   - nmp multiple precision entries,
+ *   - rows*markw words of incidence marks,    if markw > 0,
+ *   - the lines ELIMINATION_ORDER, LOWER_BOUNDS, UPPER_BOUNDS (dim ints each),
+ *                                             if BIN_ELIM, BIN_LOW, BIN_UPP is set.
+ * A row of a .poib file holds the dim coordinates and 1 for a conv-point, 
+ * 0 for a cone-point; a row of a .ieqb file holds the dim coefficients, 
+ * the right hand side, and 1 for an inequality (<=), 0 for an equation.
+ * An entry whose numerator or denominator exceeds the integer range has 
+ * denominator 0 in the table and is stored as a multiple precision entry:
+ * row, column, +-numlen, denlen, followed by numlen+denlen 32-bit words,
+ * lowest first.
+ */
+#define BIN_MAGIC "PORTAB\0\1"
+#define BIN_ORDER 0x01020304
+#define BIN_POI 0
+#define BIN_IEQ 1
+#define BIN_VALID 1
+#define BIN_ELIM 2
+#define BIN_LOW 4
+#define BIN_UPP 8
+/* struct bin_head and struct bin_ent are defined in porta.h */
+
+struct bin_view {
+  struct bin_head *head;
+  struct bin_ent *valid, *sys;
+  int *mp, *list[3];
+  unsigned *mark;
+  };
+
+
+extern void free_io_buffers( void );
 extern int scan_line2( int, char [], char *, char [] );
+extern char *map_input_file( char *, size_t * );
+extern void unmap_input_file( void );
 extern int read_input_file( char *, FILE *, int *, RAT **, int *, char *, int **, char *,
                             int **, char *, RAT ** );
-extern void read_eqie( RAT **, int, int *, int *, int *, int *, char *, char [], char * );
+extern void read_eqie( RAT **, int, int *, int *, int *, int *, char * );
 extern void write_ieq_file( char *, FILE *, int, int, int, int *, 
                             int, int, int, int * );
 extern void write_poi_file( char *, FILE *, int, int, int, int, int, int, int );
@@ -51,7 +89,16 @@ extern void writesys( FILE *, int, int, int, int, int *, char, int * );
 extern void writemark( FILE *, unsigned *, int, int * );
 extern void writestatline( FILE *, int * );
 extern FILE *wfopen( char * );
+extern void wfclose( FILE * );
+extern void out_name( char *, char *, char * );
 extern void I_RAT_writeline( FILE *, int, RAT *, int, RAT *, char, int * );
+extern int file_zip( char * );
+extern int file_ext( char *, char * );
+extern void bin_open( char *, struct bin_view * );
+extern void bin_close( );
+extern void bin_begin( FILE *, int, int, int, RAT *, int **, int );
+extern void bin_row( FILE *, RAT *, int, int *, int, unsigned * );
+extern void bin_end( FILE * );
 
 
 #endif // _INOUT_H
@@ -34,6 +34,8 @@ REVISED BY ANDREAS LOEBEL
 
 #include "largecalc.h"
 #include "common.h"
+#include "arith.h"
+#include "porta_ctx.h"
 
 
 
@@ -411,36 +413,141 @@ int lorder( unsigned *x, unsigned *y, int xlen, int ylen )
 
 
 
+/*
+ * Helpers for lgcd().
+ * Values of at most LWORD_LEN digits fit into an unsigned long long,
+ * in Lehmer's algorithm the leading LEHMER_BITS bits are used.
+ */
+#define LWORD_LEN   5
+#define LEHMER_BITS 48
+
+static unsigned long long ltoull( loint *a )
+{
+    unsigned long long x = 0;
+    int i;
+    
+    for (i = a->len-1; i >= 0; i--)
+        x = (x << bits) | a->val[i];
+    return(x);
+}
+
+static void ulltol( unsigned long long x, loint *a )
+{
+    a->len = a->neg = 0;
+    for (; x; x >>= bits)
+        a->val[a->len++] = x & mask;
+}
+
+static int lbitlen( loint *a )
+{
+    return(a->len ? (a->len-1)*bits + 32 - __builtin_clz(a->val[a->len-1]) : 0);
+}
+
+static long long ltop( loint *a, int s )
+/* floor(a / 2^s), assumed to be below 2^60 */
+{
+    unsigned long long x = 0;
+    int i;
+    
+    for (i = a->len-1; i >= s/bits; i--)
+        x = (x << bits) | a->val[i];
+    return((long long) (x >> (s%bits)));
+}
+
+static void lcomb( loint *a, loint *b, long long A, long long Bc, long long C, long long D )
+/* (a,b) = (A*a+Bc*b, C*a+D*b), both results are known to be nonnegative */
+{
+    loint x,y;
+    long long s,t,cs,ct;
+    int i;
+    
+    cs = ct = 0;
+    for (i = 0; i < a->len; i++)
+    {
+        s = cs + A*a->val[i];
+        t = ct + C*a->val[i];
+        if (i < b->len)
+        {
+            s += Bc*b->val[i];
+            t += D*b->val[i];
+        }
+        x.val[i] = s & mask;
+        y.val[i] = t & mask;
+        cs = s >> bits;
+        ct = t >> bits;
+    }
+    for (x.len = a->len; x.len && !x.val[x.len-1]; x.len--);
+    for (y.len = a->len; y.len && !y.val[y.len-1]; y.len--);
+    x.neg = y.neg = 0;
+    *a = x;
+    *b = y;
+}
+
+
+
+
+
+
+
 void lgcd( loint a, loint b, loint *c )
+/*
+ * Lehmer's gcd: as long as the numbers are long, the quotients 
+ * of the euclidean algorithm are computed from the leading bits only, 
+ * and a whole sequence of them is applied in a single step.
+ * Numbers fitting into a machine word are done by binary_gcd().
+ */
 { 
     
-    loint r;
+    loint r,q;
+    long long ah,bh,A,Bc,C,D,qq,t;
+    int s;
+
     if (a.len == 0) 
     {
         *c = b;
         return;
     }
     
-  if (lord(a,b) == -1) 
-  {
-      r = a;
-      a = b;
-      b = r;
-  }
-    
-    porta_ldiv(a,b,&a,&r);
-    while (r.len > 0) 
+    a.neg = b.neg = 0;
+    if (lord(a,b) == -1) 
     {
+        r = a;
         a = b;
         b = r;
-        porta_ldiv(a,b,&a,&r);
     }
-    *c = b;
+    
+    while (b.len > 0) 
+    {
+        if (a.len <= LWORD_LEN)
+        {
+            ulltol(binary_gcd(ltoull(&a),ltoull(&b)),c);
+            return;
+        }
+        
+        s = lbitlen(&a) - LEHMER_BITS;
+        ah = ltop(&a,s);
+        bh = ltop(&b,s);
+        A = D = 1;
+        Bc = C = 0;
+        while (bh + C > 0 && bh + D > 0)
+        {
+            qq = (ah + A) / (bh + C);
+            if (qq != (ah + Bc) / (bh + D))
+                break;
+            t = A - qq*C;  A = C;   C = t;
+            t = Bc - qq*D; Bc = D;  D = t;
+            t = ah - qq*bh; ah = bh; bh = t;
+        }
+        
+        if (Bc == 0)
+        {
+            /* no quotient known, do an ordinary division step */
+            porta_ldiv(a,b,&q,&r);
+            a = b;
+            b = r;
+        }
+        else
+            lcomb(&a,&b,A,Bc,C,D);
+    }
+    *c = a;
 }
-
-
-
-
-
-
-
@@ -31,10 +31,18 @@ from the porta.c, porta.h and xporta.c source files.
  * now the library could be using more memory than really needed... */
 
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <vector>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
 #include "libporta.h"
 #include "time.h"
+#include "omp.h"
 extern "C" {
 #include "porta.h"
 #include "arith.h"
@@ -44,136 +52,492 @@ extern "C" {
 #include "mp.h"
 #include "four_mot.h"
 #include "portsort.h"
+#include "cache.h"
+#include "porta_ctx.h"
 }
 
 using namespace std;
 
 
-/* Here are some internal variables */
-FILE *logfile;
-bool libportaInitialized(false);
+// The greatest common divisor, of long ints by porta's own function
+template <class T> static T gcd(T u, T v)
+{
+	if (u < 0) u = -u;
+	if (v < 0) v = -v;
+	while (v != 0)
+	{
+		T r(u % v);
+		u = v;
+		v = r;
+	}
+	return u;
+}
+
+static long int gcd(long int u, long int v) {return longgcd(u, v);}
 
 
 // Comparison between two fractions is done without trying to simplify the fraction here.
-bool fraction::operator==(const fraction& f) const {return ((num == f.num) && (den == f.den));};
+template <class Num, class Den> bool basic_fraction<Num, Den>::operator==(const basic_fraction& f) const {return ((num == f.num) && (den == f.den));};
 
 // Basic fraction arithmetic
-fraction fraction::operator+ (const fraction& f) const
+template <class Num, class Den> basic_fraction<Num, Den> basic_fraction<Num, Den>::operator+ (const basic_fraction& f) const
 {
-	fraction f2;
+	basic_fraction f2;
 	f2.num = num*f.den + den*f.num;
 	f2.den = den*f.den;
 	f2.simplify();
 	return f2;
 };
 
-fraction fraction::operator* (const fraction& f) const
+template <class Num, class Den> basic_fraction<Num, Den> basic_fraction<Num, Den>::operator* (const basic_fraction& f) const
 {
-	fraction f2;
+	basic_fraction f2;
 	f2.num = num*f.num;
 	f2.den = den*f.den;
 	f2.simplify();
 	return f2;
 };
 
-void fraction::simplify()
+template <class Num, class Den> void basic_fraction<Num, Den>::simplify()
+{
+	Num g(gcd((Num) num, (Num) den));
+	num = num/g;
+	den = den/g;
+};
+
+
+// Functions from the ratmatrix class :
+
+template <class Num, class Den> void basic_ratmatrix<Num, Den>::resize(const long int& rows, const long int& cols)
+{
+	nbRows = rows;
+	nbCols = cols;
+	num.assign(rows*cols, 0);
+	den.assign(rows*cols, 0);
+};
+
+template <class Num, class Den> void basic_ratmatrix<Num, Den>::assign(const Num *data_num, const den_type *data_den, const long int& rows, const long int& cols)
+{
+	nbRows = rows;
+	nbCols = cols;
+	num.assign(data_num, data_num+rows*cols);
+	den.assign(rows*cols, data_den);
+};
+
+template <class Num, class Den> void basic_ratmatrix<Num, Den>::push_back(const basic_const_ratrow<Num, Den>& row)
+{
+	num.insert(num.end(), row.num, row.num+nbCols);
+	den.append(row.den, nbCols);
+	nbRows++;
+};
+
+template <class Num, class Den> bool basic_ratmatrix<Num, Den>::operator==(const basic_ratmatrix& m) const
+{
+	return ((nbRows == m.nbRows) && (nbCols == m.nbCols) && (num == m.num) && (den == m.den));
+};
+
+void den_array<void>::assign(long int n, const int *d)
+{
+	for (long int i(0); d && i < n; i++)
+		if (d[i] != 1)
+			msg((char *)"%sintegral coefficients expected (denominator other than 1)", (char *)"", 0);
+}
+
+
+/* The hand-off to porta, whose RAT hold a long numerator and an int 
+ * denominator, or in its multiple precision mode (see mp.c) a number of 
+ * 12-bit digits. Wide number types, which go beyond Tnum or Tden, have 
+ * porta compute in multiple precision. */
+template <class Num, class Den> static bool wide_type()
+{
+	return (porta_number<Num>::max() > LONG_MAX || porta_number<typename den_traits<Den>::type>::max() > INT_MAX);
+}
+
+
+/* The coefficients beyond porta's integer range, which are put into its
+ * tables once porta computes in multiple precision : "at" are their places
+ * in the table, left 0 so far. */
+template <class Num, class Den> struct big_entries {
+	vector < long int > at;
+	vector < basic_fraction<Num, Den> > val;
+};
+
+
+/* Puts "sign" times the fraction f into the RAT r. The fractions beyond 
+ * porta's integer range are noted in "big" (at the place "at"), if there 
+ * is a big, and are an error otherwise. */
+template <class Num, class Den> static void to_rat(RAT& r, const basic_fraction<Num, Den>& f, int sign = 1, 
+												   big_entries<Num, Den> *big = 0, long int at = 0)
+{
+	if (f.num > LONG_MAX || f.num < LONG_MIN || f.den > INT_MAX)
+	{
+		if (!big)
+			msg((char *)"%scoefficients beyond the integer range can not be passed to porta", (char *)"", 0);
+		else
+		{
+			basic_fraction<Num, Den> g(sign*f.num, f.den);
+			g.simplify();
+			big->at.push_back(at);
+			big->val.push_back(g);
+		}
+		r.num = 0;
+		r.den.i = 1;
+		return;
+	}
+	r.num = sign*(long int) f.num;
+	r.den.i = (int) f.den;
+}
+
+
+/* A multiple precision RAT from a fraction */
+template <class T> static void to_loint(T x, loint& l)
+{
+	l.neg = (x < 0);
+	for (l.len = 0; x != 0; l.len++)
+	{
+		if (l.len == MAX_LEN_LINT)
+			msg((char *)"%sArithmetic overflow !", (char *)"", 0);
+		T r(x % 4096);
+		l.val[l.len] = (unsigned) (r < 0 ? -r : r);
+		x = x/4096;
+	}
+}
+
+template <class Num, class Den> static void to_L_RAT(RAT *r, const basic_fraction<Num, Den>& f)
+{
+	lorat l;
+	
+	to_loint(f.num, l.num);
+	to_loint(f.den, l.den);
+	lorat_to_L_RAT(l, r);
+}
+
+
+/* Puts the entries noted in "big" into the table t of porta, which computes
+ * in multiple precision now */
+template <class Num, class Den> static void put_big(RAT *t, const big_entries<Num, Den>& big)
+{
+	for (size_t k(0); k < big.at.size(); k++)
+		to_L_RAT(t+big.at[k], big.val[k]);
+}
+
+
+/* The value of a multiple precision number, 0 if it goes beyond T */
+template <class T> static bool from_loint(const loint& l, T& x)
+{
+	x = 0;
+	for (int i(l.len-1); i >= 0; i--)
+	{
+		if (x > (porta_number<T>::max()-(T) l.val[i])/4096)
+			return false;
+		x = 4096*x+(T) l.val[i];
+	}
+	if (l.neg)
+		x = -x;
+	return true;
+}
+
+
+/* Sets row[j] (an integral row takes no fraction) */
+template <class Num, class Den> static void set_entry(const basic_ratrow<Num, Den>& row, long int j, 
+													  const Num& n, const typename den_traits<Den>::type& d)
+{
+	row.num[j] = n;
+	row.den[j] = d;
+}
+
+template <class Num> static void set_entry(const basic_ratrow<Num, void>& row, long int j, const Num& n, const int& d)
+{
+	if (d != 1)
+		msg((char *)"%sa fraction can not be stored with integral coefficients", (char *)"", 0);
+	row.num[j] = n;
+}
+
+
+/* Sets row[j] to "sign" times the RAT r of porta, in integer or in 
+ * multiple precision */
+template <class Num, class Den> static void from_rat(const basic_ratrow<Num, Den>& row, long int j, const RAT& r, int sign = 1)
 {
-	long int gcd(longgcd(num, den));
-	num = num/gcd;
-	den = den/gcd;
+	typedef typename den_traits<Den>::type den_type;
+	
+	if (!MP_realised || r.num == 0)
+	{
+		set_entry(row, j, (Num) (sign*r.num), (den_type) (r.num ? r.den.i : 1));
+		return;
+	}
+	
+	lorat l;
+	Num n(0);
+	den_type d(1);
+	
+	L_RAT_to_lorat(r, &l);
+	if (!from_loint(l.num, n) || !from_loint(l.den, d))
+		msg((char *)"%scoefficients beyond the range of the number type of the representation", (char *)"", 0);
+	set_entry(row, j, (Num) (sign*n), d);
+}
+
+
+/* The constraints porta hands back are read as fractions, also for an
+ * integral representation, which takes each constraint multiplied by the
+ * lcm of its denominators (multiple precision leaves them fractional). */
+template <class Num, class Den> struct constraint_matrix {
+	typedef basic_ratmatrix<Num, Den> type;
+	typedef basic_ratrow<Num, Den> row;
+};
+
+template <class Num> struct constraint_matrix<Num, void> {
+	typedef basic_ratmatrix<Num, Num> type;
+	typedef basic_ratrow<Num, Num> row;
 };
 
+template <class Num, class Den> static void take_constraints(basic_ratmatrix<Num, Den>& m, const basic_ratmatrix<Num, Den>& c)
+{
+	m = c;
+}
+
+template <class Num> static void take_constraints(basic_ratmatrix<Num, void>& m, const basic_ratmatrix<Num, Num>& c)
+{
+	m.resize(c.rows(), c.cols());
+	for (long int i(0); i < c.rows(); i++)
+	{
+		basic_const_ratrow<Num, Num> r(c[i]);
+		Num l(1);
+
+		for (long int j(0); j < c.cols(); j++)
+		{
+			Num f(r.den[j]/gcd(l, r.den[j]));
+			if (l > porta_number<Num>::max()/f)
+				msg((char *)"%sa constraint can not be stored with integral coefficients", (char *)"", 0);
+			l = l*f;
+		}
+		for (long int j(0); j < c.cols(); j++)
+		{
+			Num f(l/r.den[j]);
+			if (r.num[j] > porta_number<Num>::max()/f || r.num[j] < -(porta_number<Num>::max()/f))
+				msg((char *)"%sa constraint can not be stored with integral coefficients", (char *)"", 0);
+			m[i].num[j] = r.num[j]*f;
+		}
+	}
+}
+
+
+// The display of the numbers (streams do not know 128-bit integers)
+template <class T> static void put_number(ostream& os, const T& x)
+{
+	os << x;
+}
+
+#ifdef __SIZEOF_INT128__
+static void put_number(ostream& os, __int128 x)
+{
+	char buf[48], *p(buf+sizeof(buf));
+	bool neg(x < 0);
+	
+	*--p = 0;
+	do {
+		int r((int) (x % 10));
+		*--p = '0'+(r < 0 ? -r : r);
+		x /= 10;
+	} while (x != 0);
+	if (neg)
+		*--p = '-';
+	os << p;
+}
+#endif
+
+
+/* The conversions of a batch (see the vector versions of VtoHrep() and
+ * HtoVrep() below) share the log file and a protocol stream. in_batch is
+ * set on the threads working for a batch. */
+static FILE *batch_log = 0, *batch_prt = 0;
+static bool in_batch(false);
+#pragma omp threadprivate(in_batch)
+
+// Stops the conversion of a batch at an error of porta (see msg())
+static void batch_error(char *text)
+{
+	throw runtime_error(text);
+}
+
+
+/* The result cache (see cache.c), off as long as cacheBudget is 0. The
+ * results go through the cache as binary files of the library. */
+static string cacheDirectory(CACHE_DIR);
+static long int cacheBudget(0);
+
+void setResultCache(const string& directory, const long int& megabytes)
+{
+	cacheDirectory = directory;
+	cacheBudget = megabytes*1048576L;
+}
+
+// The key of the "rows" rows of ar1 and the valid point ar6, 0 if they are not cached
+static long *result_key(long int rows, int ieq, long int *keylen)
+{
+	if (cacheBudget <= 0)
+		return 0;
+	return cache_key(ar1, rows, dim, ieq, ar6, CACHE_LIBPORTA, keylen);
+}
+
+// Fills rep from the cache, false if the result is not there
+template <class Rep> static bool fetch_result(Rep& rep, long *key, long int keylen, const char *ext)
+{
+	char *dir(const_cast<char *>(cacheDirectory.c_str()));
+	char name[FILENAME_MAX];
+	
+	if (!key)
+		return false;
+	cache_name(name, dir, key, keylen, const_cast<char *>(ext));
+	if (!cache_fetch(dir, key, keylen, name))
+		return false;
+	rep.fill(string(name));
+	remove(name);
+	return true;
+}
+
+// Stores rep in the cache, unless it was computed in multiple precision
+template <class Rep> static void store_result(const Rep& rep, long *key, long int keylen, const char *ext)
+{
+	char *dir(const_cast<char *>(cacheDirectory.c_str()));
+	char name[FILENAME_MAX];
+	
+	if (!key || MP_realised)
+		return;
+	cache_name(name, dir, key, keylen, const_cast<char *>(ext));
+	rep.write(string(name));
+	cache_store(dir, cacheBudget, key, keylen, name);
+	remove(name);
+}
+
+
+static void print_banner()
+{
+    printf("\nPORTA - a POlyhedron Representation Transformation Algorithm\n");
+    printf(  "Version %s\n\n", VERSION );
+
+    printf( "Written by Thomas Christof (Uni Heidelberg)\n" );
+    printf( "Revised by Andreas Loebel (ZIB Berlin)\n\n" );
+
+    printf( "PORTA is free software and comes with ABSOLUTELY NO WARRENTY! You are welcome\n" );
+    printf( "to use, modify, and redistribute it under the GNU General Public Lincese.\n\n" ); 
+    
+    printf( "This is the program XPORTA from the PORTA package.\n\n" );
+}
 
-/* This function initializes the internal variable of porta  and opens
- * the log file. */
+
+/* This function gives the calling thread a fresh porta context and opens
+ * the log file. Every thread calling the library works in its own context,
+ * so VtoHrep() and HtoVrep() may run concurrently in different threads. */
 void init_libporta()
 {
-	if (libportaInitialized) fclose( logfile );
+	use_porta_context(new_porta_context());
 	
-	logfile = fopen( "porta.log", "a" );
-    if( !logfile )
-        fprintf( stderr, "can't open logfile porta.log\n" );
-    else
-    {
-        porta_log("\n\n\nlog for libporta function VtoHrep\n\n");
-    }
+	if (in_batch)
+	{
+		// the log of a batch is written by the batch itself
+		logfile = 0;
+		prt = batch_prt;
+		on_error = batch_error;
+	}
+	else
+	{
+		logfile = fopen( "porta.log", "a" );
+	    if( !logfile )
+	        fprintf( stderr, "can't open logfile porta.log\n" );
+	    else
+	    {
+	        porta_log("\n\n\nlog for libporta function VtoHrep\n\n");
+	    }
+	    prt = stdout;
+	    setbuf(prt,CP 0);
+	}
 
     init_total_time();
     
     initialize();
 
-    prt = stdout;
-    setbuf(prt,CP 0);
-    
     set_I_functions();
 
     SET_MP_not_ready;
 
-	// We also initialize some variables for porta.c
-	mp_state = 0;
-	nel_ar1 = 0;
-	nel_ar2 = 0;
-	nel_ar3 = 0;
-	nel_ar4 = 0;
-	nel_ar5 = 0;
-	nel_ar6 = 0;
-	maxlist = 0;
-	total_size = 0;
-	dim = 0;
-	equa = 0;
-	ineq = 0;
-	conv = 0;
-	cone = 0;
-	points = 0;
-	blocks = 0;
-	option = 0;
-	allowed_options = 0;
-
-	// common.c
-	comp = 0;
-	
-	// portsort.c
-	comp_ps = 0;
-	delay = 0;
-	same_vals = 0;
-	rowlen = 0;
-	
-	// four_mot.c
-	blocks = 0;
-	itr = 0;
-	totalineq = 0;
-
-	libportaInitialized = true;
-	cout << "Interface with porta initialized.\n"<< endl;
-//	long int* junk( logfile);
-//	cout << logfile << " : " << (int *) logfile << endl << flush;
-
+	if (!in_batch) cout << "Interface with porta initialized.\n"<< endl;
 }
 
 
-/* This function closes the log file of porta */
+/* This function closes the log file of porta and frees the context of the
+ * calling thread, together with the arrays and lists still held by it */
 void close_libporta()
 {
-	if (libportaInitialized) fclose( logfile );
-	libportaInitialized = false;
-	
-	// We also free some pointers which might still not have been freed:
-	free(ar1); ar1 = 0;
-	free(ar2); ar2 = 0;
-	free(ar3); ar3 = 0;
-	free(ar4); ar4 = 0;
-	free(ar5); ar5 = 0;
-	free(ar6); ar6 = 0;
-	free(elim_in); elim_in = 0;
-//	free(porta_list);
-	porta_list = 0; // For now it seems not clear whether we can clear porta_list really (or whether some data were already lost... so we just lose the address to make sure we start with a new allocation.)
+	if (logfile) fclose( logfile );
+	logfile = 0;
+	free_porta_context(porta_cur); // porta_list, its elements and marks (the results have been copied by fill())
 	
-	cout << "Interface with porta closed.\n"<< endl;
+	if (!in_batch) cout << "Interface with porta closed.\n"<< endl;
+}
+
+
+/* Opens the log file and the protocol stream shared by the "n" conversions 
+ * of a batch. The protocols of the single conversions are discarded. */
+static void open_batch(const char *fct, long int n)
+{
+	batch_log = fopen( "porta.log", "a" );
+    if( !batch_log )
+        fprintf( stderr, "can't open logfile porta.log\n" );
+    else
+        fprintf( batch_log, "\n\n\nlog for libporta function %s, batch of %li polytopes\n\n", fct, n );
+#if defined WIN32
+	batch_prt = fopen( "NUL", "w" );
+#else
+	batch_prt = fopen( "/dev/null", "w" );
+#endif
+	if (!batch_prt)
+		batch_prt = stdout;
+
+	print_banner();
 }
 
 
+static void close_batch()
+{
+	if (batch_log) fclose( batch_log );
+	if (batch_prt != stdout) fclose( batch_prt );
+	batch_log = batch_prt = 0;
+}
+
 
-void VtoHrep(const Vrep& vrep, Hrep& hrep)
+/* Makes the conversion "convert" of "in" to "out" in a batch. At an error
+ * of porta, the context of the conversion is freed, "out" is emptied and
+ * the message of the error returned, else "". */
+template <class In, class Out> static string batch_conversion(void (*convert)(const In&, Out&), const In& in, Out& out)
+{
+	struct porta_context *outer(porta_cur);
+	
+	try
+	{
+		convert(in, out);
+	}
+	catch (const runtime_error& e)
+	{
+		while (porta_cur != outer)
+			free_porta_context(porta_cur);
+		out = Out();
+		return e.what();
+	}
+	return "";
+}
+
+
+/* The number of threads of a batch of "n" conversions */
+static int batch_threads(int nbThreads, long int n)
+{
+	if (nbThreads <= 0)
+		nbThreads = omp_get_max_threads();
+	return (n < nbThreads) ? (n > 0 ? (int) n : 1) : nbThreads;
+}
+
+
+
+template <class Num, class Den> void VtoHrep(const basic_Vrep<Num, Den>& vrep, basic_Hrep<Num, Den>& hrep)
 {
     int ieq_file, start;
     char outfname[20];
@@ -186,19 +550,11 @@ void VtoHrep(const Vrep& vrep, Hrep& hrep)
     FILE *outfp;
 
     int i,j; // Added by J-D B, used as summation indices later.
+	big_entries<Num, Den> big; // The coefficients beyond porta's integer range
 
     init_libporta();
 	
-    printf("\nPORTA - a POlyhedron Representation Transformation Algorithm\n");
-    printf(  "Version %s\n\n", VERSION );
-
-    printf( "Written by Thomas Christof (Uni Heidelberg)\n" );
-    printf( "Revised by Andreas Loebel (ZIB Berlin)\n\n" );
-
-    printf( "PORTA is free software and comes with ABSOLUTELY NO WARRENTY! You are welcome\n" );
-    printf( "to use, modify, and redistribute it under the GNU General Public Lincese.\n\n" ); 
-    
-    printf( "This is the program XPORTA from the PORTA package.\n\n" );
+    if (!in_batch) print_banner();
 
     /*Here we will do a traf, so we manually set the option "-T" :*/
 	option |= Traf;
@@ -206,6 +562,8 @@ void VtoHrep(const Vrep& vrep, Hrep& hrep)
 		Chernikov_rule_off|Validity_table_out|
 		Redundance_check|Statistic_of_coefficients|
 		Protocol_to_file|Opt_elim|Long_arithmetic;
+	if (wide_type<Num, Den>())
+		option |= Long_arithmetic;
     
 //    ieq_file = 0; /*!strcmp(*argv+strlen(*argv)-4,".ieq");*/
 //    poi_file = 1; /*!strcmp(*argv+strlen(*argv)-4,".poi");*/
@@ -219,24 +577,28 @@ void VtoHrep(const Vrep& vrep, Hrep& hrep)
 	ar1 = (RAT *) RATallo(ar1, 0, (points+1)*(dim+1)); // Note that for some reason porta seems to allocate memory for one more extremal point... so we also do that here.
 	for (i = 0; i < points; i++)
 	{
-		for (j = 0; j < dim+1; j++)
-		{
-			if (j != dim) /* We put the constant term at the end of the column. */
-			{
-				ar1[i*(dim+1)+j].num = vrep.pointsAndRays[i][j+1].num;
-				ar1[i*(dim+1)+j].den.i = vrep.pointsAndRays[i][j+1].den;
-			}
-			else
-			{
-				ar1[i*(dim+1)+j].num = vrep.pointsAndRays[i][0].num;
-				ar1[i*(dim+1)+j].den.i = vrep.pointsAndRays[i][0].den;
-			}
-		}
+		basic_const_ratrow<Num, Den> row(vrep.pointsAndRays[i]);
+		RAT *r = ar1+i*(dim+1);
+		
+		for (j = 0; j < dim; j++)
+			to_rat(r[j], row[j+1], 1, &big, i*(dim+1)+j);
+		/* We put the constant term at the end of the column. */
+		to_rat(r[dim], row[0]);
 	}
 	/* We also prepare the valid point */
 	ar6 = (RAT *) RATallo(ar6, 0, (points+1)*dim);
 	for (j = 0; j < dim; j++)
 		ar6[j] = ar1[j];
+	
+	// A polytope converted before is taken from the result cache
+	long int keylen(0);
+	long *key(big.at.empty() ? result_key(points, 0, &keylen) : 0);
+	if (fetch_result(hrep, key, keylen, ".ieqb"))
+	{
+		cache_free(key, keylen);
+		close_libporta();
+		return;
+	}
 
 	gentableau(ar1,1,&rowl_inar,&indx);
 	indx0 = indx; // We copy the initial address of indx to later be able to free the memory...
@@ -247,6 +609,16 @@ void VtoHrep(const Vrep& vrep, Hrep& hrep)
 		memset( &a, 0, sizeof(a) );
 		memset( &b, 0, sizeof(b) );
 		arith_overflow_func(0,0,a,b,0);
+		
+		// The big coefficients of the points, in ar1 and (transposed) in ar2
+		put_big(ar1, big);
+		for (size_t k(0); k < big.at.size(); k++)
+		{
+			long int pt(big.at[k]/(dim+1)), col(big.at[k]%(dim+1));
+			to_L_RAT(ar2+col*(dim+points+1)+pt, big.val[k]);
+			if (pt == 0)
+				to_L_RAT(ar6+col, big.val[k]);
+		}
 	}
 	ineq = (cone == points) ? dim : dim + 1;
 	ineq_out = ineq;  /*not used further */
@@ -276,6 +648,8 @@ void VtoHrep(const Vrep& vrep, Hrep& hrep)
 
 	// We feed the output into the hrep variable.
 	hrep.fill(porta_list, dim, equa, ineq, indx);
+	store_result(hrep, key, keylen, ".ieqb");
+	cache_free(key, keylen);
 	
 	// We free the memory:
 	free(indx0); indx0 = 0;
@@ -301,7 +675,7 @@ void VtoHrep(const Vrep& vrep, Hrep& hrep)
 //	cout << "OK1" << endl << flush;
 }
 
-void HtoVrep(const Hrep& hrep, Vrep& vrep)
+template <class Num, class Den> void HtoVrep(const basic_Hrep<Num, Den>& hrep, basic_Vrep<Num, Den>& vrep)
 {
     int ieq_file, start;
     char outfname[20];
@@ -315,19 +689,11 @@ void HtoVrep(const Hrep& hrep, Vrep& vrep)
 
 	long int nbEqs, nbIneqs;
     int i,j; // Added by J-D B, used as summation indices later.
+	big_entries<Num, Den> big, bigValid; // The coefficients beyond porta's integer range
 
     init_libporta();
 	
-    printf("\nPORTA - a POlyhedron Representation Transformation Algorithm\n");
-    printf(  "Version %s\n\n", VERSION );
-
-    printf( "Written by Thomas Christof (Uni Heidelberg)\n" );
-    printf( "Revised by Andreas Loebel (ZIB Berlin)\n\n" );
-
-    printf( "PORTA is free software and comes with ABSOLUTELY NO WARRENTY! You are welcome\n" );
-    printf( "to use, modify, and redistribute it under the GNU General Public Lincese.\n\n" ); 
-    
-    printf( "This is the program XPORTA from the PORTA package.\n\n" );
+    if (!in_batch) print_banner();
 
     /*Here we will do a traf, so we manually set the option "-T" :*/
 	option |= Traf;
@@ -335,6 +701,8 @@ void HtoVrep(const Hrep& hrep, Vrep& vrep)
 		Chernikov_rule_off|Validity_table_out|
 		Redundance_check|Statistic_of_coefficients|
 		Protocol_to_file|Opt_elim|Long_arithmetic;
+	if (wide_type<Num, Den>())
+		option |= Long_arithmetic;
     
 //    ieq_file = 0; /*!strcmp(*argv+strlen(*argv)-4,".ieq");*/
 //    poi_file = 1; /*!strcmp(*argv+strlen(*argv)-4,".poi");*/
@@ -433,8 +801,7 @@ void HtoVrep(const Hrep& hrep, Vrep& vrep)
 	ar6 = (RAT *) RATallo(ar6,0,dim);
 	for (i = 0; i < dim; i++)
 	{
-		ar6[i].num = hrep.validPoint[i].num;
-		ar6[i].den.i = hrep.validPoint[i].den;
+		to_rat(ar6[i], hrep.validPoint[i], 1, &bigValid, i);
 //		ar6[i].num = 0; // To take the origin as a valid point
 //		ar6[i].den.i = 1;
 	}
@@ -445,28 +812,26 @@ void HtoVrep(const Hrep& hrep, Vrep& vrep)
 	ar1 = (RAT *) RATallo(ar1, 0, (nbEqs+nbIneqs+1)*(dim+2));
 	for (i = 0; i < nbEqs; i++)
 	{
+		basic_const_ratrow<Num, Den> row(hrep.equalities[i]);
+		RAT *r = ar1+i*(dim+2);
+		
 		for (j = 0; j < dim; j++)
-		{
-			ar1[i*(dim+2)+j].num = hrep.equalities[i][j+1].num;
-			ar1[i*(dim+2)+j].den.i = hrep.equalities[i][j+1].den;
-		}
-		ar1[i*(dim+2)+dim].num = -hrep.equalities[i][0].num;
-		ar1[i*(dim+2)+dim].den.i = hrep.equalities[i][0].den;
-		ar1[i*(dim+2)+dim+1].num = 0;
-		ar1[i*(dim+2)+dim+1].den.i = 0;
+			to_rat(r[j], row[j+1], 1, &big, i*(dim+2)+j);
+		to_rat(r[dim], row[0], -1, &big, i*(dim+2)+dim);
+		r[dim+1].num = 0;
+		r[dim+1].den.i = 0;
 	}
 	// Now the inequalities
 	for (i = 0; i < nbIneqs; i++)
 	{
+		basic_const_ratrow<Num, Den> row(hrep.inequalities[i]);
+		RAT *r = ar1+(nbEqs+i)*(dim+2);
+		
 		for (j = 0; j < dim; j++)
-		{
-			ar1[nbEqs*(dim+2)+i*(dim+2)+j].num = -hrep.inequalities[i][j+1].num;
-			ar1[nbEqs*(dim+2)+i*(dim+2)+j].den.i = hrep.inequalities[i][j+1].den;
-		}
-		ar1[nbEqs*(dim+2)+i*(dim+2)+dim].num = hrep.inequalities[i][0].num;
-		ar1[nbEqs*(dim+2)+i*(dim+2)+dim].den.i = hrep.inequalities[i][0].den;
-		ar1[nbEqs*(dim+2)+i*(dim+2)+dim+1].num = 1;
-		ar1[nbEqs*(dim+2)+i*(dim+2)+dim+1].den.i = 1;
+			to_rat(r[j], row[j+1], -1, &big, (nbEqs+i)*(dim+2)+j);
+		to_rat(r[dim], row[0], 1, &big, (nbEqs+i)*(dim+2)+dim);
+		r[dim+1].num = 1;
+		r[dim+1].den.i = 1;
 	}
 	
 	
@@ -499,14 +864,25 @@ void HtoVrep(const Hrep& hrep, Vrep& vrep)
 
 
 	
+	// A polytope converted before is taken from the result cache
+	long int keylen(0);
+	long *key(big.at.empty() && bigValid.at.empty() ? result_key(nbEqs+nbIneqs, 1, &keylen) : 0);
+	if (fetch_result(vrep, key, keylen, ".poib"))
+	{
+		cache_free(key, keylen);
+		close_libporta();
+		return;
+	}
+	
 	// Ok, now comes porta's original code:
 	sort_eqie_cvce(ar1,points,dim+2,&equa_in,&ineq_in);
 	iep = ar1+equa_in*(dim+2);
 	/* first equations then inequalities */
 	points = ineq_in;
-	polarformat(iep,&equa_in,ineq_in,inner);
-	gentableau(iep,0,&rowl_inar,&indx);
-	indx0 = indx; // We copy the initial address of indx to later be able to free the memory...
+	
+	/* For the wide number types, porta computes in multiple precision from
+	 * here on, with the coefficients beyond its integer range (the equations 
+	 * came first already, so sort_eqie_cvce() has kept the rows in place). */
 	if(is_set(Long_arithmetic)) 
 	{
 		RAT a, b;
@@ -514,6 +890,30 @@ void HtoVrep(const Hrep& hrep, Vrep& vrep)
 		memset( &a, 0, sizeof(a) );
 		memset( &b, 0, sizeof(b) );
 		arith_overflow_func(0,0,a,b,0);
+		put_big(ar1, big);
+		put_big(ar6, bigValid);
+	}
+	
+	polarformat(iep,&equa_in,ineq_in,inner);
+	gentableau(iep,0,&rowl_inar,&indx);
+	indx0 = indx; // We copy the initial address of indx to later be able to free the memory...
+	if (MP_realised)
+	{
+		/* gentableau() copies the points into ar2 and appends the identity as
+		 * integer RAT : the copies get numbers of their own, the identity is
+		 * converted. */
+		for (i = 0; i <= dim; i++)
+		{
+			RAT *r(ar2+i*(dim+points+1));
+			for (j = 0; j < points; j++)
+				if (r[j].num)
+				{
+					RAT t(r[j]);
+					r[j].num = 0;
+					L_RAT_assign(r+j, &t);
+				}
+			RAT_to_L_RAT(r+points, dim+1);
+		}
 	}
 	ineq = (cone == points) ? dim : dim + 1;
 	ineq_out = ineq; /* not used further */
@@ -574,6 +974,8 @@ void HtoVrep(const Hrep& hrep, Vrep& vrep)
 
 	// We feed the output into the hrep variable.
 	vrep.fill(porta_list, dim, cone, conv);
+	store_result(vrep, key, keylen, ".poib");
+	cache_free(key, keylen);
 	
 	// We free the memory:
 	// We free the memory:
@@ -599,27 +1001,95 @@ void HtoVrep(const Hrep& hrep, Vrep& vrep)
 }
 
 
+/* Converts a batch of V-representations: hreps[i] becomes the
+ * H-representation of vreps[i]. The conversions are shared out dynamically
+ * among "nbThreads" threads (by default as many as OpenMP offers), each
+ * of them working in its own porta context. */
+template <class Num, class Den> vector<string> VtoHrep(const vector< basic_Vrep<Num, Den> >& vreps, vector< basic_Hrep<Num, Den> >& hreps, int nbThreads)
+{
+	long int i, n(vreps.size());
+	vector<string> errors(n);
+	void (*convert)(const basic_Vrep<Num, Den>&, basic_Hrep<Num, Den>&) = VtoHrep;
+
+	hreps.assign(n, basic_Hrep<Num, Den>());
+	open_batch("VtoHrep", n);
+	#pragma omp parallel num_threads(batch_threads(nbThreads, n))
+	{
+		in_batch = true;
+		#pragma omp for schedule(dynamic)
+		for (i = 0; i < n; i++)
+			errors[i] = batch_conversion(convert, vreps[i], hreps[i]);
+		in_batch = false;
+	}
+	if (batch_log)
+		for (i = 0; i < n; i++)
+		{
+			if (!errors[i].empty())
+				fprintf(batch_log, "%6li: failed: %s\n", i, errors[i].c_str());
+			else
+				fprintf(batch_log, "%6li: %6li points and rays -> %6li equalities, %6li inequalities\n", 
+					i, vreps[i].nbPointsAndRays(), hreps[i].nbEqualities(), hreps[i].nbInequalities());
+		}
+	close_batch();
+	return errors;
+}
+
+
+/* Converts a batch of H-representations, like the batch version of VtoHrep() */
+template <class Num, class Den> vector<string> HtoVrep(const vector< basic_Hrep<Num, Den> >& hreps, vector< basic_Vrep<Num, Den> >& vreps, int nbThreads)
+{
+	long int i, n(hreps.size());
+	vector<string> errors(n);
+	void (*convert)(const basic_Hrep<Num, Den>&, basic_Vrep<Num, Den>&) = HtoVrep;
+
+	vreps.assign(n, basic_Vrep<Num, Den>());
+	open_batch("HtoVrep", n);
+	#pragma omp parallel num_threads(batch_threads(nbThreads, n))
+	{
+		in_batch = true;
+		#pragma omp for schedule(dynamic)
+		for (i = 0; i < n; i++)
+			errors[i] = batch_conversion(convert, hreps[i], vreps[i]);
+		in_batch = false;
+	}
+	if (batch_log)
+		for (i = 0; i < n; i++)
+		{
+			if (!errors[i].empty())
+				fprintf(batch_log, "%6li: failed: %s\n", i, errors[i].c_str());
+			else
+				fprintf(batch_log, "%6li: %6li equalities, %6li inequalities -> %6li points and rays\n", 
+					i, hreps[i].nbEqualities(), hreps[i].nbInequalities(), vreps[i].nbPointsAndRays());
+		}
+	close_batch();
+	return errors;
+}
+
+
 // The == operator
-bool Vrep::operator==(const Vrep& vrep) const
+template <class Num, class Den> bool basic_Vrep<Num, Den>::operator==(const basic_Vrep& vrep) const
 {
 	return (pointsAndRays == vrep.pointsAndRays);
 };
 
-ostream& operator<<(ostream& os, const Vrep& vrep)
+template <class Num, class Den> ostream& operator<<(ostream& os, const basic_Vrep<Num, Den>& vrep)
 {
 	// Here we write the equalities and inequalities in the lrs format
 	os << "V-representation\n";
 	os << "begin\n";
-	os << vrep.pointsAndRays.size() << " " << vrep.pointsAndRays[0].size() << " rational\n";
-	for (long int i(0); i < vrep.pointsAndRays.size(); i++)
+	os << vrep.pointsAndRays.rows() << " " << vrep.pointsAndRays.cols() << " rational\n";
+	for (long int i(0); i < vrep.pointsAndRays.rows(); i++)
 	{
-		for (long int j(0); j < vrep.pointsAndRays[0].size(); j++)
+		basic_const_ratrow<Num, Den> row(vrep.pointsAndRays[i]);
+		for (long int j(0); j < row.size(); j++)
 		{
-			os << vrep.pointsAndRays[i][j].num;
-			if (vrep.pointsAndRays[i][j].den != 1)
-				os << "/" << vrep.pointsAndRays[i][j].den << " ";
-			else
-				os << " ";
+			put_number(os, row.num[j]);
+			if (row.den[j] != 1)
+			{
+				os << "/";
+				put_number(os, row.den[j]);
+			}
+			os << " ";
 		};
 		os << "\n";
 	};
@@ -629,45 +1099,51 @@ ostream& operator<<(ostream& os, const Vrep& vrep)
 }
 
 // The == operator
-bool Hrep::operator==(const Hrep& hrep) const
+template <class Num, class Den> bool basic_Hrep<Num, Den>::operator==(const basic_Hrep& hrep) const
 {
 	return ((equalities == hrep.equalities) && (inequalities == hrep.inequalities));
 };
 
-ostream& operator<<(ostream& os, const Hrep& hrep)
+template <class Num, class Den> ostream& operator<<(ostream& os, const basic_Hrep<Num, Den>& hrep)
 {
 	// Here we write the equalities and inequalities in the lrs format
 	os << "H-representation\n";
-	if (hrep.equalities.size() > 0)
+	if (hrep.equalities.rows() > 0)
 	{
-		os << "linearity " << hrep.equalities.size();
-		for (long int i(0); i < hrep.equalities.size(); i++)
+		os << "linearity " << hrep.equalities.rows();
+		for (long int i(0); i < hrep.equalities.rows(); i++)
 			os << " " << i+1;
 		os << "\n";
 	};
 	os << "begin\n";
-	os << hrep.equalities.size()+hrep.inequalities.size() << " " << hrep.inequalities[0].size() << " rational\n";
-	for (long int i(0); i < hrep.equalities.size(); i++)
+	os << hrep.equalities.rows()+hrep.inequalities.rows() << " " << hrep.dimension()+1 << " rational\n";
+	for (long int i(0); i < hrep.equalities.rows(); i++)
 	{
-		for (long int j(0); j < hrep.equalities[0].size(); j++)
+		basic_const_ratrow<Num, Den> row(hrep.equalities[i]);
+		for (long int j(0); j < row.size(); j++)
 		{
-			os << hrep.equalities[i][j].num;
-			if (hrep.equalities[i][j].den != 1)
-				os << "/" << hrep.equalities[i][j].den << " ";
-			else
-				os << " ";
+			put_number(os, row.num[j]);
+			if (row.den[j] != 1)
+			{
+				os << "/";
+				put_number(os, row.den[j]);
+			}
+			os << " ";
 		};
 		os << "\n";
 	};
-	for (long int i(0); i < hrep.inequalities.size(); i++)
+	for (long int i(0); i < hrep.inequalities.rows(); i++)
 	{
-		for (long int j(0); j < hrep.inequalities[i].size(); j++)
+		basic_const_ratrow<Num, Den> row(hrep.inequalities[i]);
+		for (long int j(0); j < row.size(); j++)
 		{
-			os << hrep.inequalities[i][j].num;
-			if (hrep.inequalities[i][j].den != 1)
-				os << "/" << hrep.inequalities[i][j].den << " ";
-			else
-				os << " ";
+			put_number(os, row.num[j]);
+			if (row.den[j] != 1)
+			{
+				os << "/";
+				put_number(os, row.den[j]);
+			}
+			os << " ";
 		};
 		os << "\n";
 	};
@@ -678,223 +1154,556 @@ ostream& operator<<(ostream& os, const Hrep& hrep)
 
 
 
-// Functions from the Vrep class :
+/* Files are read and written in a porta context of their own, so that 
+ * several threads may read and write files at a time. */
+static struct porta_context *file_context()
+{
+	struct porta_context *ctx(new_porta_context());
+	
+	use_porta_context(ctx);
+	initialize();
+	prt = in_batch ? batch_prt : stdout;
+	set_I_functions();
+	SET_MP_not_ready;
+	return ctx;
+}
 
 
-void Vrep::fill(const Tnum *data, const long int& nbPointsOrRays, const long int& dimension)
+static bool has_ext(const string& filename, const char *ext)
 {
-	//First we empty the table and reinitialise it.
-	pointsAndRays.clear();
-	pointsAndRays.resize(nbPointsOrRays, vector < fraction > (dimension+1, fraction()));
-	
-	for (long int i(0); i < nbPointsOrRays; i++)
-		for (long int j(0); j < dimension+1; j++)
-			pointsAndRays[i][j].num = data[i*(dimension+1)+j];
+	size_t l(strlen(ext));
+	return (filename.size() > l && filename.compare(filename.size()-l, l, ext) == 0);
+}
+
+
+/* The name of a porta text file without the extension, for the messages
+ * of write_poi_file() */
+static string base_name(const string& filename)
+{
+	return filename.substr(0, filename.size()-4);
+}
+
+
+/* Scanning the lrs files .ext and .ine straight from the mapped file */
+struct lrs_scan {
+	char *fname;
+	const char *p, *end;
 };
 
+static bool lrs_word(lrs_scan& f, string& w)
+{
+	while (f.p < f.end && isspace(*f.p))
+		f.p++;
+	const char *b(f.p);
+	while (f.p < f.end && !isspace(*f.p))
+		f.p++;
+	w.assign(b, f.p-b);
+	return (f.p > b);
+}
+
+static void lrs_skip_line(lrs_scan& f)
+{
+	while (f.p < f.end && *f.p != '\n')
+		f.p++;
+}
 
-void Vrep::fill(const Tnum *data_num, const Tden *data_den, const long int& nbPointsOrRays, const long int& dimension)
+// Reads an integer or a fraction p/q
+template <class Num, class D> static void lrs_number(lrs_scan& f, Num& num, D& den)
 {
-	//First we empty the table and reinitialise it.
-	pointsAndRays.clear();
-	pointsAndRays.resize(nbPointsOrRays, vector < fraction > (dimension+1, fraction()));
+	const char *p(f.p), *end(f.end);
+	Num n(0);
+	D d(0);
+	bool neg(false);
+	
+	while (p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r'))
+		p++;
+	if (p < end && (*p == '-' || *p == '+'))
+		neg = (*p++ == '-');
+	if (p == end || (unsigned) (*p-'0') > 9)
+		msg((char *)"%s : number expected", f.fname, 0);
+	for (; p < end && (unsigned) (*p-'0') <= 9; p++)
+	{
+		if (n >= porta_number<Num>::max()/10 && n > (porta_number<Num>::max()-(*p-'0'))/10)
+			msg((char *)"%s : coefficients beyond the integer range can not be read", f.fname, 0);
+		n = 10*n+(*p-'0');
+	}
+	num = neg ? -n : n;
+	den = 1;
+	if (p < end && *p == '/')
+	{
+		for (p++; p < end && (unsigned) (*p-'0') <= 9; p++)
+		{
+			if (d > (porta_number<D>::max()-(*p-'0'))/10)
+				msg((char *)"%s : coefficients beyond the integer range can not be read", f.fname, 0);
+			d = 10*d+(*p-'0');
+		}
+		if (d == 0)
+			msg((char *)"%s : invalid denominator", f.fname, 0);
+		den = d;
+	}
+	if (p < end && !isspace(*p))
+		msg((char *)"%s : invalid number (only integers and fractions are read)", f.fname, 0);
+	f.p = p;
+}
 
-	for (long int i(0); i < nbPointsOrRays; i++)
-		for (long int j(0); j < dimension+1; j++)
+/* Reads the table of the lrs file "fname" into "m", and marks the rows 
+ * listed after "linearity" in "lin". "kind" is "H-representation" or 
+ * "V-representation". The caller provides the porta context. */
+template <class Num, class Den> static void lrs_read(char *fname, const char *kind, basic_ratmatrix<Num, Den>& m, vector<char>& lin)
+{
+	typedef typename den_traits<Den>::type den_type;
+	lrs_scan f;
+	size_t len;
+	string w;
+	vector<long int> linearity;
+	long int rows, cols, l;
+	int one;
+	Num num;
+	den_type den;
+	
+	f.fname = fname;
+	f.p = map_input_file(fname, &len);
+	f.end = f.p+len;
+	
+	// The name, comments and options up to "begin"
+	while (lrs_word(f, w) && w != "begin")
+	{
+		if (w == "linearity")
 		{
-			pointsAndRays[i][j].num = data_num[i*(dimension+1)+j];
-			pointsAndRays[i][j].den = data_den[i*(dimension+1)+j];
+			lrs_number(f, l, one);
+			linearity.resize(l);
+			for (long int i(0); i < (long int) linearity.size(); i++)
+				lrs_number(f, linearity[i], one);
 		}
+		else if ((w == "H-representation" || w == "V-representation") && w != kind)
+			msg((char *)"%s : wrong kind of representation", fname, 0);
+		else if (w != "H-representation" && w != "V-representation")
+			lrs_skip_line(f);
+	}
+	if (w != "begin")
+		msg((char *)"%s : begin expected", fname, 0);
+	
+	// m n rational, where lrs allows m to be unknown (*****)
+	lrs_word(f, w);
+	rows = (w.size() && w[0] == '*') ? -1 : atol(w.c_str());
+	lrs_word(f, w);
+	cols = atol(w.c_str());
+	lrs_word(f, w);
+	if (cols < 1)
+		msg((char *)"%s : invalid number of columns", fname, 0);
+	
+	if (rows >= 0)
+	{
+		m.resize(rows, cols);
+		for (long int i(0); i < rows; i++)
+		{
+			basic_ratrow<Num, Den> row(m[i]);
+			for (long int j(0); j < cols; j++)
+			{
+				lrs_number(f, num, den);
+				set_entry(row, j, num, den);
+			}
+		}
+	}
+	else
+	{
+		basic_ratmatrix<Num, Den> r(1, cols);
+		m.resize(0, cols);
+		for (;;)
+		{
+			while (f.p < f.end && isspace(*f.p))
+				f.p++;
+			if (f.p == f.end || *f.p == 'e')
+				break;
+			for (long int j(0); j < cols; j++)
+			{
+				lrs_number(f, num, den);
+				set_entry(r[0], j, num, den);
+			}
+			m.push_back(r[0]);
+		}
+	}
+	unmap_input_file();
+	
+	lin.assign(m.rows(), 0);
+	for (long int i(0); i < (long int) linearity.size(); i++)
+	{
+		if (linearity[i] < 1 || linearity[i] > m.rows())
+			msg((char *)"%s : invalid linearity", fname, 0);
+		lin[linearity[i]-1] = 1;
+	}
+}
+
+
+
+// Functions from the Vrep class :
+
+
+template <class Num, class Den> void basic_Vrep<Num, Den>::fill(const Num *data, const long int& nbPointsOrRays, const long int& dimension)
+{
+	pointsAndRays.assign(data, 0, nbPointsOrRays, dimension+1);
 };
 
 
-void Vrep::fill(const string& filename)
+template <class Num, class Den> void basic_Vrep<Num, Den>::fill(const Num *data_num, const den_type *data_den, const long int& nbPointsOrRays, const long int& dimension)
 {
-	// We read the dimension first
-	// Then allocate the memory
-	// And fill up the table
+	pointsAndRays.assign(data_num, data_den, nbPointsOrRays, dimension+1);
 };
 
 
-void Vrep::fill(const listp* porta_list, const long int& dimension, const long int& nbCone, const long int& nbConv)
+template <class Num, class Den> void basic_Vrep<Num, Den>::fill(const string& filename)
 {
-	//First we empty the tables and reinitialise them.
+	char *fname(const_cast<char *>(filename.c_str()));
+	struct bin_view v;
+	struct porta_context *ctx(file_context());
+
+	//First we empty the table.
 	pointsAndRays.clear();
-	pointsAndRays.resize(nbCone+nbConv, vector < fraction > (dimension+1, fraction()));
 
-	// First, we copy the extremal rays
-	for (int i(0); i < nbCone; i++)
+	// lrs .ext files: the lines (linearity) are given as two rays
+	if (has_ext(filename, ".ext"))
 	{
-		pointsAndRays[i][0].num = (porta_list[i]->sys+dimension)->num; // The constant is brought at the front of each line // CHECK THAT THIS NUMBER IS ZERO AS EXPECTED!!!
-		pointsAndRays[i][0].den = (porta_list[i]->sys+dimension)->den.i;
-//		cout << pointsAndRays[i][0].num;
-		for (int j(0); j < dimension; j++)
+		vector < char > lin;
+		
+		lrs_read(fname, "V-representation", pointsAndRays, lin);
+		for (long int i(0), n(pointsAndRays.rows()); i < n; i++)
+			if (lin[i])
+			{
+				matrix_type line(0, pointsAndRays.cols());
+				
+				line.push_back(pointsAndRays[i]);
+				for (long int j(1); j < line.cols(); j++)
+					line[0].num[j] = -line[0].num[j];
+				pointsAndRays.push_back(line[0]);
+			}
+	}
+	// PORTA .poi files are read by porta itself
+	else if (file_ext(fname, (char *)".poi") == 1)
+	{
+		int d, *il(0);
+		RAT *rl(0);
+		int n(read_input_file(fname, 0, &d, &ar1, (int *)&nel_ar1, (char *)"\0", &il, 
+							  (char *)"\0", &il, (char *)"\0", &rl));
+		
+		pointsAndRays.resize(n, d+1);
+		for (long int i(0); i < n; i++)
 		{
-			pointsAndRays[i][1+j].num = (porta_list[i]->sys+j)->num;
-			pointsAndRays[i][1+j].den = (porta_list[i]->sys+j)->den.i;
-//			cout << pointsAndRays[i][1+j].num;
-		};
-//		cout << "fin" << endl;
-	};
+			const RAT *e(ar1+i*(d+1));
+			basic_ratrow<Num, Den> row(pointsAndRays[i]);
+			from_rat(row, 0, e[d]); // The conv/cone flag is brought at the front of each line
+			for (long int j(0); j < d; j++)
+				from_rat(row, 1+j, e[j]);
+		}
+	}
+	// Binary .poib files are mapped and read without copying them first
+	else if (file_ext(fname, (char *)".poi") == 2)
+	{
+		bin_open(fname, &v);
+		if (v.head->nmp)
+			msg((char *)"%s : coefficients beyond the integer range can not be read", fname, 0);
+		
+		long int dimension(v.head->ndim);
+		pointsAndRays.resize(v.head->rows, dimension+1);
+		for (long int i(0); i < v.head->rows; i++)
+		{
+			const struct bin_ent *e(v.sys+i*(dimension+1));
+			basic_ratrow<Num, Den> row(pointsAndRays[i]);
+			set_entry(row, 0, (Num) e[dimension].num, (den_type) e[dimension].den); // The conv/cone flag is brought at the front of each line
+			for (long int j(0); j < dimension; j++)
+				set_entry(row, 1+j, (Num) e[j].num, (den_type) e[j].den);
+		}
+		bin_close();
+	}
+	else
+		msg((char *)"%s : unknown file type (.ext, .poi or .poib expected)", fname, 0);
 	
-	// And copy also the extremal vertices
-	for (int i(0); i < nbConv; i++)
+	free_porta_context(ctx);
+};
+
+
+template <class Num, class Den> void basic_Vrep<Num, Den>::fill(const listp* plist, const long int& dimension, const long int& nbCone, const long int& nbConv)
+{
+	//First we empty the tables and reinitialise them.
+	pointsAndRays.resize(nbCone+nbConv, dimension+1);
+
+	// First the extremal rays, then the extremal vertices
+	for (int i(0); i < nbCone+nbConv; i++)
 	{
-		pointsAndRays[nbCone+i][0].num = (porta_list[nbCone+i]->sys+dimension)->num;
-		pointsAndRays[nbCone+i][0].den = (porta_list[nbCone+i]->sys+dimension)->den.i;
+		const RAT *sys(plist[i]->sys);
+		basic_ratrow<Num, Den> row(pointsAndRays[i]);
+		
+		from_rat(row, 0, sys[dimension]); // The constant is brought at the front of each line
 		for (int j(0); j < dimension; j++)
-		{
-			pointsAndRays[nbCone+i][1+j].num = (porta_list[nbCone+i]->sys+j)->num;
-			pointsAndRays[nbCone+i][1+j].den = (porta_list[nbCone+i]->sys+j)->den.i;
-		};
+			from_rat(row, 1+j, sys[j]);
 	};
 };
 
 // Provides some useful info about the polytope
-long int Vrep::nbPointsAndRays() const
+template <class Num, class Den> long int basic_Vrep<Num, Den>::nbPointsAndRays() const
 {
-	return pointsAndRays.size();
+	return pointsAndRays.rows();
 };
-long int Vrep::dimension() const
+template <class Num, class Den> long int basic_Vrep<Num, Den>::dimension() const
 {
-	if (nbPointsAndRays() > 0)
-		return pointsAndRays[0].size()-1;
+	if (pointsAndRays.cols() > 0)
+		return pointsAndRays.cols()-1;
 	else
 		return 0;
 };
 
+// Writes the points (first column 1) and rays (first column 0) into an lrs .ext file,
+// a PORTA .poi file or (any other name) a binary .poib file
+template <class Num, class Den> void basic_Vrep<Num, Den>::write(const string& filename) const
+{
+	char *fname(const_cast<char *>(filename.c_str()));
+	long int d(dimension());
+	FILE *ofp;
+	vector<RAT> row(d+1);
+
+	if (has_ext(filename, ".ext"))
+	{
+		ofstream os(fname);
+		if (!os)
+			msg((char *)"%s : can not open file", fname, 0);
+		os << *this;
+		return;
+	}
+
+	struct porta_context *ctx(file_context());
+	
+	if (!(ofp = fopen(fname, "wb")))
+		msg((char *)"%s : can not open file", fname, 0);
+	if (file_ext(fname, (char *)".poi") == 1)
+	{
+		// porta writes the cone section first
+		long int n(nbPointsAndRays()), k(0), nbCone(0);
+		string base(base_name(filename));
+		
+		ar1 = (RAT *) RATallo(ar1, 0, (n+1)*(d+1));
+		for (int cv(0); cv < 2; cv++)
+			for (long int i(0); i < n; i++)
+			{
+				basic_const_ratrow<Num, Den> r(pointsAndRays[i]);
+				RAT *e(ar1+k*(d+1));
+				
+				if ((r.num[0] != 0) != cv)
+					continue;
+				for (long int j(0); j < d; j++)
+					to_rat(e[j], r[1+j]);
+				e[d].num = cv;
+				e[d].den.i = 1;
+				k++;
+				nbCone += !cv;
+			}
+		dim = d;
+		listptoar(ar1, n, d+1, 0);
+		fprintf(ofp, "DIM = %ld\n\n", d);
+		write_poi_file(const_cast<char *>(base.c_str()), ofp, d, 0, 0, nbCone, 0, n-nbCone, nbCone);
+		free_porta_context(ctx);
+		return;
+	}
+	bin_begin(ofp, BIN_POI, d, nbPointsAndRays(), 0, 0, 0);
+	for (long int i(0); i < nbPointsAndRays(); i++)
+	{
+		basic_const_ratrow<Num, Den> r(pointsAndRays[i]);
+		for (long int j(0); j < d; j++)
+			to_rat(row[j], r[1+j]);
+		bin_row(ofp, &row[0], d, 0, r.num[0] != 0, 0);
+	}
+	bin_end(ofp);
+	fclose(ofp);
+	free_porta_context(ctx);
+};
+
 
 
 // Functions from the Hrep class:
 
 
-void Hrep::fill(const Tnum *dataIneq, const long int& nbIneq, const long int& dimension)
+template <class Num, class Den> void basic_Hrep<Num, Den>::fill(const Num *dataIneq, const long int& nbIneq, const long int& dimension)
 {
-	//First we empty the tables and reinitialise them.
-	equalities.clear();
-	inequalities.clear();
-	inequalities.resize(nbIneq, vector < fraction > (dimension+1, fraction()));
-
-	for (long int i(0); i < nbIneq; i++)
-		for (long int j(0); j < dimension+1; j++)
-			inequalities[i][j].num = dataIneq[i*(dimension+1)+j];
+	equalities.resize(0, dimension+1);
+	inequalities.assign(dataIneq, 0, nbIneq, dimension+1);
 	
 	// We use the null point as a valid point since it was not provided
 	validPoint.clear();
-	validPoint.resize(dimension, fraction());
+	validPoint.resize(dimension, fraction_type());
 	
 	checkValidPoint();
 };
 
 
-void Hrep::fill(const Tnum *dataIneq_num, const Tden *dataIneq_den, const long int& nbIneq, const long int& dimension)
+template <class Num, class Den> void basic_Hrep<Num, Den>::fill(const Num *dataIneq_num, const den_type *dataIneq_den, const long int& nbIneq, const long int& dimension)
 {
-	//First we empty the tables and reinitialise them.
-	equalities.clear();
-	inequalities.clear();
-	inequalities.resize(nbIneq, vector < fraction > (dimension+1, fraction()));
-
-	for (long int i(0); i < nbIneq; i++)
-		for (long int j(0); j < dimension+1; j++)
-		{
-			inequalities[i][j].num = dataIneq_num[i*(dimension+1)+j];
-			inequalities[i][j].den = dataIneq_den[i*(dimension+1)+j];
-		}
+	equalities.resize(0, dimension+1);
+	inequalities.assign(dataIneq_num, dataIneq_den, nbIneq, dimension+1);
 
 	// We use the null point as a valid point since it was not provided
 	validPoint.clear();
-	validPoint.resize(dimension, fraction());
+	validPoint.resize(dimension, fraction_type());
 	
 	checkValidPoint();
 };
 
 
-void Hrep::fill(const Tnum *dataEq, const long int& nbEq, const Tnum *dataIneq, const long int& nbIneq, const long int& dimension)
+template <class Num, class Den> void basic_Hrep<Num, Den>::fill(const Num *dataEq, const long int& nbEq, const Num *dataIneq, const long int& nbIneq, const long int& dimension)
 {
-	//First we empty the tables and reinitialise them.
-	equalities.clear();
-	equalities.resize(nbEq, vector < fraction > (dimension+1, fraction()));
-	inequalities.clear();
-	inequalities.resize(nbIneq, vector < fraction > (dimension+1, fraction()));
-
-	for (long int i(0); i < nbEq; i++)
-		for (long int j(0); j < dimension+1; j++)
-			equalities[i][j].num = dataEq[i*(dimension+1)+j];
-	for (long int i(0); i < nbIneq; i++)
-		for (long int j(0); j < dimension+1; j++)
-			inequalities[i][j].num = dataIneq[i*(dimension+1)+j];
+	equalities.assign(dataEq, 0, nbEq, dimension+1);
+	inequalities.assign(dataIneq, 0, nbIneq, dimension+1);
 	
 	// We use the null point as a valid point since it was not provided
 	validPoint.clear();
-	validPoint.resize(dimension, fraction());
+	validPoint.resize(dimension, fraction_type());
 	
 	checkValidPoint();
 };
 
 
-void Hrep::fill(const Tnum *dataEq_num, const Tden *dataEq_den, const long int& nbEq, const Tnum *dataIneq_num, const Tden *dataIneq_den, const long int& nbIneq, const long int& dimension)
+template <class Num, class Den> void basic_Hrep<Num, Den>::fill(const Num *dataEq_num, const den_type *dataEq_den, const long int& nbEq, const Num *dataIneq_num, const den_type *dataIneq_den, const long int& nbIneq, const long int& dimension)
 {
-	//First we empty the tables and reinitialise them.
-	equalities.clear();
-	equalities.resize(nbEq, vector < fraction > (dimension+1, fraction()));
-	inequalities.clear();
-	inequalities.resize(nbIneq, vector < fraction > (dimension+1, fraction()));
-
-	for (long int i(0); i < nbEq; i++)
-		for (long int j(0); j < dimension+1; j++)
-		{
-			equalities[i][j].num = dataEq_num[i*(dimension+1)+j];
-			equalities[i][j].den = dataEq_den[i*(dimension+1)+j];
-		}
-	for (long int i(0); i < nbIneq; i++)
-		for (long int j(0); j < dimension+1; j++)
-		{
-			inequalities[i][j].num = dataIneq_num[i*(dimension+1)+j];
-			inequalities[i][j].den = dataIneq_den[i*(dimension+1)+j];
-		}
+	equalities.assign(dataEq_num, dataEq_den, nbEq, dimension+1);
+	inequalities.assign(dataIneq_num, dataIneq_den, nbIneq, dimension+1);
 	
 	// We use the null point as a valid point since it was not provided
 	validPoint.clear();
-	validPoint.resize(dimension, fraction());
+	validPoint.resize(dimension, fraction_type());
 	
 	checkValidPoint();
 };
 
 
-void Hrep::fill(const string& filename)
+template <class Num, class Den> void basic_Hrep<Num, Den>::fill(const matrix_type& eqs, const matrix_type& ieqs)
 {
-	// We read the dimension first
-	// Then allocate the memory
-	// And fill up the table
+	equalities = eqs;
+	inequalities = ieqs;
 	
 	// We use the null point as a valid point since it was not provided
 	validPoint.clear();
-	validPoint.resize(dimension(), fraction());
+	validPoint.resize(dimension(), fraction_type());
 	
 	checkValidPoint();
 };
 
 
-void Hrep::fill(const listp* porta_list, const long int& dimension, const long int& nbEq, const long int& nbIneq, const int* indx)
+template <class Num, class Den> void basic_Hrep<Num, Den>::fill(const string& filename)
 {
-	//First we empty the tables and reinitialise them.
+	char *fname(const_cast<char *>(filename.c_str()));
+	struct bin_view v;
+	struct porta_context *ctx(file_context());
+
+	//First we empty the tables.
 	equalities.clear();
-	equalities.resize(nbEq, vector < fraction > (dimension+1, fraction()));
 	inequalities.clear();
-	inequalities.resize(nbIneq, vector < fraction > (dimension+1, fraction()));
+	validPoint.clear();
+
+	// lrs .ine files: the rows listed after linearity are the equalities
+	if (has_ext(filename, ".ine"))
+	{
+		matrix_type m;
+		vector < char > lin;
+		long int nbEq(0);
+		
+		lrs_read(fname, "H-representation", m, lin);
+		for (long int i(0); i < m.rows(); i++)
+			nbEq += lin[i];
+		equalities.resize(0, m.cols());
+		inequalities.resize(0, m.cols());
+		if (nbEq == 0)
+			inequalities = m;
+		else
+			for (long int i(0); i < m.rows(); i++)
+				(lin[i] ? equalities : inequalities).push_back(m[i]);
+		validPoint.resize(dimension(), fraction_type());
+	}
+	// PORTA .ieq files are read by porta itself
+	else if (file_ext(fname, (char *)".ieq") == 1)
+	{
+		int d, *il(0);
+		RAT *rl(0);
+		int n(read_input_file(fname, 0, &d, &ar1, (int *)&nel_ar1, (char *)"\0", &il, 
+							  (char *)"\0", &il, (char *)"\0", &rl));
+		long int nbIneq(0);
+		
+		for (long int i(0); i < n; i++)
+			if (ar1[i*(d+2)+d+1].num)
+				nbIneq++;
+		equalities.resize(n-nbIneq, d+1);
+		inequalities.resize(nbIneq, d+1);
+		for (long int i(0), eq(0), ie(0); i < n; i++)
+		{
+			const RAT *e(ar1+i*(d+2));
+			basic_ratrow<Num, Den> row(e[d+1].num ? inequalities[ie++] : equalities[eq++]);
+			int sign(e[d+1].num ? -1 : 1); // Same conventions as in HtoVrep
+			from_rat(row, 0, e[d], -sign);
+			for (long int j(0); j < d; j++)
+				from_rat(row, 1+j, e[j], sign);
+		}
+		// the VALID point, 0 if the file has none
+		validPoint.resize(d, fraction_type());
+		matrix_type valid(1, d);
+		for (long int j(0); j < d && ar6; j++)
+			from_rat(valid[0], j, ar6[j]);
+		for (long int j(0); j < d; j++)
+			validPoint[j] = valid[0][j];
+	}
+	// Binary .ieqb files are mapped and read without copying them first
+	else if (file_ext(fname, (char *)".ieq") == 2)
+	{
+		bin_open(fname, &v);
+		if (v.head->nmp)
+			msg((char *)"%s : coefficients beyond the integer range can not be read", fname, 0);
+		
+		long int dimension(v.head->ndim);
+		long int nbIneq(0);
+		for (long int i(0); i < v.head->rows; i++)
+			if (v.sys[i*(dimension+2)+dimension+1].num)
+				nbIneq++;
+		equalities.resize(v.head->rows-nbIneq, dimension+1);
+		inequalities.resize(nbIneq, dimension+1);
+		for (long int i(0), eq(0), ie(0); i < v.head->rows; i++)
+		{
+			const struct bin_ent *e(v.sys+i*(dimension+2));
+			basic_ratrow<Num, Den> row(e[dimension+1].num ? inequalities[ie++] : equalities[eq++]);
+			int sign(e[dimension+1].num ? -1 : 1); // Same conventions as in HtoVrep
+			set_entry(row, 0, (Num) (-sign*e[dimension].num), (den_type) e[dimension].den);
+			for (long int j(0); j < dimension; j++)
+				set_entry(row, 1+j, (Num) (sign*e[j].num), (den_type) e[j].den);
+		}
+		validPoint.resize(dimension, fraction_type());
+		if (v.valid)
+		{
+			matrix_type valid(1, dimension);
+			for (long int j(0); j < dimension; j++)
+				set_entry(valid[0], j, (Num) v.valid[j].num, (den_type) v.valid[j].den);
+			for (long int j(0); j < dimension; j++)
+				validPoint[j] = valid[0][j];
+		}
+		bin_close();
+	}
+	else
+		msg((char *)"%s : unknown file type (.ine, .ieq or .ieqb expected)", fname, 0);
+	
+	free_porta_context(ctx);
+	checkValidPoint();
+};
+
+
+template <class Num, class Den> void basic_Hrep<Num, Den>::fill(const listp* plist, const long int& dimension, const long int& nbEq, const long int& nbIneq, const int* indx)
+{
+	//First we empty the tables and reinitialise them.
+	typename constraint_matrix<Num, Den>::type eqs(nbEq, dimension+1), ieqs(nbIneq, dimension+1);
 
-cout << endl << endl << "Hrep::fill, with dimension = " << dimension << ", nbEq = " << nbEq << ", nbIneq = " << nbIneq << endl << endl << endl << flush;
+if (!in_batch) cout << endl << endl << "Hrep::fill, with dimension = " << dimension << ", nbEq = " << nbEq << ", nbIneq = " << nbIneq << endl << endl << endl << flush;
 
 	// First, we copy the equality constraints
 	for (int i(0); i < nbEq; i++)
 	{
-		equalities[i][0].num = (porta_list[nbIneq+i]->sys+dimension)->num; // The constant is brought at the front of each line
-		equalities[i][0].den = (porta_list[nbIneq+i]->sys+dimension)->den.i;
+		const RAT *sys(plist[nbIneq+i]->sys);
+		typename constraint_matrix<Num, Den>::row row(eqs[i]);
+		
+		from_rat(row, 0, sys[dimension]); // The constant is brought at the front of each line
 		for (int j(0); j < dimension; j++)
-		{
-			equalities[i][1+j].num = (porta_list[nbIneq+i]->sys+j)->num;
-			equalities[i][1+j].den = (porta_list[nbIneq+i]->sys+j)->den.i;
-		};
+			from_rat(row, 1+j, sys[j]);
 	};
 	
 	// We prepare the inverse index vector to know for each variable
@@ -908,22 +1717,23 @@ cout << endl << endl << "Hrep::fill, with dimension = " << dimension << ", nbEq
 	// And copy also the inequalities (with a zero coefficient for variables which are already fixed by the equality constraints)
 	for (int i(0); i < nbIneq; i++)
 	{
-		inequalities[i][0].num = (porta_list[i]->sys+dimension-nbEq)->num;
-		inequalities[i][0].den = (porta_list[i]->sys+dimension-nbEq)->den.i;
+		const RAT *sys(plist[i]->sys);
+		typename constraint_matrix<Num, Den>::row row(ieqs[i]);
+		
+		from_rat(row, 0, sys[dimension-nbEq]);
 		for (int j(0); j < dimension; j++)
 		{
 			if (indices[j] != -1) // Otherwise the current variable does not appear in the inequality description
-			{
-				inequalities[i][1+j].num = -(porta_list[i]->sys+indices[j])->num; // These terms are on the other side of the inequality sign
-				inequalities[i][1+j].den = (porta_list[i]->sys+indices[j])->den.i;
-			}
+				from_rat(row, 1+j, sys[indices[j]], -1); // These terms are on the other side of the inequality sign
 		};
 	};
+	take_constraints(equalities, eqs);
+	take_constraints(inequalities, ieqs);
 	
 	// We use the null point as a valid point since it was not provided
 //	cout << "0" << libportaInitialized << endl;
 	validPoint.clear();
-	validPoint.resize(dimension, fraction());
+	validPoint.resize(dimension, fraction_type());
 
 //	cout << "1" << libportaInitialized << endl;
 
@@ -932,30 +1742,123 @@ cout << endl << endl << "Hrep::fill, with dimension = " << dimension << ", nbEq
 
 
 // Provides some useful info about the polytope
-long int Hrep::nbEqualities() const
+template <class Num, class Den> long int basic_Hrep<Num, Den>::nbEqualities() const
 {
-	return equalities.size();
+	return equalities.rows();
 };
-long int Hrep::nbInequalities() const
+template <class Num, class Den> long int basic_Hrep<Num, Den>::nbInequalities() const
 {
-	return inequalities.size();
+	return inequalities.rows();
 };
-long int Hrep::dimension() const
+template <class Num, class Den> long int basic_Hrep<Num, Den>::dimension() const
 {
-	if (nbEqualities() > 0)
-		return equalities[0].size()-1;
-	else if (nbInequalities() > 0)
-		return inequalities[0].size()-1;
+	if (equalities.cols() > 0)
+		return equalities.cols()-1;
+	else if (inequalities.cols() > 0)
+		return inequalities.cols()-1;
 	else
 		return 0;
 };
 
-void Hrep::checkValidPoint() const
+// Writes the equalities, inequalities and the valid point into an lrs .ine file,
+// a PORTA .ieq file or (any other name) a binary .ieqb file
+template <class Num, class Den> void basic_Hrep<Num, Den>::write(const string& filename) const
+{
+	char *fname(const_cast<char *>(filename.c_str()));
+	long int d(dimension());
+	FILE *ofp;
+	vector<RAT> row(d+1), valid(d+1);
+
+	if (has_ext(filename, ".ine"))
+	{
+		ofstream os(fname);
+		if (!os)
+			msg((char *)"%s : can not open file", fname, 0);
+		os << *this;
+		return;
+	}
+
+	struct porta_context *ctx(file_context());
+	
+	if (!(ofp = fopen(fname, "wb")))
+		msg((char *)"%s : can not open file", fname, 0);
+	for (long int j(0); j < d && j < (long int) validPoint.size(); j++)
+		to_rat(valid[j], validPoint[j]);
+	if (file_ext(fname, (char *)".ieq") == 1)
+	{
+		long int nbEq(nbEqualities()), nbIneq(nbInequalities());
+		
+		// Same conventions as below, rows of d+2 entries as read by porta
+		ar1 = (RAT *) RATallo(ar1, 0, (nbEq+nbIneq+1)*(d+2));
+		for (long int i(0); i < nbEq+nbIneq; i++)
+		{
+			basic_const_ratrow<Num, Den> r(i < nbEq ? equalities[i] : inequalities[i-nbEq]);
+			int sign(i < nbEq ? 1 : -1);
+			RAT *e(ar1+i*(d+2));
+			
+			for (long int j(0); j < d; j++)
+				to_rat(e[j], r[1+j], sign);
+			to_rat(e[d], r[0], -sign);
+			e[d+1].num = (i >= nbEq);
+			e[d+1].den.i = 1;
+		}
+		dim = d;
+		listptoar(ar1, nbEq+nbIneq, d+2, 0);
+		fprintf(ofp, "DIM = %ld\n\n", d);
+		if ((long int) validPoint.size() == d)
+		{
+			fprintf(ofp, "VALID\n");
+			for (long int j(0); j < d; j++)
+				if (valid[j].den.i != 1)
+					fprintf(ofp, "%ld/%i ", valid[j].num, valid[j].den.i);
+				else
+					fprintf(ofp, "%ld ", valid[j].num);
+			fprintf(ofp, "\n\n");
+		}
+		// write_ieq_file() would write the inequalities as a table, which porta can not read back
+		int start(1);
+		fprintf(ofp, "INEQUALITIES_SECTION\n");
+		if (nbEq)
+			writesys(ofp, 0, nbEq, d+1, 0, 0, '=', &start);
+		fprintf(ofp, "\n");
+		start = 1;
+		if (nbIneq)
+			writesys(ofp, nbEq, nbEq+nbIneq, d+1, 0, 0, '<', &start);
+		fprintf(ofp, "\nEND\n");
+		fclose(ofp);
+		free_porta_context(ctx);
+		return;
+	}
+	bin_begin(ofp, BIN_IEQ, d, nbEqualities()+nbInequalities(),
+			  (long int) validPoint.size() == d ? &valid[0] : 0, 0, 0);
+	// Same conventions as in HtoVrep : b + a x == 0 and b - a x >= 0
+	for (long int i(0); i < nbEqualities(); i++)
+	{
+		basic_const_ratrow<Num, Den> r(equalities[i]);
+		for (long int j(0); j < d; j++)
+			to_rat(row[j], r[1+j]);
+		to_rat(row[d], r[0], -1);
+		bin_row(ofp, &row[0], d+1, 0, 0, 0);
+	}
+	for (long int i(0); i < nbInequalities(); i++)
+	{
+		basic_const_ratrow<Num, Den> r(inequalities[i]);
+		for (long int j(0); j < d; j++)
+			to_rat(row[j], r[1+j], -1);
+		to_rat(row[d], r[0]);
+		bin_row(ofp, &row[0], d+1, 0, 1, 0);
+	}
+	bin_end(ofp);
+	fclose(ofp);
+	free_porta_context(ctx);
+};
+
+template <class Num, class Den> void basic_Hrep<Num, Den>::checkValidPoint() const
 {
 //	cout << "2" << libportaInitialized << endl;
 	for (long int i(0); i < nbEqualities(); i++)
 	{
-		fraction value(equalities[i][0]);
+		fraction_type value(equalities[i][0]);
 		for (long int j(1); j < dimension(); j++)
 			value = value + equalities[i][j]*validPoint[j-1];
 			
@@ -968,7 +1871,7 @@ void Hrep::checkValidPoint() const
 	
 	for (long int i(0); i < nbInequalities(); i++)
 	{
-		fraction value(inequalities[i][0]);
+		fraction_type value(inequalities[i][0]);
 		for (long int j(1); j < dimension(); j++)
 			value = value + inequalities[i][j]*validPoint[j-1];
 			
@@ -982,6 +1885,216 @@ void Hrep::checkValidPoint() const
 
 
 
+// Functions from the Hull class:
+
+
+/* Products and sums of the coefficients of the hull, false on overflow */
+template <class T> static bool mul_fits(const T& a, const T& b, T& r)
+{
+	T m(porta_number<T>::max()), x(a < 0 ? -a : a);
+	
+	if (x != 0 && (b > m/x || b < -(m/x)))
+		return false;
+	r = a*b;
+	return true;
+}
+
+template <class T> static bool add_fits(const T& a, const T& b, T& r)
+{
+	T m(porta_number<T>::max());
+	
+	if ((b > 0 && a > m-b) || (b < 0 && a < -m-b))
+		return false;
+	r = a+b;
+	return true;
+}
+
+
+/* Divides the integral row by the gcd of its coefficients */
+template <class Num> static void make_primitive(vector<Num>& row)
+{
+	Num g(0);
+	
+	for (size_t j(0); j < row.size() && g != 1; j++)
+		g = gcd(g, row[j]);
+	if (g > 1)
+		for (size_t j(0); j < row.size(); j++)
+			row[j] = row[j]/g;
+}
+
+
+/* The value of the (integral) constraint h at the point or ray p */
+template <class Num, class Den> static bool constraint_value(const basic_const_ratrow<Num, Den>& h, const basic_const_ratrow<Num, Den>& p, 
+															 basic_fraction<Num, Num>& v)
+{
+	v = basic_fraction<Num, Num>(0, 1);
+	for (long int j(0); j < h.size(); j++)
+	{
+		Num t, a, b, d((Num) p.den[j]);
+		
+		if (!mul_fits(h.num[j], p.num[j], t) || !mul_fits(v.num, d, a) || !mul_fits(v.den, t, b) 
+			|| !add_fits(a, b, v.num) || !mul_fits(v.den, d, v.den))
+			return false;
+		v.simplify();
+	}
+	return true;
+}
+
+
+template <class Num, class Den> void basic_Hull<Num, Den>::fill(const basic_Vrep<Num, Den>& vrep)
+{
+	if (&vrep != &generators)
+		generators = vrep;
+	VtoHrep(generators, facets);
+	incidences.clear();
+	
+	const matrix_type& g(generators.pointsAndRays);
+	matrix_type& f(facets.inequalities);
+	
+	incremental = (facets.nbEqualities() == 0 && f.rows() > 0);
+	for (long int k(0); incremental && k < g.rows(); k++)
+		incremental = (g[k].num[0] != 0);
+	
+	// The facets are made integral and primitive
+	vector<Num> row(f.cols());
+	for (long int i(0); incremental && i < f.rows(); i++)
+	{
+		Num l(1);
+		
+		for (long int j(0); incremental && j < f.cols(); j++)
+			incremental = mul_fits(l, (Num) (f[i].den[j]/gcd(l, (Num) f[i].den[j])), l);
+		for (long int j(0); incremental && j < f.cols(); j++)
+			incremental = mul_fits(f[i].num[j], (Num) (l/f[i].den[j]), row[j]);
+		if (!incremental)
+			break;
+		make_primitive(row);
+		for (long int j(0); j < f.cols(); j++)
+			set_entry(f[i], j, row[j], 1);
+	}
+	
+	// The generators on each facet
+	incidences.resize(f.rows());
+	for (long int i(0); incremental && i < f.rows(); i++)
+	{
+		basic_const_ratrow<Num, Den> h(f[i]);
+		
+		for (long int k(0); incremental && k < g.rows(); k++)
+		{
+			basic_fraction<Num, Num> v;
+			
+			incremental = constraint_value(h, g[k], v);
+			if (v.num == 0)
+				incidences[i].push_back(k);
+		}
+	}
+};
+
+
+template <class Num, class Den> void basic_Hull<Num, Den>::add(const matrix_type& rows)
+{
+	if (rows.rows() == 0)
+		return;
+	if (generators.nbPointsAndRays() == 0)
+	{
+		fill(basic_Vrep<Num, Den>(rows));
+		return;
+	}
+	if (rows.cols() != generators.pointsAndRays.cols())
+		msg((char *)"%sthe points added do not have the dimension of the hull", (char *)"", 0);
+	
+	long int first(generators.nbPointsAndRays());
+	
+	for (long int k(0); k < rows.rows(); k++)
+		generators.pointsAndRays.push_back(rows[k]);
+	for (long int k(first); incremental && k < generators.nbPointsAndRays(); k++)
+		incremental = addGenerator(k);
+	if (!incremental)
+		fill(generators);
+};
+
+
+template <class Num, class Den> bool basic_Hull<Num, Den>::addGenerator(long int k)
+{
+	const matrix_type& g(generators.pointsAndRays);
+	const matrix_type& f(facets.inequalities);
+	basic_const_ratrow<Num, Den> p(g[k]);
+	long int n(f.rows()), d(g.cols()-1);
+	
+	// A ray may make the face at infinity a facet, which is not kept
+	if (p.num[0] == 0)
+		return false;
+	
+	vector < basic_fraction<Num, Num> > value(n);
+	for (long int i(0); i < n; i++)
+		if (!constraint_value(f[i], p, value[i]))
+			return false;
+	
+	// The facets the point does not see remain, with the point on them if it is
+	matrix_type kept(0, d+1);
+	vector < vector < long int > > keptIncidences;
+	for (long int i(0); i < n; i++)
+		if (value[i].num >= 0)
+		{
+			kept.push_back(f[i]);
+			keptIncidences.push_back(incidences[i]);
+			if (value[i].num == 0)
+				keptIncidences.back().push_back(k);
+		}
+	
+	// The point is in the hull
+	if (kept.rows() == n)
+	{
+		incidences.swap(keptIncidences);
+		return true;
+	}
+	
+	// Each facet the point sees and each neighbour it does not see give the facet through their ridge and the point
+	matrix_type newFacet(1, d+1);
+	vector<Num> row(d+1);
+	for (long int i(0); i < n; i++)
+		for (long int m(0); value[i].num > 0 && m < n; m++)
+		{
+			if (value[m].num >= 0)
+				continue;
+			
+			vector<long int> ridge;
+			set_intersection(incidences[i].begin(), incidences[i].end(), incidences[m].begin(), incidences[m].end(), 
+							 back_inserter(ridge));
+			if ((long int) ridge.size() < d-1)
+				continue;
+			
+			bool adjacent(true);
+			for (long int l(0); adjacent && l < n; l++)
+				if (l != i && l != m && includes(incidences[l].begin(), incidences[l].end(), ridge.begin(), ridge.end()))
+					adjacent = false;
+			if (!adjacent)
+				continue;
+			
+			// value[i] f[m] - value[m] f[i], which vanishes at the point
+			Num x, y;
+			if (!mul_fits(value[i].num, value[m].den, x) || !mul_fits(-value[m].num, value[i].den, y))
+				return false;
+			for (long int j(0); j <= d; j++)
+			{
+				Num a, b;
+				if (!mul_fits(x, f[m].num[j], a) || !mul_fits(y, f[i].num[j], b) || !add_fits(a, b, row[j]))
+					return false;
+			}
+			make_primitive(row);
+			for (long int j(0); j <= d; j++)
+				set_entry(newFacet[0], j, row[j], 1);
+			kept.push_back(newFacet[0]);
+			ridge.push_back(k);
+			keptIncidences.push_back(ridge);
+		}
+	
+	facets.inequalities = kept;
+	incidences.swap(keptIncidences);
+	return true;
+};
+
+
+
 
 
 /* The following added by J-D Bancal on 22.2.2012 to call porta as a c library.
@@ -1455,3 +2568,29 @@ void Hrep::checkValidPoint() const
     ///* 17.01.1994: include logging on file porta.log */
     //fclose( logfile );
 //}
+
+
+
+/* The number types of the library (see the end of libporta.h). Another 
+ * type takes a specialization of porta_number and a line here. */
+#define INSTANTIATE_LIBPORTA(Num, Den) \
+	template class basic_ratmatrix<Num, Den>; \
+	template class basic_Vrep<Num, Den>; \
+	template class basic_Hrep<Num, Den>; \
+	template class basic_Hull<Num, Den>; \
+	template void VtoHrep(const basic_Vrep<Num, Den>&, basic_Hrep<Num, Den>&); \
+	template void HtoVrep(const basic_Hrep<Num, Den>&, basic_Vrep<Num, Den>&); \
+	template vector<string> VtoHrep(const vector< basic_Vrep<Num, Den> >&, vector< basic_Hrep<Num, Den> >&, int); \
+	template vector<string> HtoVrep(const vector< basic_Hrep<Num, Den> >&, vector< basic_Vrep<Num, Den> >&, int); \
+	template ostream& operator<<(ostream&, const basic_Vrep<Num, Den>&); \
+	template ostream& operator<<(ostream&, const basic_Hrep<Num, Den>&);
+
+template class basic_fraction<Tnum, Tden>;
+INSTANTIATE_LIBPORTA(Tnum, Tden)
+INSTANTIATE_LIBPORTA(Tnum, void)
+
+#ifdef __SIZEOF_INT128__
+template class basic_fraction<__int128, __int128>;
+INSTANTIATE_LIBPORTA(__int128, __int128)
+INSTANTIATE_LIBPORTA(__int128, void)
+#endif
@@ -32,9 +32,11 @@ from the porta.c, porta.h and xporta.c source files.
 #include <iostream>
 #include <string>
 #include <vector>
+#include <limits>
 extern "C" { // These are c libraries.
 #include "porta.h"
 #include "log.h"
+#include "cache.h"
 }
 
 using namespace std;
@@ -42,84 +44,303 @@ using namespace std;
 
 /* The two following classes are meant to be easy ways to describe polytopes 
  * either in terms of half-planes (inequality and equality constraints), or
- * in terms of extremal vertices and rays. */
-class Hrep;
-class Vrep;
+ * in terms of extremal vertices and rays. They are templates on the types
+ * of the numerators and of the denominators of the coefficients, see 
+ * basic_Vrep and basic_Hrep below, and Vrep and Hrep at the end of the 
+ * file for the usual instantiations. */
+template <class Num, class Den> class basic_Vrep;
+template <class Num, class Den> class basic_Hrep;
+template <class Num, class Den> class basic_Hull;
 
 
 /* Let us define the types of numbers we want to use : the first is the
  * type for numerator coefficients, and the second one for denominator
- * coefficients. */
+ * coefficients. These are the types of Vrep and Hrep, the types of porta's
+ * integer arithmetic. */
 typedef long int Tnum;
 typedef int Tden;
 
 
+/* The largest value of a number type. A type of arbitrary precision 
+ * specializes max() to the largest value it is meant to hold. */
+template <class T> struct porta_number {
+	static T max() {return numeric_limits<T>::max();};
+};
+
+#ifdef __SIZEOF_INT128__
+template <> struct porta_number<__int128> {
+	static __int128 max() {return (__int128) (~(unsigned __int128) 0 >> 1);};
+};
+#endif
+
+
+/* The denominator type "void" stands for integral coefficients : no 
+ * denominators are stored at all, and every denominator reads 1 (the
+ * arrays of denominators are then unit_den). */
+class unit_den {
+	public:
+		int operator[](long int) const {return 1;};
+		unit_den operator+(long int) const {return *this;};
+};
+
+template <class Den> struct den_traits {
+	typedef Den type; // The type of a denominator
+	typedef Den *pointer; // The denominators of a row
+	typedef const Den *const_pointer;
+};
+
+template <> struct den_traits<void> {
+	typedef int type;
+	typedef unit_den pointer;
+	typedef unit_den const_pointer;
+};
+
+
 /* Let's define a fraction */
-class fraction{
+template <class Num, class Den> class basic_fraction {
 	public:
-		Tnum num; // The numerator of the fraction
-		Tden den; // The denominator
+		typedef typename den_traits<Den>::type den_type;
 		
-		fraction() : num(0), den(1) {}; // By default, a fraction is initialized to zero.
+		Num num; // The numerator of the fraction
+		Den den; // The denominator
+		
+		basic_fraction() : num(0), den(1) {}; // By default, a fraction is initialized to zero.
+		basic_fraction(const Num& n, const Den& d) : num(n), den(d) {};
 
-		bool operator==(const fraction& f) const;
+		bool operator==(const basic_fraction& f) const;
 		
 		// Basic arithmetic
-		fraction operator+ (const fraction& f) const;
-		fraction operator* (const fraction& f) const;
+		basic_fraction operator+ (const basic_fraction& f) const;
+		basic_fraction operator* (const basic_fraction& f) const;
 		
 		void simplify();
 };
 
+/* An integral coefficient */
+template <class Num> class basic_fraction<Num, void> {
+	public:
+		typedef int den_type;
+		
+		Num num;
+		static const int den = 1;
+		
+		basic_fraction() : num(0) {};
+		basic_fraction(const Num& n, int) : num(n) {};
+
+		bool operator==(const basic_fraction& f) const {return (num == f.num);};
+		
+		basic_fraction operator+ (const basic_fraction& f) const {return basic_fraction(num+f.num, 1);};
+		basic_fraction operator* (const basic_fraction& f) const {return basic_fraction(num*f.num, 1);};
+		
+		void simplify() {};
+};
+
+template <class Num> const int basic_fraction<Num, void>::den;
+
+
+/* Rows of fractions are accessed through light views on the numerator and
+ * denominator arrays of a ratmatrix (below), in the manner of a span. An
+ * element of a row view is itself a reference to the numerator and to the
+ * denominator, so that row[j].num and row[j].den can be read and written. */
+template <class Num, class Den> class basic_fraction_ref {
+	public:
+		Num& num;
+		Den& den;
+		
+		basic_fraction_ref(Num& n, Den& d) : num(n), den(d) {};
+		
+		operator basic_fraction<Num, Den>() const {return basic_fraction<Num, Den>(num, den);};
+		basic_fraction_ref& operator=(const basic_fraction<Num, Den>& f) {num = f.num; den = f.den; return *this;};
+};
+
+template <class Num> class basic_fraction_ref<Num, void> {
+	public:
+		Num& num;
+		static const int den = 1;
+		
+		basic_fraction_ref(Num& n, int) : num(n) {};
+		
+		operator basic_fraction<Num, void>() const {return basic_fraction<Num, void>(num, 1);};
+		basic_fraction_ref& operator=(const basic_fraction<Num, void>& f) {num = f.num; return *this;};
+};
+
+template <class Num> const int basic_fraction_ref<Num, void>::den;
+
+template <class Num, class Den> class basic_const_ratrow {
+	public:
+		const Num *num;
+		typename den_traits<Den>::const_pointer den;
+		
+		basic_const_ratrow(const Num *n, typename den_traits<Den>::const_pointer d, long int length) : num(n), den(d), len(length) {};
+		
+		basic_fraction<Num, Den> operator[](long int j) const {return basic_fraction<Num, Den>(num[j], den[j]);};
+		long int size() const {return len;};
+		
+	protected:
+		long int len;
+};
+
+
+template <class Num, class Den> class basic_ratrow {
+	public:
+		Num *num; // The numerators of the row
+		typename den_traits<Den>::pointer den; // The denominators
+		
+		basic_ratrow(Num *n, typename den_traits<Den>::pointer d, long int length) : num(n), den(d), len(length) {};
+		
+		basic_fraction_ref<Num, Den> operator[](long int j) const {return basic_fraction_ref<Num, Den>(num[j], den[j]);};
+		long int size() const {return len;};
+		
+		operator basic_const_ratrow<Num, Den>() const {return basic_const_ratrow<Num, Den>(num, den, len);};
+		
+	protected:
+		long int len;
+};
+
+
+/* The denominators of a ratmatrix, none for integral coefficients */
+template <class Den> class den_array {
+	public:
+		// Copies n denominators (if d is 0, all of them are 1)
+		void assign(long int n, const Den *d) {if (d) v.assign(d, d+n); else v.assign(n, 1);};
+		void append(const Den *d, long int n) {v.insert(v.end(), d, d+n);};
+		
+		Den *data() {return v.empty() ? 0 : &v[0];};
+		const Den *data() const {return v.empty() ? 0 : &v[0];};
+		
+		bool operator==(const den_array& a) const {return (v == a.v);};
+		
+	protected:
+		vector < Den > v;
+};
+
+template <> class den_array<void> {
+	public:
+		// The denominators given, if any, have to be 1
+		void assign(long int n, const int *d);
+		void append(unit_den, long int) {};
+		
+		unit_den data() const {return unit_den();};
+		
+		bool operator==(const den_array&) const {return true;};
+};
+
+
+/* A matrix of fractions, stored row by row in one contiguous array of
+ * numerators and one of denominators. */
+template <class Num, class Den> class basic_ratmatrix {
+	public:
+		typedef typename den_traits<Den>::type den_type;
+		
+		basic_ratmatrix() : nbRows(0), nbCols(0) {};
+		basic_ratmatrix(const long int& rows, const long int& cols) {resize(rows, cols);};
+		
+		// All the entries are set to zero (0/1)
+		void resize(const long int& rows, const long int& cols);
+		void clear() {resize(0, 0);};
+		
+		// Copies the rows x cols numerators and denominators (if data_den is 0, all denominators are 1)
+		void assign(const Num *data_num, const den_type *data_den, const long int& rows, const long int& cols);
+		
+		// Appends a row of cols() entries
+		void push_back(const basic_const_ratrow<Num, Den>& row);
+		
+		long int rows() const {return nbRows;};
+		long int cols() const {return nbCols;};
+		
+		basic_ratrow<Num, Den> operator[](long int i) {return basic_ratrow<Num, Den>(numerators()+i*nbCols, denominators()+i*nbCols, nbCols);};
+		basic_const_ratrow<Num, Den> operator[](long int i) const {return basic_const_ratrow<Num, Den>(numerators()+i*nbCols, denominators()+i*nbCols, nbCols);};
+		
+		// The whole arrays, row by row
+		Num *numerators() {return num.empty() ? 0 : &num[0];};
+		typename den_traits<Den>::pointer denominators() {return den.data();};
+		const Num *numerators() const {return num.empty() ? 0 : &num[0];};
+		typename den_traits<Den>::const_pointer denominators() const {return den.data();};
+		
+		bool operator==(const basic_ratmatrix& m) const;
+		
+	protected:
+		long int nbRows, nbCols;
+		vector < Num > num;
+		den_array < Den > den;
+};
+
+
+/* The conversions between the two representations (the vector versions
+ * at the end of the file convert batches) */
+template <class Num, class Den> void VtoHrep(const basic_Vrep<Num, Den>& vrep, basic_Hrep<Num, Den>& hrep);
+template <class Num, class Den> void HtoVrep(const basic_Hrep<Num, Den>& hrep, basic_Vrep<Num, Den>& vrep);
+
+// Definition of the display functions
+template <class Num, class Den> ostream& operator<<(ostream& os, const basic_Vrep<Num, Den>& vrep);
+template <class Num, class Den> ostream& operator<<(ostream& os, const basic_Hrep<Num, Den>& hrep);
+
 
 /* The following defines a V-representation of a polytope. */
-class Vrep {
+template <class Num, class Den> class basic_Vrep {
 	public:
+		typedef basic_fraction<Num, Den> fraction_type;
+		typedef basic_ratmatrix<Num, Den> matrix_type;
+		typedef typename den_traits<Den>::type den_type;
+		
 		/* V-representation constructors :
 		 * We accept that V-representations be constructed
 		 *  - empty,
 		 *  - from a table of integer numbers (a la lrs)
 		 *  - from two tables of numbers (for the numerator and denominators)
-		 *  - from a *.ext lrs file
+		 *  - from a ratmatrix
+		 *  - from a *.ext lrs file, a PORTA *.poi file or a binary *.poib file
 		 *  - from the variables produced by porta */
-		Vrep() : pointsAndRays(0, vector < fraction > (0, fraction())) {};
-		Vrep(const Tnum *data, const long int& nbPointsOrRays, const long int& dimension) {fill(data, nbPointsOrRays, dimension);};
-		Vrep(const Tnum *data_num, const Tden *data_den, const long int& nbPointsOrRays, const long int& dimension){fill(data_num, data_den, nbPointsOrRays, dimension);};
-		Vrep(const string& filename){fill(filename);};
+		basic_Vrep() {};
+		basic_Vrep(const Num *data, const long int& nbPointsOrRays, const long int& dimension) {fill(data, nbPointsOrRays, dimension);};
+		basic_Vrep(const Num *data_num, const den_type *data_den, const long int& nbPointsOrRays, const long int& dimension){fill(data_num, data_den, nbPointsOrRays, dimension);};
+		basic_Vrep(const matrix_type& data) : pointsAndRays(data) {};
+		basic_Vrep(const string& filename){fill(filename);};
 		
 		// Destructor :
-		virtual ~Vrep() {};
+		virtual ~basic_Vrep() {};
 		
 		// Here are the functions that fill the table with different souces of data.
-		void fill(const Tnum *data, const long int& nbPointsOrRays, const long int& dimension);
-		void fill(const Tnum *data_num, const Tden *data_den, const long int& nbPointsOrRays, const long int& dimension);
+		void fill(const Num *data, const long int& nbPointsOrRays, const long int& dimension);
+		void fill(const Num *data_num, const den_type *data_den, const long int& nbPointsOrRays, const long int& dimension);
 		void fill(const string& filename);
-		void fill(const listp* porta_list, const long int& dimension, const long int& nbEq, const long int& nbIneq);
+		void fill(const listp* plist, const long int& dimension, const long int& nbEq, const long int& nbIneq);
 
 		// The == operator
 		/* WARNING : This operator checks if the "data structure" is identical for the two representations, so it can
 		 * return false for two polytopes that are mathematically identical but listed in different orders, with additional
 		 * non-extremal points, or with points defined with a different normalization...*/
-		bool operator==(const Vrep& vrep) const;
+		bool operator==(const basic_Vrep& vrep) const;
 
 		// V-representation display (a la lrs)
-		friend ostream& operator<<(ostream& os, const Vrep& vrep);
+		friend ostream& operator<< <>(ostream& os, const basic_Vrep& vrep);
+		
+		// Writes the V-representation into a *.ext, *.poi or (any other name) binary *.poib file
+		void write(const string& filename) const;
 		
 		// This function converts to a H-representation
-		friend void VtoHrep(const Vrep& vrep, Hrep& hrep);
+		friend void VtoHrep<>(const basic_Vrep& vrep, basic_Hrep<Num, Den>& hrep);
+		friend class basic_Hull<Num, Den>;
 		
 		// Provides some useful info about the polytope
 		long int nbPointsAndRays() const;
 		long int dimension() const;
 		
+		// The points (first column 1) and rays (first column 0), one per row
+		const matrix_type& pointsAndRaysMatrix() const {return pointsAndRays;};
+		
 	protected:
-		vector < vector < fraction > > pointsAndRays;
+		matrix_type pointsAndRays;
 };
 
 
 /* The following defines an H-representation of a polytope. */
-class Hrep {
+template <class Num, class Den> class basic_Hrep {
 	public:
+		typedef basic_fraction<Num, Den> fraction_type;
+		typedef basic_ratmatrix<Num, Den> matrix_type;
+		typedef typename den_traits<Den>::type den_type;
+		
 		/* H-representation Constructors :
 		 * We accept that H-representations be constructed
 		 *  - empty,
@@ -127,65 +348,161 @@ class Hrep {
 		 *  - from two tables of integers representing numerator and denominators of inequalities coefficients
 		 *  - from two tables of integer numbers for inequalities and equalities
 		 *  - from four tables of numbers for the numerator and denominators of inequalities and equalities coefficients
-		 *  - from a *.ine lrs file
+		 *  - from two ratmatrix, for the equalities and for the inequalities
+		 *  - from a *.ine lrs file, a PORTA *.ieq file or a binary *.ieqb file
 		 *  - from the variables produced by porta */
-		Hrep() : equalities(0, vector < fraction > (0, fraction())), inequalities(0, vector < fraction > (0, fraction())), validPoint(0, fraction()) {};
-		Hrep(const Tnum *dataIneq, const long int& nbIneq, const long int& dimension) {fill(dataIneq, nbIneq, dimension);};
-		Hrep(const Tnum *dataIneq_num, const Tden *dataIneq_den, const long int& nbIneq, const long int& dimension) {fill(dataIneq_num, dataIneq_den, nbIneq, dimension);};
-		Hrep(const Tnum *dataEq, const long int& nbEq, const Tnum *dataIneq, const long int& nbIneq, const long int& dimension)
+		basic_Hrep() : validPoint(0, fraction_type()) {};
+		basic_Hrep(const Num *dataIneq, const long int& nbIneq, const long int& dimension) {fill(dataIneq, nbIneq, dimension);};
+		basic_Hrep(const Num *dataIneq_num, const den_type *dataIneq_den, const long int& nbIneq, const long int& dimension) {fill(dataIneq_num, dataIneq_den, nbIneq, dimension);};
+		basic_Hrep(const Num *dataEq, const long int& nbEq, const Num *dataIneq, const long int& nbIneq, const long int& dimension)
 			{fill(dataEq, nbEq, dataIneq, nbIneq, dimension);};
-		Hrep(const Tnum *dataEq_num, const Tden *dataEq_den, const long int& nbEq, const Tnum *dataIneq_num, const Tden *dataIneq_den, const long int& nbIneq, const long int& dimension)
+		basic_Hrep(const Num *dataEq_num, const den_type *dataEq_den, const long int& nbEq, const Num *dataIneq_num, const den_type *dataIneq_den, const long int& nbIneq, const long int& dimension)
 			{fill(dataEq_num, dataEq_den, nbEq, dataIneq_num, dataIneq_den, nbIneq, dimension);};
-		Hrep(const string &filename) {fill(filename);};
-		Hrep(const listp* porta_list, const long int& dimension, const long int& nbEq, const long int& nbIneq, const int* indx)
-			{fill(porta_list, dimension, nbEq, nbIneq, indx);};
+		basic_Hrep(const matrix_type& eqs, const matrix_type& ieqs) {fill(eqs, ieqs);};
+		basic_Hrep(const string &filename) {fill(filename);};
+		basic_Hrep(const listp* plist, const long int& dimension, const long int& nbEq, const long int& nbIneq, const int* indx)
+			{fill(plist, dimension, nbEq, nbIneq, indx);};
 		
 		// Destructor
-		virtual ~Hrep() {};
+		virtual ~basic_Hrep() {};
 
 		// These functions fill the content of the table with data of given form
-		void fill(const Tnum *dataIneq, const long int& nbIneq, const long int& dimension);
-		void fill(const Tnum *dataIneq_num, const Tden *dataIneq_den, const long int& nbIneq, const long int& dimension);
-		void fill(const Tnum *dataEq, const long int& nbEq, const Tnum *dataIneq, const long int& nbIneq, const long int& dimension);
-		void fill(const Tnum *dataEq_num, const Tden *dataEq_den, const long int& nbEq, const Tnum *dataIneq_num, const Tden *dataIneq_den, const long int& nbIneq, const long int& dimension);
+		void fill(const Num *dataIneq, const long int& nbIneq, const long int& dimension);
+		void fill(const Num *dataIneq_num, const den_type *dataIneq_den, const long int& nbIneq, const long int& dimension);
+		void fill(const Num *dataEq, const long int& nbEq, const Num *dataIneq, const long int& nbIneq, const long int& dimension);
+		void fill(const Num *dataEq_num, const den_type *dataEq_den, const long int& nbEq, const Num *dataIneq_num, const den_type *dataIneq_den, const long int& nbIneq, const long int& dimension);
+		void fill(const matrix_type& eqs, const matrix_type& ieqs);
 		void fill(const string& filename);
-		void fill(const listp* porta_list, const long int& dimension, const long int& nbEq, const long int& nbIneq, const int* indx);
+		void fill(const listp* plist, const long int& dimension, const long int& nbEq, const long int& nbIneq, const int* indx);
 		
 		// The == operator
 		/* WARNING : This operator checks if the "data structure" is identical for the two representations, so it can
 		 * return false for two polytopes that are mathematically identical but with inequalities listed in different orders,
 		 * with redundant inequalities, inequalities defined with a different normalization...*/
-		bool operator==(const Hrep& hrep) const;
+		bool operator==(const basic_Hrep& hrep) const;
 		
 		// H-representation display (a la lrs)
-		friend ostream& operator<<(ostream& os, const Hrep& hrep);
+		friend ostream& operator<< <>(ostream& os, const basic_Hrep& hrep);
+		
+		// Writes the H-representation into a *.ine, *.ieq or (any other name) binary *.ieqb file
+		void write(const string& filename) const;
 		
 		// This function converts to a V-representation
-		friend void HtoVrep(const Hrep& hrep, Vrep& vrep);
+		friend void HtoVrep<>(const basic_Hrep& hrep, basic_Vrep<Num, Den>& vrep);
+		friend class basic_Hull<Num, Den>;
 
 		// Provides some useful info about the polytope
 		long int nbEqualities() const;
 		long int nbInequalities() const;
 		long int dimension() const;
+		
+		// The constraints b + a x == 0 and b + a x >= 0, one per row (b in the first column)
+		const matrix_type& equalitiesMatrix() const {return equalities;};
+		const matrix_type& inequalitiesMatrix() const {return inequalities;};
 
 	protected:
 		// This function tests if the validPoint satisfies all current constraints
 		void checkValidPoint() const;
 	
-		vector < vector < fraction > > equalities;
-		vector < vector < fraction > > inequalities;
-		vector < fraction > validPoint;
+		matrix_type equalities;
+		matrix_type inequalities;
+		vector < fraction_type > validPoint;
+};
+
+
+/* The convex hull of a growing set of points : the H-representation is
+ * computed once by VtoHrep(), and then updated as points are added. Each
+ * facet keeps the points lying on it, and a new point only combines the
+ * facets it sees with their neighbours (a step of the double description
+ * method), in time proportional to the number of facets. As long as the
+ * hull is not full-dimensional, or if rays are added, it is computed again
+ * by VtoHrep(). The facets are kept with primitive integral coefficients. */
+template <class Num, class Den> class basic_Hull {
+	public:
+		typedef basic_ratmatrix<Num, Den> matrix_type;
+		
+		basic_Hull() : incremental(false) {};
+		basic_Hull(const basic_Vrep<Num, Den>& vrep) {fill(vrep);};
+		
+		virtual ~basic_Hull() {};
+		
+		// Computes the hull of the points and rays of vrep
+		void fill(const basic_Vrep<Num, Den>& vrep);
+		
+		// Adds points (first column 1) and rays (first column 0), one per row, to the hull
+		void add(const matrix_type& rows);
+		
+		// The points and rays added so far, and the facets of their hull
+		const basic_Vrep<Num, Den>& vrep() const {return generators;};
+		const basic_Hrep<Num, Den>& hrep() const {return facets;};
+		
+	protected:
+		// Adds the k-th point of the generators to the facets, false if it needs a full conversion
+		bool addGenerator(long int k);
+		
+		basic_Vrep<Num, Den> generators;
+		basic_Hrep<Num, Den> facets;
+		vector < vector < long int > > incidences; // The generators on each facet, in increasing order
+		bool incremental; // Whether the facets can be updated
 };
 
 
+/* The usual instantiations : coefficients are fractions of a Tnum and a
+ * Tden, which porta takes over as they are (its integer arithmetic). */
+typedef basic_fraction<Tnum, Tden> fraction;
+typedef basic_fraction_ref<Tnum, Tden> fraction_ref;
+typedef basic_const_ratrow<Tnum, Tden> const_ratrow;
+typedef basic_ratrow<Tnum, Tden> ratrow;
+typedef basic_ratmatrix<Tnum, Tden> ratmatrix;
+typedef basic_Vrep<Tnum, Tden> Vrep;
+typedef basic_Hrep<Tnum, Tden> Hrep;
+typedef basic_Hull<Tnum, Tden> Hull;
+
+/* Integral coefficients, without denominators : half the memory, for the
+ * polytopes whose points or inequalities are integral (an integral Vrep 
+ * can not hold the fractional vertices HtoVrep may find) */
+typedef basic_ratmatrix<Tnum, void> intmatrix;
+typedef basic_Vrep<Tnum, void> intVrep;
+typedef basic_Hrep<Tnum, void> intHrep;
+typedef basic_Hull<Tnum, void> intHull;
+
+/* 128-bit coefficients. Types wider than Tnum and Tden make porta compute
+ * in multiple precision, as its option -l does, so that the coefficients 
+ * beyond Tnum and Tden go through the library in both directions. Another
+ * (arbitrary precision) type needs a specialization of porta_number and 
+ * its instantiations at the end of libporta.cpp. */
+#ifdef __SIZEOF_INT128__
+typedef basic_ratmatrix<__int128, __int128> ratmatrix128;
+typedef basic_Vrep<__int128, __int128> Vrep128;
+typedef basic_Hrep<__int128, __int128> Hrep128;
+typedef basic_Hull<__int128, __int128> Hull128;
+typedef basic_ratmatrix<__int128, void> intmatrix128;
+typedef basic_Vrep<__int128, void> intVrep128;
+typedef basic_Hrep<__int128, void> intHrep128;
+typedef basic_Hull<__int128, void> intHull128;
+#endif
+
 
 /* The following added by J-D Bancal on 22.2.2012 to call porta as a c library. */
 //extern void quick_and_dirty_poi_conv_call(long int *, int, int);
 
 
-// Definition of the display functions
-extern ostream& operator<<(ostream& os, const Vrep& vrep);
-extern ostream& operator<<(ostream& os, const Hrep& hrep);
+/* The conversions keep their results in a cache in "directory", of at
+ * most "megabytes" megabytes (0 turns the cache off, as it is at first).
+ * A polytope converted before, also with its rows in another order, 
+ * repeated or multiplied by positive numbers (except the points of a 
+ * V-representation), is then read from the cache. See cache.h. */
+void setResultCache(const string& directory = CACHE_DIR, const long int& megabytes = CACHE_DEFAULT_MB);
+
+
+/* Batch conversions: the i-th result is the conversion of the i-th input.
+ * The conversions run in parallel on nbThreads threads (0: as many as
+ * OpenMP offers) and share the log file porta.log. An error of porta 
+ * (which ends the program in a single conversion) only stops the conversion
+ * it occurs in: the i-th string returned is the message of the error of
+ * the i-th conversion, whose result is then empty, or "" if it succeeded. */
+template <class Num, class Den> vector<string> VtoHrep(const vector< basic_Vrep<Num, Den> >& vreps, vector< basic_Hrep<Num, Den> >& hreps, int nbThreads = 0);
+template <class Num, class Den> vector<string> HtoVrep(const vector< basic_Hrep<Num, Den> >& hreps, vector< basic_Vrep<Num, Den> >& vreps, int nbThreads = 0);
 
 
 
@@ -32,10 +32,12 @@ REVISED BY ANDREAS LOEBEL
 /* $Id: log.c,v 1.2 2009/09/21 07:05:11 bzfloebe Exp $ */
 
 
+#include "porta.h"
 #include "log.h"
+#include "porta_ctx.h"
 
 
-int porta_log( char *fmt, ... )
+int porta_log( const char *fmt, ... )
 {
     va_list argp;
     int ret;
@@ -40,8 +40,7 @@ REVISED BY ANDREAS LOEBEL
 #include <stdlib.h>
 #include <stdarg.h>
 
-extern FILE *logfile;
-extern int porta_log( char *, ... );
+extern int porta_log( const char *, ... );
 
 
 #endif // _LOG_H
@@ -35,6 +35,7 @@ REVISED BY ANDREAS LOEBEL
 #include "common.h"
 #include "mp.h"
 #include "largecalc.h"
+#include "porta_ctx.h"
 
 
 // Note by J-D B: The following conditions maybe could be revised in view of long int and long long int data types...
@@ -79,6 +80,7 @@ void arith_overflow_func( int cf, void (*call_func)(), RAT a, RAT b, RAT *c )
     RAT_to_L_RAT(ar1,nel_ar1);
     RAT_to_L_RAT(ar2,nel_ar2);
     RAT_to_L_RAT(ar3,nel_ar3);
+    sys_chunks_to_L_RAT();
     RAT_to_L_RAT(ar4,nel_ar4);
     RAT_to_L_RAT(ar5,nel_ar5);
     RAT_to_L_RAT(ar6,nel_ar6);
@@ -505,35 +507,18 @@ void L_RAT_kue( loint *x, loint *y )
 
 
 loint lgcdrow( loint *x, int m )
+/*
+ * gcd of the positive numbers x[0..m].
+ */
 {
 
-  int im;
-  loint r,q;
-
-  while (m > 0) {
+  int i;
+  loint g;
 
-    porta_ldiv(x[0],x[1],&q,&r);
-    if (r.len > 1 || (r.len == 1 && r.val[0] > 1)) {
-      x[0] = x[1];
-      for(im = 1; im < m && lord(x[im+1],r) > 0; im++)
-        x[im] = x[im+1];
-      if (m > 1 && im < m && !lord(x[im+1],r)) {
-        for (;im < m; im++) 
-          x[im] = x[im+1];
-        m--;
-      }
-      else
-        x[im] = r;
-    }
-    else if (r.len == 0) {
-      for(im = 0; im < m; im++)
-        x[im] = x[im+1];
-      m--;
-    }
-    else return(r);
-  }
+  for (g = x[0], i = 1; i <= m && (g.len > 1 || g.val[0] != 1); i++)
+    lgcd(g,x[i],&g);
 
-  return(x[0]);
+  return(g);
 
 }
 
@@ -548,7 +533,7 @@ void L_RAT_row_prim( RAT *old, RAT *new, RAT *p, int n )
 {
   RAT rgcd, *pold;
   loint *x,r;
-  int m=0,ii,i,j;
+  int m=0,i,j;
   lorat lgcd;
 
   x = (loint *) allo(CP NULL,0,U n*sizeof(loint));
@@ -581,16 +566,7 @@ void L_RAT_row_prim( RAT *old, RAT *new, RAT *p, int n )
               break;
           }
           else if (r.len ) 
-          {
-              for (i = 0; i != m && lord(r,x[i]) < 0; i++); 
-              if (lord(r,x[i]) || i == m) 
-              {
-                  for (ii = m; ii > i; ii--) 
-                      x[ii] = x[ii-1];
-                  x[i] = r;
-                  m++;
-              }
-          }
+              x[m++] = r;
       }
       m--;
       if (!lgcd.den.len ) lgcd.den = lgcdrow(x,m);
@@ -609,16 +585,7 @@ void L_RAT_row_prim( RAT *old, RAT *new, RAT *p, int n )
                   break;
               }
               else 
-              {
-                  for (i = 0; i != m && lord(r,x[i]) < 0; i++); 
-                  if (lord(r,x[i]) || i == m) 
-                  {
-                      for (ii = m; ii > i; ii--) 
-                          x[ii] = x[ii-1];
-                      x[i] = r;
-                      m++;
-                  }
-              }
+                  x[m++] = r;
           }
       }
       m--;
@@ -766,7 +733,7 @@ int L_RAT_no_denom( int sysrow, int first, int last, int outmsg )
         porta_log( "\n");
     }   
     
-    free(denom);
+    allo(CP denom,U sysrow*sizeof(intDenom),0);
 
     return(ret);
     
@@ -774,41 +741,41 @@ int L_RAT_no_denom( int sysrow, int first, int last, int outmsg )
 
 
 
-void hexprint( FILE *fp, loint lx )
+void hexprint( FILE *ofp, loint lx )
 {
     int i;
     
     if (!lx.len)
-        fprintf(fp,"0");
+        fprintf(ofp,"0");
     else  {
     if (lx.neg)
-        fprintf(fp,"-");
+        fprintf(ofp,"-");
     if (lx.len == 1 && !(lx.val[0] & m_31))
-        fprintf(fp,"%u",lx.val[0]);
+        fprintf(ofp,"%u",lx.val[0]);
     else {
-    fprintf(fp,"(hex)");
+    fprintf(ofp,"(hex)");
     for(i = lx.len-1; i >= 0; i--)
-        fprintf(fp,"%x%x%x",15&(lx.val[i]>>8),15&(lx.val[i]>>4),15&(lx.val[i]));
+        fprintf(ofp,"%x%x%x",15&(lx.val[i]>>8),15&(lx.val[i]>>4),15&(lx.val[i]));
 }
 }
 }
 
 
-void hexprintWithOppositeSign( FILE *fp, loint lx )
+void hexprintWithOppositeSign( FILE *ofp, loint lx )
 {
     int i;
     
     if (!lx.len)
-        fprintf(fp,"0");
+        fprintf(ofp,"0");
     else  {
     if (!lx.neg)
-        fprintf(fp,"-");
+        fprintf(ofp,"-");
     if (lx.len == 1 && !(lx.val[0] & m_31))
-        fprintf(fp,"%u",lx.val[0]);
+        fprintf(ofp,"%u",lx.val[0]);
     else {
-    fprintf(fp,"(hex)");
+    fprintf(ofp,"(hex)");
     for(i = lx.len-1; i >= 0; i--)
-        fprintf(fp,"%x%x%x",15&(lx.val[i]>>8),15&(lx.val[i]>>4),15&(lx.val[i]));
+        fprintf(ofp,"%x%x%x",15&(lx.val[i]>>8),15&(lx.val[i]>>4),15&(lx.val[i]));
 }
 }
 }
@@ -859,7 +826,7 @@ void size_info( RAT *x, int *nz, int *ld )
 
 
 
-void L_RAT_writeline( FILE *fp, int rowl, RAT *ptr, int format, RAT* max, char eqie, int *indx )
+void L_RAT_writeline( FILE *ofp, int rowl, RAT *ptr, int format, RAT* max, char eqie, int *indx )
 {
     int j;
     lorat x;
@@ -871,35 +838,35 @@ void L_RAT_writeline( FILE *fp, int rowl, RAT *ptr, int format, RAT* max, char e
 		for ( j = 0; j < rowl;ptr++,j++) 
 		{
 		    if (j == rowl-1 && !format)
-		        fprintf(fp," %c= ",eqie);
+		        fprintf(ofp," %c= ",eqie);
 		    if (!ptr->num && (format || (!format && j == rowl-1)))
-		        fprintf(fp,"0");
+		        fprintf(ofp,"0");
 		    else if (ptr->num && vals_lt_MAXINT(ptr,1)) 
 		    {
 		        if (ptr->num < 0)
-		            fprintf(fp,"-");
+		            fprintf(ofp,"-");
 		        else if (ptr->num > 0 && ! format)
-		            fprintf(fp,"+");
-		        fprintf(fp,"%u",ptr->den.p[0]);
+		            fprintf(ofp,"+");
+		        fprintf(ofp,"%u",ptr->den.p[0]);
 		        if ( ptr->den.p[1] > 1) 
-		            fprintf(fp,"/%u",ptr->den.p[1]);
+		            fprintf(ofp,"/%u",ptr->den.p[1]);
 		    }       
 		    else  if (ptr->num) 
 		    {
 		        L_RAT_to_lorat(*ptr,&x);
 		        if (ptr->num > 0 && ! format)
-		            fprintf(fp,"+");
-		        hexprint(fp,x.num);
+		            fprintf(ofp,"+");
+		        hexprint(ofp,x.num);
 		        if (x.den.len > 1 || x.den.val[0] > 1) 
 		        {
-		            fprintf(fp,"/");
-		            hexprint(fp,x.den);
+		            fprintf(ofp,"/");
+		            hexprint(ofp,x.den);
 		        }  
 		    }
 		    if (format)
-		        fprintf(fp," ");
+		        fprintf(ofp," ");
 		    else if (j != rowl-1 && ptr->num)
-		        fprintf(fp,"x%i",(indx)?(indx[j]+1):j+1);        
+		        fprintf(ofp,"x%i",(indx)?(indx[j]+1):j+1);        
 		}
 	else // Now we define the new table format
 	{
@@ -907,26 +874,26 @@ void L_RAT_writeline( FILE *fp, int rowl, RAT *ptr, int format, RAT* max, char e
 		for ( j = 0; j < rowl-1;ptr++,j++) {};
 
 	    if (!ptr->num)
-	        fprintf(fp,"0");
+	        fprintf(ofp,"0");
 	    else if (ptr->num && vals_lt_MAXINT(ptr,1)) 
 	    {
 	        if (ptr->num < 0)
-	            fprintf(fp,"-");
-	        fprintf(fp,"%u",ptr->den.p[0]);
+	            fprintf(ofp,"-");
+	        fprintf(ofp,"%u",ptr->den.p[0]);
 	        if ( ptr->den.p[1] > 1) 
-	            fprintf(fp,"/%u",ptr->den.p[1]);
+	            fprintf(ofp,"/%u",ptr->den.p[1]);
 	    }       
 	    else  if (ptr->num) 
 	    {
 	        L_RAT_to_lorat(*ptr,&x);
-	        hexprint(fp,x.num);
+	        hexprint(ofp,x.num);
 	        if (x.den.len > 1 || x.den.val[0] > 1) 
 	        {
-	            fprintf(fp,"/");
-	            hexprint(fp,x.den);
+	            fprintf(ofp,"/");
+	            hexprint(ofp,x.den);
 	        }  
 	    }
-        fprintf(fp," ");
+        fprintf(ofp," ");
 
 		// Now we get back to the beginning of the list to obtain the coefficients...
 		for ( j = 0; j < rowl-1;ptr--,j++) {};
@@ -934,28 +901,28 @@ void L_RAT_writeline( FILE *fp, int rowl, RAT *ptr, int format, RAT* max, char e
 		for ( j = 0; j < rowl-1;ptr++,j++) 
 		{
 		    if (!ptr->num)
-		        fprintf(fp,"0");
+		        fprintf(ofp,"0");
 		    else if (ptr->num && vals_lt_MAXINT(ptr,1)) 
 		    {
 //				fprintf(prt, "1");
 		        if (-(ptr->num) < 0)
-		            fprintf(fp,"-");
-		        fprintf(fp,"%u",ptr->den.p[0]);
+		            fprintf(ofp,"-");
+		        fprintf(ofp,"%u",ptr->den.p[0]);
 		        if ( ptr->den.p[1] > 1) 
-		            fprintf(fp,"/%u",ptr->den.p[1]);
+		            fprintf(ofp,"/%u",ptr->den.p[1]);
 		    }       
 		    else  if (ptr->num) 
 		    {
 //				fprintf(prt, "2");
 		        L_RAT_to_lorat(*ptr,&x);
-		        hexprintWithOppositeSign(fp,x.num);
+		        hexprintWithOppositeSign(ofp,x.num);
 		        if (x.den.len > 1 || x.den.val[0] > 1) 
 		        {
-		            fprintf(fp,"/");
-		            hexprint(fp,x.den);
+		            fprintf(ofp,"/");
+		            hexprint(ofp,x.den);
 		        }  
 		    }
-	        fprintf(fp," ");
+	        fprintf(ofp," ");
 		}
 		ptr++; j++;
 	}
@@ -963,3 +930,443 @@ void L_RAT_writeline( FILE *fp, int rowl, RAT *ptr, int format, RAT* max, char e
 
 
 
+
+
+
+
+
+
+
+
+
+/*
+ * Multi-modular computation of the final products of the
+ * Fourier-Motzkin elimination (option -m, long integer arithmetic).
+ * Only these products are reduced modulo the primes; the elimination
+ * before them runs in long integer arithmetic.
+ *
+ * For each row with multipliers n_k/d_k and each column with entries
+ * m_kj/e_kj the integer X_j = sum_k n_k*(D/d_k) * m_kj*(E_j/e_kj),
+ * D = lcm(d_k), E_j = lcm_k(e_kj), is computed modulo up to MOD_PRIMES
+ * word-size primes and reconstructed by the chinese remainder theorem.
+ * The product is then X_j/(D*E_j). Rows are done in chunks of MOD_CHUNK
+ * in parallel; rows that do not fit are left to vecpr().
+ */
+
+#define MOD_WORDS  7
+#define MOD_CHUNK  4096
+
+static const unsigned mod_prime[MOD_PRIMES] = 
+{ 2147483647U, 2147483629U, 2147483587U, 2147483579U, 
+  2147483563U, 2147483549U, 2147483543U, 2147483497U };
+
+#define mod_pinv (porta_cur->mod_pinv)
+
+#define modv (porta_cur->modv)
+
+
+
+static unsigned mulmod( unsigned a, unsigned b, unsigned p )
+{
+    return((unsigned) (((unsigned long long) a*b) % p));
+}
+
+
+
+static unsigned powmod( unsigned a, unsigned e, unsigned p )
+{
+    unsigned r = 1;
+    
+    for (; e; e >>= 1, a = mulmod(a,a,p))
+        if (e & 1) r = mulmod(r,a,p);
+    return(r);
+}
+
+
+
+static unsigned lmod( loint *a, unsigned p )
+/* |a| mod p */
+{
+    unsigned long long r = 0;
+    int i;
+    
+    for (i = a->len-1; i >= 0; i--)
+        r = ((r << 12) | a->val[i]) % p;
+    return((unsigned) r);
+}
+
+
+
+static int lbits( loint *a )
+{
+    return(a->len ? (a->len-1)*12 + 32 - __builtin_clz(a->val[a->len-1]) : 0);
+}
+
+
+
+static int llcm( loint *D, loint *d )
+/* D = lcm(D,d), returns 0 if the result may not fit */
+{
+    loint g,q,r;
+    
+    if (d->len == 1 && d->val[0] == 1)
+        return(1);
+    lgcd(*D,*d,&g);
+    porta_ldiv(*D,g,&q,&r);
+    if (q.len+d->len > MAX_LEN_LINT-4)
+        return(0);
+    lmul(q,*d,D);
+    D->neg = 0;
+    return(1);
+}
+
+
+
+static void mod_chunk( int first )
+/*
+ * Residues and chinese remaindering for the rows first .. first+MOD_CHUNK-1.
+ */
+{
+    int last;
+    long i;
+    
+    last = (first+MOD_CHUNK < modv.nrows) ? first+MOD_CHUNK : modv.nrows;
+    modv.first = first;
+    modv.last = last;
+    
+#pragma omp parallel for schedule(dynamic,16) copyin(porta_cur)
+    for (i = first; i < last; i++) 
+    {
+        RAT *lam = porta_list[i]->sys+1;
+        unsigned pw[MOD_PRIMES],v[MOD_PRIMES],Y[MOD_WORDS+1],*res,*wk,t,c;
+        unsigned long long acc,car;
+        loint *D = modv.D+(i-first);
+        lorat x;
+        int j,k,q,s,np,nw,B,ok,*tb,*cb;
+        
+        ok = 1;
+        D->len = D->val[0] = 1; D->neg = 0;
+        for (k = 0; k < modv.n && ok; k++)
+            if (lam[k].num) 
+            {
+                L_RAT_to_lorat(lam[k],&x);
+                ok = llcm(D,&x.den);
+            }
+        if (!ok || D->len+modv.E[modv.ncols].len > MAX_LEN_LINT-2) 
+        {
+            modv.ok[i-first] = 0;
+            continue;
+        }
+        
+        /* 
+         * Bit bounds of the terms n_k*D/d_k, and of X_j + 2^B
+         */
+        tb = (int *) allo(CP 0,0,U modv.n*sizeof(int));
+        for (k = 0; k < modv.n; k++)
+            if (!lam[k].num)
+                tb[k] = -1;
+            else 
+            {
+                L_RAT_to_lorat(lam[k],&x);
+                tb[k] = lbits(&x.num)+lbits(D)-lbits(&x.den)+1;
+            }
+        for (B = 0, j = 0; j < modv.ncols; j++)
+            for (k = 0, cb = modv.cb+j*modv.n; k < modv.n; k++)
+                if (tb[k] >= 0 && cb[k] >= 0 && tb[k]+cb[k] > B)
+                    B = tb[k]+cb[k];
+        allo(CP tb,U modv.n*sizeof(int),0);
+        for (k = modv.n; k; k >>= 1, B++);
+        if (B > MOD_WORDS*32-1) 
+        {
+            modv.ok[i-first] = 0;
+            continue;
+        }
+        np = (B+2)/30 + 1;
+        if (np > MOD_PRIMES) np = MOD_PRIMES;
+        for (q = 0; q < np; q++)
+            pw[q] = powmod(2,B,mod_prime[q]);
+        
+        /* weights n_k*D/d_k modulo the primes */
+        wk = (unsigned *) allo(CP 0,0,U modv.n*MOD_PRIMES*sizeof(unsigned));
+        for (k = 0; k < modv.n && ok; k++)
+            if (!lam[k].num)
+                for (q = 0; q < np; q++) wk[k*MOD_PRIMES+q] = 0;
+            else 
+            {
+                L_RAT_to_lorat(lam[k],&x);
+                for (q = 0; q < np; q++) 
+                {
+                    t = mulmod(lmod(&x.num,mod_prime[q]),lmod(D,mod_prime[q]),mod_prime[q]);
+                    if (x.den.len > 1 || x.den.val[0] != 1) 
+                    {
+                        if (!(c = lmod(&x.den,mod_prime[q]))) ok = 0;
+                        t = mulmod(t,powmod(c,mod_prime[q]-2,mod_prime[q]),mod_prime[q]);
+                    }
+                    wk[k*MOD_PRIMES+q] = (x.num.neg && t) ? mod_prime[q]-t : t;
+                }
+            }
+        
+        for (j = 0; j < modv.ncols && ok; j++) 
+        {
+            res = modv.res+((i-first)*modv.ncols+j)*(MOD_WORDS+1);
+            
+            /* residues of X_j + 2^B, Garner's mixed radix digits */
+            for (q = 0; q < np; q++) 
+            {
+                unsigned *cr = modv.colres+(j*modv.n)*MOD_PRIMES+q;
+                for (acc = 0, k = 0; k < modv.n; k++, cr += MOD_PRIMES)
+                    acc += ((unsigned long long) wk[k*MOD_PRIMES+q] * *cr) % mod_prime[q];
+                t = (acc + pw[q]) % mod_prime[q];
+                for (s = 0; s < q; s++)
+                    t = mulmod((t+mod_prime[q]-v[s]%mod_prime[q])%mod_prime[q],mod_pinv[s][q],mod_prime[q]);
+                v[q] = t;
+            }
+            
+            /* Y = v[0] + p[0]*(v[1] + p[1]*(v[2] + ...)) */
+            for (s = 0; s <= MOD_WORDS; s++) Y[s] = 0;
+            Y[0] = v[np-1];
+            for (q = np-2; q >= 0; q--)
+                for (car = v[q], s = 0; s <= MOD_WORDS; s++) 
+                {
+                    car += (unsigned long long) Y[s]*mod_prime[q];
+                    Y[s] = (unsigned) car;
+                    car >>= 32;
+                }
+            
+            /* X_j = Y - 2^B */
+            nw = B/32+1;
+            if (Y[B/32] & (1U << (B%32))) 
+            {
+                Y[B/32] &= ~(1U << (B%32));
+                res[0] = 0;
+            }
+            else 
+            {
+                for (car = 1, s = 0; s < nw; s++) 
+                {
+                    car += (unsigned) ~Y[s];
+                    Y[s] = (unsigned) car;
+                    car >>= 32;
+                }
+                Y[B/32] &= (1U << (B%32))-1;
+                res[0] = 1 << 16;
+            }
+            for (; nw && !Y[nw-1]; nw--);
+            res[0] = nw ? res[0] | nw : 0;
+            for (s = 0; s < nw; s++)
+                res[s+1] = Y[s];
+        }
+        allo(CP wk,U modv.n*MOD_PRIMES*sizeof(unsigned),0);
+        modv.ok[i-first] = ok;
+    }
+}
+
+
+
+int L_RAT_mod_init( RAT *cols, int *ord, int n, int ncols, int nrows )
+/*
+ * Prepare the multi-modular products of porta_list[0..nrows-1]->sys+1
+ * with the ncols columns cols+n*ord[j] (cols+n*j, if ord == 0)
+ * of length n. Returns 0 if the columns can not be treated.
+ */
+{
+    int j,k,q;
+    unsigned t,c;
+    RAT *col;
+    lorat x;
+    
+    for (q = 0; q < MOD_PRIMES; q++)
+        for (k = 0; k < MOD_PRIMES; k++)
+            if (k != q)
+                mod_pinv[q][k] = powmod(mod_prime[q]%mod_prime[k],mod_prime[k]-2,mod_prime[k]);
+    
+    modv.cols = cols; modv.ord = ord; modv.n = n;
+    modv.ncols = ncols; modv.nrows = nrows;
+    modv.first = modv.last = modv.done = 0;
+    modv.colres = UP allo(CP 0,0,U ncols*n*MOD_PRIMES*sizeof(unsigned));
+    modv.E = (loint *) allo(CP 0,0,U (ncols+1)*sizeof(loint));
+    modv.cb = (int *) allo(CP 0,0,U ncols*n*sizeof(int));
+    
+    /* 
+     * E_j (the largest one is stored in E[ncols]), and bit bounds 
+     * of the terms m_kj*E_j/e_kj
+     */
+    modv.E[ncols].len = modv.E[ncols].val[0] = 1; modv.E[ncols].neg = 0;
+    for (j = 0; j < ncols; j++) 
+    {
+        col = cols+n*((ord)?ord[j]:j);
+        modv.E[j].len = modv.E[j].val[0] = 1; modv.E[j].neg = 0;
+        for (k = 0; k < n; k++) 
+            if (col[k].num) 
+            {
+                L_RAT_to_lorat(col[k],&x);
+                if (!llcm(modv.E+j,&x.den))
+                    goto fail;
+            }
+        if (lord(modv.E[j],modv.E[ncols]) > 0)
+            modv.E[ncols] = modv.E[j];
+        for (k = 0; k < n; k++) 
+            if (!col[k].num)
+                modv.cb[j*n+k] = -1;
+            else 
+            {
+                L_RAT_to_lorat(col[k],&x);
+                modv.cb[j*n+k] = lbits(&x.num)+lbits(modv.E+j)-lbits(&x.den)+1;
+            }
+        
+        for (k = 0; k < n; k++)
+            for (q = 0; q < MOD_PRIMES; q++) 
+            {
+                if (!col[k].num) 
+                {
+                    modv.colres[(j*n+k)*MOD_PRIMES+q] = 0;
+                    continue;
+                }
+                L_RAT_to_lorat(col[k],&x);
+                t = mulmod(lmod(&x.num,mod_prime[q]),lmod(modv.E+j,mod_prime[q]),mod_prime[q]);
+                if (x.den.len > 1 || x.den.val[0] != 1) 
+                {
+                    if (!(c = lmod(&x.den,mod_prime[q])))
+                        goto fail;
+                    t = mulmod(t,powmod(c,mod_prime[q]-2,mod_prime[q]),mod_prime[q]);
+                }
+                modv.colres[(j*n+k)*MOD_PRIMES+q] = (x.num.neg && t) ? mod_prime[q]-t : t;
+            }
+    }
+    
+    modv.res = UP allo(CP 0,0,U MOD_CHUNK*ncols*(MOD_WORDS+1)*sizeof(unsigned));
+    modv.D = (loint *) allo(CP 0,0,U MOD_CHUNK*sizeof(loint));
+    modv.ok = allo(CP 0,0,U MOD_CHUNK);
+    return(1);
+    
+ fail:
+    allo(CP modv.colres,U ncols*n*MOD_PRIMES*sizeof(unsigned),0);
+    allo(CP modv.E,U (ncols+1)*sizeof(loint),0);
+    allo(CP modv.cb,U ncols*n*sizeof(int),0);
+    return(0);
+}
+
+
+
+int L_RAT_mod_vecpr( int i, RAT *out )
+/*
+ * Store the products of row i (rows are asked for in increasing order) 
+ * with the columns in out[0..ncols-1]. Returns 0 if the row was 
+ * not computed, out is not changed then.
+ */
+{
+    unsigned *res;
+    lorat lc;
+    int j;
+    
+    if (i >= modv.last)
+        mod_chunk(i);
+    if (!modv.ok[i-modv.first])
+        return(0);
+    
+    for (j = 0; j < modv.ncols; j++) 
+    {
+        res = modv.res+((i-modv.first)*modv.ncols+j)*(MOD_WORDS+1);
+        if (!(res[0] & 0xffff)) 
+        {
+            L_RAT_assign(out+j,RAT_const);
+            continue;
+        }
+        expand(res+1,res[0] & 0xffff,&lc.num);
+        lc.num.neg = res[0] >> 16;
+        lmul(modv.D[i-modv.first],modv.E[j],&lc.den);
+        lc.den.neg = 0;
+        if (lc.den.len > 1 || lc.den.val[0] != 1)
+            L_RAT_kue(&lc.num,&lc.den);
+        lorat_to_L_RAT(lc,out+j);
+    }
+    modv.done++;
+    
+    return(1);
+}
+
+
+
+int L_RAT_mod( RAT a, unsigned p, unsigned *r )
+/*
+ * *r = a mod p (p prime, a in mp-format). 
+ * Returns 0 if the denominator of a is divisible by p.
+ */
+{
+    lorat x;
+    unsigned c;
+    
+    *r = 0;
+    if (!a.num)
+        return(1);
+    L_RAT_to_lorat(a,&x);
+    *r = lmod(&x.num,p);
+    if (x.den.len > 1 || x.den.val[0] != 1) 
+    {
+        if (!(c = lmod(&x.den,p)))
+            return(0);
+        *r = mulmod(*r,powmod(c,p-2,p),p);
+    }
+    if (x.num.neg && *r)
+        *r = p-*r;
+    return(1);
+}
+
+
+
+int L_RAT_mod_free()
+/* returns the number of rows done by L_RAT_mod_vecpr() */
+{
+    int ncols = modv.ncols, n = modv.n;
+    
+    allo(CP modv.colres,U ncols*n*MOD_PRIMES*sizeof(unsigned),0);
+    allo(CP modv.E,U (ncols+1)*sizeof(loint),0);
+    allo(CP modv.cb,U ncols*n*sizeof(int),0);
+    allo(CP modv.res,U MOD_CHUNK*ncols*(MOD_WORDS+1)*sizeof(unsigned),0);
+    allo(CP modv.D,U MOD_CHUNK*sizeof(loint),0);
+    allo(modv.ok,U MOD_CHUNK,0);
+    
+    return(modv.done);
+}
+
+
+
+int L_RAT_row_int( RAT *row, int n )
+/*
+ * Make row[0..n-1] integer by multiplying it with the lcm of its
+ * denominators, as no_denom() does for RAT.
+ * Returns 0 if the result may not fit, the row is not changed then.
+ */
+{
+    lorat l,x;
+    RAT f;
+    int j;
+    
+    l.num.len = l.num.val[0] = 1;
+    l.den.len = l.den.val[0] = 1;
+    l.num.neg = l.den.neg = 0;
+    for (j = 0; j < n; j++)
+        if (row[j].num) 
+        {
+            L_RAT_to_lorat(row[j],&x);
+            if (!llcm(&l.num,&x.den))
+                return(0);
+        }
+    if (l.num.len == 1 && l.num.val[0] == 1)
+        return(1);
+    for (j = 0; j < n; j++)
+        if (row[j].num) 
+        {
+            L_RAT_to_lorat(row[j],&x);
+            if (x.num.len+l.num.len > MAX_LEN_LINT-1)
+                return(0);
+        }
+    
+    f.num = 0;
+    f.den.p = 0;
+    lorat_to_L_RAT(l,&f);
+    for (j = 0; j < n; j++)
+        L_RAT_mul(row[j],f,row+j);
+    allo(CP f.den.p,U get_len(&f)*szU,0);
+    return(1);
+}
@@ -45,6 +45,8 @@ extern void L_RAT_assign( RAT *, RAT * );
 extern void L_RAT_to_RAT( RAT *, int );
 extern int vals_lt_MAXINT( RAT *, int );
 extern void RAT_to_L_RAT( RAT *, int );
+extern void L_RAT_to_lorat( RAT, lorat * );
+extern void lorat_to_L_RAT( lorat, RAT * );
 extern void L_RAT_add( RAT, RAT, RAT * );
 extern void L_RAT_sub( RAT, RAT, RAT * );
 extern void L_RAT_mul( RAT, RAT, RAT * );
@@ -55,6 +57,11 @@ extern void L_RAT_writeline( FILE *, int, RAT *, int, RAT *, char, int * );
 extern loint lgcdrow( loint *, int );
 extern void hexprint( FILE *, loint );
 extern int return_from_mp( );
+extern int L_RAT_mod_init( RAT *, int *, int, int, int );
+extern int L_RAT_mod_vecpr( int, RAT * );
+extern int L_RAT_mod_free( );
+extern int L_RAT_mod( RAT, unsigned, unsigned * );
+extern int L_RAT_row_int( RAT *, int );
 
 
 #endif // _MP_H
@@ -45,38 +45,24 @@ REVISED BY ANDREAS LOEBEL
 #include "mp.h"
 #include "four_mot.h"
 #include "portsort.h"
+#include "porta_ctx.h"
 
 
-// The following variables were previously instanciated in the header file. Now they have been externalized here. J-D B
-int mp_state;
-
-void (*RAT_add)(),
-	 (*RAT_sub)(),
-	 (*RAT_mul)(),
-	 (*RAT_row_prim)(RAT *, RAT *, RAT *, int), // Line completed on 26.2.2013 by J-D B to be compatible with the c++ library interface portalib.cpp
-	 (*RAT_assign)(),
-	 (*writeline)();
-
-RAT RAT_const[2],var[4];
-
-RAT *ar1,*ar2,*ar3,*ar4,*ar5,*ar6;
-long nel_ar1,nel_ar2,nel_ar3,nel_ar4,nel_ar5,nel_ar6;
-
-int  maxlist, total_size;
-
-int  dim,
-     equa,    /* number of equalities */
-     ineq,    /* number of inequalities */
-     conv, 
-     cone, 
-     points,
-     blocks;
+/*
+ * The state of the computation (see struct porta_context in porta.h).
+ * The variables which used to be defined here are fields of it.
+ */
+struct porta_context porta_default;
+#if defined WIN32
+__declspec(thread) struct porta_context *porta_cur = &porta_default;
+#elif defined _OPENMP
+struct porta_context *porta_cur = &porta_default;
+#else
+__thread struct porta_context *porta_cur = &porta_default;
+#endif
 
-FILE *fp,*prt;
 char * allo();
 
-int option, allowed_options;
-
 
 
 //FILE *logfile;
@@ -484,12 +470,10 @@ int intcompare( int *i, int *j )
 
 
 
-int *elim_in;
-
 void polarformat( RAT *inieq, int *equa_in, int ineq_in, RAT *inner )
 {
     
-    int i,j,col,row,itr,pivcol,sysrow;
+    int i,j,col,row,iter,pivcol,sysrow;
     RAT *o,*n,*pivot;
     
     sysrow = dim + 2;
@@ -533,10 +517,10 @@ void polarformat( RAT *inieq, int *equa_in, int ineq_in, RAT *inner )
         for (col = 0; col < dim; col++)
             *(elim_in+col) =  col ;
         
-        for (itr = 0; itr < *equa_in; itr++) 
+        for (iter = 0; iter < *equa_in; iter++) 
         {
             
-            pivot = porta_list[itr]->sys;
+            pivot = porta_list[iter]->sys;
             for(pivcol = 0; pivcol < dim && !pivot->num; pivcol++,pivot++);
             
             if (pivcol == dim) 
@@ -545,21 +529,21 @@ void polarformat( RAT *inieq, int *equa_in, int ineq_in, RAT *inner )
                 {
                     
                     (*RAT_row_prim)(porta_list[*equa_in-1]->sys,
-                                    porta_list[itr]->sys, pivot,dim+1);
+                                    porta_list[iter]->sys, pivot,dim+1);
                     (*equa_in)--;
-                    itr--;
+                    iter--;
                     continue;
                 }
                 else
                     msg( "input equality system has no solution", "", 0 );
             }
 
-            (*RAT_row_prim)(porta_list[itr]->sys,porta_list[itr]->sys, 
+            (*RAT_row_prim)(porta_list[iter]->sys,porta_list[iter]->sys, 
                             pivot,dim+1);
             
-            for (row = itr+1; row < *equa_in+ineq_in; row++)  
-                if (row != itr) {
-                gauss_calcnewrow(porta_list[itr]->sys,porta_list[row]->sys,
+            for (row = iter+1; row < *equa_in+ineq_in; row++)  
+                if (row != iter) {
+                gauss_calcnewrow(porta_list[iter]->sys,porta_list[row]->sys,
                                  pivcol,porta_list[row]->sys,0,sysrow-1);
                 (*RAT_row_prim)(porta_list[row]->sys,porta_list[row]->sys,
                                 porta_list[row]->sys+dim,dim+1);
@@ -571,9 +555,9 @@ void polarformat( RAT *inieq, int *equa_in, int ineq_in, RAT *inner )
             porta_log( " elimination of variable %d\n", pivcol+1);
             
             for (col = 0; *(elim_in+col) != pivcol ; col++);
-            for (; col < dim-itr-1 ; col++)
+            for (; col < dim-iter-1 ; col++)
                 *(elim_in+col) = *(elim_in+col+1);
-            for (j = dim-itr-1; j < dim-1  ; j++)
+            for (j = dim-iter-1; j < dim-1  ; j++)
                 *(elim_in+j) = *(elim_in+j+1);
             *(elim_in+dim-1) = pivcol;
             
@@ -818,16 +802,10 @@ void writemat( RAT *ptr, int row, int col )
 
 
 // This function computes the GCD of two integers
-// code taken from rosettacode.org, added by J-D B on 14.4.2013.
+// added by J-D B on 14.4.2013, now uses the binary gcd of arith.c.
 long int longgcd(long int u, long int v)
 {
-	long int t;
-	while (v) {
-		t = u; 
-        u = v; 
-        v = t % v;
-	}
-    return labs(u);
+    return (long int) binary_gcd((unsigned long long) labs(u), (unsigned long long) labs(v));
 };
 
 
@@ -1060,7 +1038,7 @@ int no_denom( int sysrow, int first, int last, int outmsg )
         porta_log( "\n");
     }   
     
-    free(denom);
+    allo(CP denom,U sysrow*sizeof(intDenom),0);
 
     return(ret);
     
@@ -1124,7 +1102,7 @@ void origin_add( int rowl_inar, RAT *inieq )
             if (!ar3) 
             {
                 nel_ar3 = FIRST_SYS_EL+ dim+1-equa;
-                ar3 = (RAT *) RATallo(CP ar3,0,U nel_ar3);
+                ar3 = (RAT *) RATallo(ar3,0,U nel_ar3);
             }
             else if (ar3+dim+1-equa > ar3+nel_ar3-1)
                 reallocate(ineq, (RAT**)&i);
@@ -1190,7 +1168,7 @@ void gentableau( RAT *ar1p, int poi_to_ieq, int *rowl_inar, int **indx )
     *rowl_inar = dim+1;
 
     nel_ar2 = 2*(dim+1)*sysrow;
-    ar2 = (RAT *) RATallo(CP ar2,1, nel_ar2);
+    ar2 = (RAT *) RATallo(ar2,1, nel_ar2);
     
     for (j = 1; j <= points; j++) 
     {
@@ -1228,7 +1206,7 @@ void gentableau( RAT *ar1p, int poi_to_ieq, int *rowl_inar, int **indx )
 
 /*****************************************************************/
 
-void reorder_var( int ineq, RAT *ar1, RAT **ar2, int *nel_ar2, int *nel,
+void reorder_var( int nineq, RAT *a1, RAT **a2, int *nel_a2, int *nel,
                   int **elim_ord, int **indx )
 /*****************************************************************/
 /*
@@ -1255,8 +1233,8 @@ void reorder_var( int ineq, RAT *ar1, RAT **ar2, int *nel_ar2, int *nel,
     
     sysrow = dim+1;
     
-    *nel_ar2 = 2*ineq*sysrow;
-    *ar2 = (RAT *) RATallo( CP (*ar2), 0, *nel_ar2);
+    *nel_a2 = 2*nineq*sysrow;
+    *a2 = (RAT *) RATallo(*a2, 0, *nel_a2);
     
     /* copy columns belonging to variables that will be eliminated */
     
@@ -1272,9 +1250,9 @@ void reorder_var( int ineq, RAT *ar1, RAT **ar2, int *nel_ar2, int *nel,
         if (col < 0) 
             msg( "Invalid format of 'ELIMINATION_ORDER' line", "", 0 );
         col = col-1;
-        r1ptr = ar1+i;
-        r2ptr = *ar2+col;
-        for (j = 0; j < ineq; j++ ) 
+        r1ptr = a1+i;
+        r2ptr = *a2+col;
+        for (j = 0; j < nineq; j++ ) 
         {
             (*RAT_assign)(r2ptr,r1ptr);
             r1ptr += dim + 2;
@@ -1291,9 +1269,9 @@ void reorder_var( int ineq, RAT *ar1, RAT **ar2, int *nel_ar2, int *nel,
     {
         if ((*elim_ord)[i]) 
             continue;
-        r1ptr = ar1+i;
-        r2ptr = *ar2+col;
-        for (j = 0; j < ineq; j++ ) 
+        r1ptr = a1+i;
+        r2ptr = *a2+col;
+        for (j = 0; j < nineq; j++ ) 
         {
             (*RAT_assign)(r2ptr,r1ptr);
             r1ptr += dim + 2;
@@ -1303,9 +1281,9 @@ void reorder_var( int ineq, RAT *ar1, RAT **ar2, int *nel_ar2, int *nel,
     }
     
     /* Copy the right-hand side vector */
-    r1ptr = ar1+dim;
-    r2ptr = *ar2+dim;
-    for (j = 0; j < ineq; j++ ) 
+    r1ptr = a1+dim;
+    r2ptr = *a2+dim;
+    for (j = 0; j < nineq; j++ ) 
     {
         (*RAT_assign)(r2ptr,r1ptr);
         r1ptr += dim + 2;
@@ -1313,8 +1291,8 @@ void reorder_var( int ineq, RAT *ar1, RAT **ar2, int *nel_ar2, int *nel,
     }
     
     /* Assign porta_list[]->sys */
-    r2ptr = *ar2;
-    for (i = 0; i <= 2*ineq; i++) 
+    r2ptr = *a2;
+    for (i = 0; i <= 2*nineq; i++) 
     {
         allo_list(i,0,0);
         porta_list[i]->sys = r2ptr;
@@ -1385,7 +1363,7 @@ void reallocate( int ie, RAT **sysptr )
     }
     
     nel_ar3 += INCR_SYS_EL;
-    ar3 = (RAT *) RATallo(CP ar3,nel_ar3-INCR_SYS_EL,U nel_ar3);
+    ar3 = (RAT *) RATallo(ar3,nel_ar3-INCR_SYS_EL,U nel_ar3);
     /* fprintf(prt,"New space allocated \n"); */
     
     /* 
@@ -1413,6 +1391,194 @@ void reallocate( int ie, RAT **sysptr )
 }
 
 
+
+
+
+
+
+
+
+
+/*
+ * Overflow chunks of array "ar3" used by fourier_motzkin().
+ * When the new inequalities of an iteration do not fit into "ar3",
+ * they are stored in these chunks instead of enlarging "ar3",
+ * so the rows already stored keep their addresses.
+ * The chunks are emptied by the reordering at the end of each iteration
+ * and handed out again in the next one.
+ */
+#define sys_chunk (porta_cur->sys_chunk)
+#define nel_sys_chunk (porta_cur->nel_sys_chunk)
+#define sys_chunks (porta_cur->sys_chunks)
+#define cur_sys_chunk (porta_cur->cur_sys_chunk)
+
+
+
+
+RAT *next_sys_chunk( int rowl, int rows, RAT **bd )
+/*****************************************************************/
+/*
+ * Return the next overflow chunk, with room for at least one row
+ * of length "rowl" and preferably for "rows" of them.
+ * *bd is set to the last element of the chunk.
+ */
+{
+    long nel;
+    
+    if (cur_sys_chunk == sys_chunks || nel_sys_chunk[cur_sys_chunk] < rowl) 
+    {
+        nel = (long) rows*rowl;
+        if (nel < INCR_SYS_EL)
+            nel = INCR_SYS_EL;
+        if (cur_sys_chunk && nel < 2*nel_sys_chunk[cur_sys_chunk-1])
+            nel = 2*nel_sys_chunk[cur_sys_chunk-1];
+        
+        if (cur_sys_chunk == sys_chunks) 
+        {
+            if (sys_chunks == SYS_CHUNKS)
+                msg( "too many overflow chunks of the tableau", "", 0 );
+            sys_chunks++;
+        }
+        else
+            RATallo(sys_chunk[cur_sys_chunk],nel_sys_chunk[cur_sys_chunk],0);
+        
+        sys_chunk[cur_sys_chunk] = (RAT *) RATallo((RAT *) 0,0,U nel);
+        nel_sys_chunk[cur_sys_chunk] = nel;
+    }
+    
+    *bd = sys_chunk[cur_sys_chunk]+nel_sys_chunk[cur_sys_chunk]-1;
+    return(sys_chunk[cur_sys_chunk++]);
+}
+
+
+
+
+long sys_chunk_room()
+/*****************************************************************/
+/*
+ * Number of elements in the overflow chunks not handed out yet.
+ */
+{
+    int i;
+    long n = 0;
+    
+    for (i = cur_sys_chunk; i < sys_chunks; i++)
+        n += nel_sys_chunk[i];
+    return(n);
+}
+
+
+
+
+void rewind_sys_chunks()
+/*****************************************************************/
+/*
+ * All rows in the overflow chunks are dead, start again with the first.
+ */
+{
+    cur_sys_chunk = 0;
+}
+
+
+
+
+void free_sys_chunks()
+/*****************************************************************/
+{
+    int i;
+    
+    for (i = 0; i < sys_chunks; i++)
+        RATallo(sys_chunk[i],nel_sys_chunk[i],0);
+    sys_chunks = cur_sys_chunk = 0;
+}
+
+
+
+
+void sys_chunks_to_L_RAT()
+/*****************************************************************/
+/*
+ * Called on the switch to multiple precision arithmetic,
+ * like RAT_to_L_RAT(ar3,nel_ar3).
+ */
+{
+    int i;
+    
+    for (i = 0; i < sys_chunks; i++)
+        RAT_to_L_RAT(sys_chunk[i],(int) nel_sys_chunk[i]);
+}
+
+
+
+
+
+
+
+
+
+
+struct porta_context *new_porta_context()
+/*****************************************************************/
+/*
+ * A new context, in the state of porta_default at program start.
+ * Like the programs, the caller has to call initialize() and
+ * set_I_functions() after use_porta_context().
+ */
+{
+    struct porta_context *ctx;
+    
+    if (!(ctx = (struct porta_context *) calloc(1,sizeof(*ctx))))
+        msg( "allocation of new space failed", "", 0 );   
+    return(ctx);
+}
+
+
+
+
+struct porta_context *use_porta_context( struct porta_context *ctx )
+/*****************************************************************/
+/*
+ * Make "ctx" the context of the calling thread,
+ * return the context used before.
+ */
+{
+    struct porta_context *old = porta_cur;
+    
+    if (ctx != old)
+        ctx->outer = old;
+    porta_cur = ctx;
+    return(old);
+}
+
+
+
+
+void free_porta_context( struct porta_context *ctx )
+/*****************************************************************/
+/*
+ * Free "ctx" and the arrays and lists still held by it.
+ * If it is the context of the calling thread, 
+ * the thread returns to the context used before.
+ * The log file and the output files have to be closed by the caller.
+ */
+{
+    struct porta_context *old = porta_cur;
+    
+    porta_cur = ctx;
+    free(ar1); free(ar2); free(ar3); free(ar4); free(ar5); free(ar6);
+    free(elim_in);
+    free_lists();
+    free_sys_chunks();
+    free_io_buffers();
+    
+    porta_cur = (old == ctx) ? ctx->outer : old;
+    if (ctx != &porta_default)
+        free(ctx);
+    else
+        memset(ctx,0,sizeof(*ctx));
+}
+
+
 #if !defined WIN32
 #include <unistd.h>
 #include <sys/times.h>
@@ -1468,7 +1634,7 @@ float time_used()
 
 
 
-static double initial_time;
+#define initial_time (porta_cur->initial_time)
 
 
 void init_total_time()
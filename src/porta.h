@@ -56,23 +56,6 @@ struct RAT {
 };
 typedef struct RAT RAT;
 
-extern int mp_state;
-#define MP_not_ready (mp_state == -1)
-#define MP_ready (mp_state == 0)
-#define MP_realised (mp_state == 1)
-#define SET_MP_not_ready mp_state = -1
-#define SET_MP_ready mp_state = 0
-#define SET_MP_realised mp_state = 1
-
-// The following were externalized to make the file available to external calling, modified by J-D B
-extern void 
-  (*RAT_add)(),
-  (*RAT_sub)(),
-  (*RAT_mul)(),
-  (*RAT_row_prim)(RAT *, RAT *, RAT *, int), // Line completed on 26.2.2013 by J-D B to be compatible with the c++ library interface portalib.cpp
-  (*RAT_assign)(),
-  (*writeline)();
-
 #define MAX_LEN_LINT 20
 
 struct loint {
@@ -92,12 +75,6 @@ typedef struct lorat lorat;
 #define INCR_LIST 5000  
 #define INCR_INSYS_ROW 1000 
 
-#define CP (char *)
-#define U (unsigned )
-#define UP (unsigned *)
-#define RP (RAT *)
-#define szU (sizeof(unsigned))
-
 struct list {
   RAT *sys; 
   unsigned *mark;
@@ -108,33 +85,145 @@ struct list {
 typedef struct list *listp;
 
 extern char andreas[];
-extern listp *porta_list;
-     
-extern RAT RAT_const[2],var[4];
 
-extern RAT *ar1,*ar2,*ar3,*ar4,*ar5,*ar6;
-extern long nel_ar1,nel_ar2,nel_ar3,nel_ar4,nel_ar5,nel_ar6;
-
-extern int  maxlist, total_size;
+/* binary files (see inout.c) */
+struct bin_head {
+  char magic[8];
+  int order, kind, ndim, rows, cols, nmp, markw, npoints, flags, reserved[5];
+  };
+
+/* a table entry has the layout of an integer RAT on 64-bit machines */
+struct bin_ent {
+  long long num;
+  int den, pad;
+  };
+
+
+#define SYS_CHUNKS 48
+#define MAX_CHUNKS 48
+#define MOD_PRIMES 8
+
+
+/*
+ * All the state of one computation. The variables below used to be
+ * globals of porta.c and of the other modules; they are now fields of 
+ * the context "porta_cur" points to, and keep their names through the
+ * #defines of porta_ctx.h (the fields private to a module are #defined
+ * in that module).
+ * Every thread has its own porta_cur. It points to porta_default,
+ * unless the thread has chosen another context by use_porta_context(),
+ * so several computations may run at a time on different threads.
+ * Parallel regions pass porta_cur on to their threads by copyin().
+ */
+struct porta_context {
+  /* porta.c */
+  int mp_state;
+  void 
+    (*RAT_add)(),
+    (*RAT_sub)(),
+    (*RAT_mul)(),
+    (*RAT_row_prim)(RAT *, RAT *, RAT *, int),
+    (*RAT_assign)(),
+    (*writeline)();
+  RAT RAT_const[2],var[4];
+  RAT *ar1,*ar2,*ar3,*ar4,*ar5,*ar6;
+  long nel_ar1,nel_ar2,nel_ar3,nel_ar4,nel_ar5,nel_ar6;
+  int maxlist;
+  long total_size, peak_size, mem_budget, cache_budget;
+  int dim,
+    equa,    /* number of equalities */
+    ineq,    /* number of inequalities */
+    conv, 
+    cone, 
+    points,
+    blocks;
+  int *elim_in;
+  FILE *fp,*prt;
+  int option, allowed_options;
+  RAT *sys_chunk[SYS_CHUNKS];
+  long nel_sys_chunk[SYS_CHUNKS];
+  int sys_chunks, cur_sys_chunk;
+  double initial_time;
+  
+  /* common.c */
+  listp *porta_list;
+  int comp;
+  struct list *list_pool;
+  unsigned *mark_pool;
+  size_t list_left,mark_left,list_size,mark_size;
+  char *list_chunk[MAX_CHUNKS];
+  size_t list_chunk_size[MAX_CHUNKS];
+  int list_chunks;
+  void (*on_error)(char *);  /* called by msg() with the message, if set */
+  
+  /* four_mot.c */
+  int itr, totalineq, parallelize;
+  char hest1[7],hest2[7],hest3[7];
+  char oestr1[10],oestr2[10],oestr3[10],oestr4[10];
+  FILE *stream_fp;
+  int nstream;
+  
+  /* portsort.c */
+  int comp_ps,delay,same_vals,rowlen;
+  int (*syscompare)(const void*,const void*);
+  long *sort_key;
+  int sort_keylen;
+  
+  /* inout.c */
+  char *in_buf, *in_pos, *in_end;
+  size_t in_size, in_cap;
+  int in_mapped;
+  char *ln_buf, *sq_buf;
+  size_t ln_cap;
+  int *in_list[3];
+  FILE *wf_pipe[8];
+  long wf_pid[8];
+  struct bin_head bw_head;
+  struct bin_ent *bw_row;
+  unsigned *bw_mp, *bw_mark;
+  size_t bw_mplen, bw_mpcap;
+  int bw_n, bw_rows, **bw_list;
+  char *ob_buf;
+  size_t ob_len, ob_cap;
+  FILE *ob_fp;
+  
+  /* mp.c */
+  struct mod_vars {
+    RAT *cols;
+    int *ord, n, ncols, nrows, first, last, done, *cb;
+    unsigned *colres, *res;
+    loint *E, *D;
+    char *ok;
+  } modv;
+  unsigned mod_pinv[MOD_PRIMES][MOD_PRIMES];
+  
+  /* log.c */
+  FILE *logfile;
+  
+  /* the context in use before use_porta_context() */
+  struct porta_context *outer;
+};
 
-extern int  dim,
-     equa,    /* number of equalities */
-     ineq,    /* number of inequalities */
-     conv, 
-     cone, 
-     points,
-     blocks;
+extern struct porta_context porta_default;
+#if defined WIN32
+extern __declspec(thread) struct porta_context *porta_cur;
+#elif defined _OPENMP
+extern struct porta_context *porta_cur;
+#pragma omp threadprivate(porta_cur)
+#else
+extern __thread struct porta_context *porta_cur;
+#endif
 
-extern int *elim_in; // Added by J-D B to allow to be freed by libporta.cpp
+extern struct porta_context *new_porta_context( void );
+extern struct porta_context *use_porta_context( struct porta_context * );
+extern void free_porta_context( struct porta_context * );
 
-extern FILE *fp,*prt;
 //char * RATallo(); // Removed by J-D B on 26.2.2013 for compatibility with c++ library portalib.cpp
 extern char * allo();
+extern char * lallo( char *, size_t, size_t );
 
-/*  options  */
+/*  options (is_set() is in porta_ctx.h)  */
 
-extern int option, allowed_options;
-#define is_set(x) (option & x)
 #define Protocol_to_file 1
 #define Redundance_check 4
 #define Validity_table_out 8
@@ -150,6 +239,15 @@ extern int option, allowed_options;
 #define Traf 8192
 #define Opt_elim 16384
 #define Long_arithmetic 32768
+#define Int_tableau 65536
+#define Modular_arith 131072
+#define Binary_out 262144
+#define Unaligned_out 524288
+#define Stream_out 1048576
+#define Facet_check 2097152
+#define Memory_budget 4194304
+#define Result_cache 8388608
+#define Dedup_input 16777216
 
 
 // Function added by J-D B on 14.4.2013:
@@ -157,6 +255,11 @@ extern long int longgcd(long int u, long int v);
 
 extern int no_denom( int, int, int, int );
 extern void reallocate( int, RAT ** );
+extern RAT *next_sys_chunk( int, int, RAT ** );
+extern long sys_chunk_room( void );
+extern void rewind_sys_chunks( void );
+extern void free_sys_chunks( void );
+extern void sys_chunks_to_L_RAT( void );
 extern void polarformat( RAT *, int *, int, RAT * );
 extern int *check_and_reorder_elim_ord( int *, int * );
 extern void resubst( RAT *, int, int [] );
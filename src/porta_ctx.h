@@ -0,0 +1,105 @@
+/*******************************************************************************
+
+Copyright (C) 2026 PORTA contributors
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; either version 2 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc., 59 Temple
+Place, Suite 330, Boston, MA 02111-1307 USA
+
+
+FILENAME: porta_ctx.h
+
+The shorthands of the sources of porta for the current context.
+
+*******************************************************************************/
+
+
+#ifndef _PORTA_CTX_H
+#define _PORTA_CTX_H
+
+
+/*
+ * The names the sources of porta use for the fields of the current context
+ * (see struct porta_context in porta.h), and the other shorthands of the
+ * sources. They are #defines of short common words, so this header is
+ * private to the sources: porta.h, and libporta.h with it, do not include it.
+ */
+#include "porta.h"
+
+
+#define MP_not_ready (mp_state == -1)
+#define MP_ready (mp_state == 0)
+#define MP_realised (mp_state == 1)
+#define SET_MP_not_ready mp_state = -1
+#define SET_MP_ready mp_state = 0
+#define SET_MP_realised mp_state = 1
+
+#define CP (char *)
+#define U (unsigned )
+#define UP (unsigned *)
+#define RP (RAT *)
+#define szU (sizeof(unsigned))
+
+#define mp_state (porta_cur->mp_state)
+#define RAT_add (porta_cur->RAT_add)
+#define RAT_sub (porta_cur->RAT_sub)
+#define RAT_mul (porta_cur->RAT_mul)
+#define RAT_row_prim (porta_cur->RAT_row_prim)
+#define RAT_assign (porta_cur->RAT_assign)
+#define writeline (porta_cur->writeline)
+#define RAT_const (porta_cur->RAT_const)
+#define var (porta_cur->var)
+#define ar1 (porta_cur->ar1)
+#define ar2 (porta_cur->ar2)
+#define ar3 (porta_cur->ar3)
+#define ar4 (porta_cur->ar4)
+#define ar5 (porta_cur->ar5)
+#define ar6 (porta_cur->ar6)
+#define nel_ar1 (porta_cur->nel_ar1)
+#define nel_ar2 (porta_cur->nel_ar2)
+#define nel_ar3 (porta_cur->nel_ar3)
+#define nel_ar4 (porta_cur->nel_ar4)
+#define nel_ar5 (porta_cur->nel_ar5)
+#define nel_ar6 (porta_cur->nel_ar6)
+#define maxlist (porta_cur->maxlist)
+#define total_size (porta_cur->total_size)
+#define peak_size (porta_cur->peak_size)
+#define mem_budget (porta_cur->mem_budget)
+#define cache_budget (porta_cur->cache_budget)
+#define dim (porta_cur->dim)
+#define equa (porta_cur->equa)
+#define ineq (porta_cur->ineq)
+#define conv (porta_cur->conv)
+#define cone (porta_cur->cone)
+#define points (porta_cur->points)
+#define blocks (porta_cur->blocks)
+#define elim_in (porta_cur->elim_in)
+#define fp (porta_cur->fp)
+#define prt (porta_cur->prt)
+#define option (porta_cur->option)
+#define allowed_options (porta_cur->allowed_options)
+#define porta_list (porta_cur->porta_list)
+#define comp (porta_cur->comp)
+#define on_error (porta_cur->on_error)
+#define itr (porta_cur->itr)
+#define totalineq (porta_cur->totalineq)
+#define comp_ps (porta_cur->comp_ps)
+#define delay (porta_cur->delay)
+#define same_vals (porta_cur->same_vals)
+#define rowlen (porta_cur->rowlen)
+#define syscompare (porta_cur->syscompare)
+#define logfile (porta_cur->logfile)
+
+#define is_set(x) (option & x)
+
+
+#endif // _PORTA_CTX_H
@@ -35,10 +35,23 @@ REVISED BY ANDREAS LOEBEL
 #include "portsort.h"
 #include "mp.h"
 #include "log.h"
+#include "porta_ctx.h"
+#include "omp.h"
 
 
-int comp_ps,delay,same_vals=0,rowlen;
-int (*syscompare)(const void*,const void*);
+
+
+/*
+ * Keys of the rows for sort_keys(): the right-hand side, the numbers 
+ * of the values -5..-1, 1..5, and the coefficients, in the order in 
+ * which sortrekurs() compares them. SORT_PAR is the number of rows 
+ * from which on the rows are sorted in parallel.
+ */
+#define SORT_KEY 11
+#define SORT_PAR 10000
+
+#define key (porta_cur->sort_key)
+#define keylen (porta_cur->sort_keylen)
 
 
 
@@ -176,6 +189,155 @@ void sortrekurs( int first, int last, int whatcomp )
 
 
 
+static int keycompare( const void *a, const void *b )
+/*****************************************************************/
+/*
+ * Compare the keys of rows *a and *b, ties are broken by the row
+ * numbers (i.e. the sort is stable).
+ */
+{
+    int i = *(int *) a, k = *(int *) b, j;
+    long *x = key + (size_t) i*keylen, *y = key + (size_t) k*keylen;
+    
+    for (j = 0; j < keylen; j++)
+        if (x[j] != y[j])
+            return( (x[j] > y[j]) ? 1 : -1 );
+    return( (i > k) - (i < k) );
+}
+
+
+
+
+
+
+
+
+static void merge( int *a, int na, int *b, int nb, int *c )
+/*****************************************************************/
+{
+    while (na && nb)
+        if (keycompare(a,b) <= 0) 
+        {
+            *c++ = *a++; na--;
+        }
+        else 
+        {
+            *c++ = *b++; nb--;
+        }
+    for (; na; na--)
+        *c++ = *a++;
+    for (; nb; nb--)
+        *c++ = *b++;
+}
+
+
+
+
+
+
+
+
+static int sort_keys( int first, int last )
+/*****************************************************************/
+/*
+ * Sort porta_list[first],...,porta_list[last-1] into the order 
+ * of sortrekurs(), if all values are integer (otherwise return 0). 
+ * The keys of the rows are stored one after another, the row numbers
+ * are sorted in chunks and merged, both in parallel for many rows.
+ * Rows equal in all keys keep their order; sortrekurs() leaves it to
+ * qsort().
+ */
+{
+    int i,j,n,w,lo,mid,hi,chunk,*perm,*tmp,*sw,*st,ok = 1;
+    long *k;
+    listp *old;
+    
+    n = last-first;
+    keylen = SORT_KEY+rowlen;
+    key = (long *) lallo(CP 0,0,(size_t) n*keylen*sizeof(long));
+    
+#pragma omp parallel for private(j,k,st) reduction(&&:ok) if (n >= SORT_PAR) copyin(porta_cur)
+    for (i = 0; i < n; i++) 
+    {
+        k = key + (size_t) i*keylen;
+        st = (int *) porta_list[first+i]->ptr;
+        k[0] = porta_list[first+i]->sys[rowlen-1].num;
+        for (j = 0; j < 5; j++) 
+        {
+            k[1+j] = st[j-5];
+            k[6+j] = st[j+1];
+        }
+        for (j = 0; j < rowlen; j++) 
+        {
+            if (porta_list[first+i]->sys[j].den.i != 1)
+                ok = 0;
+            k[SORT_KEY+j] = porta_list[first+i]->sys[j].num;
+        }
+    }
+    if (!ok) 
+    {
+        lallo(CP key,(size_t) n*keylen*sizeof(long),0);
+        return(0);
+    }
+    
+    perm = (int *) lallo(CP 0,0,n*sizeof(int));
+    tmp = (int *) lallo(CP 0,0,n*sizeof(int));
+    for (i = 0; i < n; i++)
+        perm[i] = i;
+    
+    chunk = (n >= SORT_PAR) ? (n+omp_get_max_threads()-1)/omp_get_max_threads() : n;
+#pragma omp parallel for private(hi) if (n >= SORT_PAR) copyin(porta_cur)
+    for (lo = 0; lo < n; lo += chunk) 
+    {
+        hi = (lo+chunk < n) ? lo+chunk : n;
+        qsort(CP (perm+lo),hi-lo,sizeof(int),keycompare);
+    }
+    for (w = chunk; w < n; w *= 2) 
+    {
+#pragma omp parallel for private(mid,hi) copyin(porta_cur)
+        for (lo = 0; lo < n; lo += 2*w) 
+        {
+            mid = (lo+w < n) ? lo+w : n;
+            hi = (lo+2*w < n) ? lo+2*w : n;
+            merge(perm+lo,mid-lo,perm+mid,hi-mid,tmp+lo);
+        }
+        sw = perm; perm = tmp; tmp = sw;
+    }
+    
+    old = (listp *) lallo(CP 0,0,n*sizeof(listp));
+    for (i = 0; i < n; i++)
+        old[i] = porta_list[first+i];
+    for (i = 0; i < n; i++)
+        porta_list[first+i] = old[perm[i]];
+    
+    /* numbering of the rows with equal statistics as by sortrekurs() */
+    for (i = 0; i < n; i = j) 
+    {
+        for (j = i+1; j < n && !memcmp(key+(size_t) perm[i]*keylen, 
+                                        key+(size_t) perm[j]*keylen,
+                                        SORT_KEY*sizeof(long)); j++);
+        if (j-i > 1) 
+        {
+            same_vals++;
+            for (w = i; w < j; w++)
+                *((int *) porta_list[first+w]->ptr) = same_vals;
+        }
+    }
+    
+    lallo(CP old,n*sizeof(listp),0);
+    lallo(CP perm,n*sizeof(int),0);
+    lallo(CP tmp,n*sizeof(int),0);
+    lallo(CP key,(size_t) n*keylen*sizeof(long),0);
+    return(1);
+}
+
+
+
+
+
+
+
+
 void sort( int int_val, int rl, int first, int last)
 {
     int i,j,val,*statptr,*statistik;
@@ -189,7 +351,7 @@ void sort( int int_val, int rl, int first, int last)
     syscompare = (int(*)(const void*,const void*))
         (int_val ? int_syscompare : rat_syscompare);
     
-    statistik = (int *) allo(CP 0,0,U (last-first+1)*11*sizeof(int));
+    statistik = (int *) lallo(CP 0,0,(size_t) (last-first+1)*11*sizeof(int));
     for (j = 0; j < (last-first+1)*11; j++)
         *(statistik+j) = 0;
     
@@ -213,12 +375,17 @@ void sort( int int_val, int rl, int first, int last)
         }
     }
     
-    sortrekurs(first,last-1,0);
+    /* 
+     * With integer values (compared by int_syscompare()), the order
+     * of sortrekurs() is a lexicographic one (see sort_keys()).
+     */
+    if (!int_val || MP_realised || last-first < 2 || !sort_keys(first,last))
+        sortrekurs(first,last-1,0);
     
     if (MP_realised)
         return_from_mp();
 
-    free( statistik );
+    lallo(CP statistik,(size_t) (last-first+1)*11*sizeof(int),0);
     
     fprintf(prt,"\n");
 
@@ -26,13 +26,381 @@ Thomas Christof and Andreas Loebel.
 *******************************************************************************/
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <unistd.h>
+#include <fcntl.h>
 #include "libporta.h"
 
 #include "omp.h"
 
-int main() {
+
+/* Regression checks, run before the demonstration in main() (alone with 
+ * the argument -c). The programs xporta and valid are run from the 
+ * directory of this program, on files written to a temporary directory. */
+static string bindir, tmpdir;
+static int failures(0);
+
+typedef vector< vector<long int> > rowset;
+
+static void check(bool ok, const string& what)
+{
+	cout << (ok ? "ok      " : "FAILED  ") << what << endl;
+	if (!ok)
+		failures++;
+}
+
+static void write_file(const string& name, const string& text)
+{
+	ofstream out((tmpdir + "/" + name).c_str());
+	out << text;
+}
+
+static string read_file(const string& name)
+{
+	ifstream in((tmpdir + "/" + name).c_str());
+	ostringstream text;
+	
+	text << in.rdbuf();
+	return text.str();
+}
+
+// Runs "program args" in the temporary directory, true if it succeeded
+static bool run(const string& program, const string& args)
+{
+	string cmd("cd " + tmpdir + " && " + bindir + "/" + program + " " + args + " > /dev/null 2>&1");
+	return (system(cmd.c_str()) == 0);
+}
+
+/* A row written by porta, either as integers ("( 1)" numbered or not) or 
+ * as "a*x <= b" (or >=, ==), which becomes (b, -a) as porta writes it in
+ * integers. Rows with fractions are returned empty. */
+static vector<long int> parse_row(const string& line, long int dim)
+{
+	vector<long int> row;
+	size_t start(line[line.find_first_not_of(" ")] == '(' ? line.find(')')+1 : 0);
+	size_t rel(line.find_first_of("<>="));
+	
+	if (line.find('/') != string::npos)
+		return row;
+	if (rel == string::npos)
+	{
+		istringstream is(line.substr(start));
+		long int x;
+		while (is >> x)
+			row.push_back(x);
+		return row;
+	}
+	
+	const char *p(line.c_str()+start), *end(line.c_str()+rel);
+	char *q;
+	int sign(line[rel] == '>' ? 1 : -1);
+	
+	row.assign(dim+1, 0);
+	while (p < end)
+	{
+		long int a(1), s(1);
+		
+		while (*p == ' ') p++;
+		if (p >= end) break;
+		if (*p == '+' || *p == '-')
+			s = (*p++ == '-') ? -1 : 1;
+		if (isdigit(*p))
+		{
+			a = strtol(p, &q, 10);
+			p = q;
+		}
+		if (*p++ != 'x')
+			return vector<long int>();
+		long int j(strtol(p, &q, 10));
+		p = q;
+		if (j < 1 || j > dim)
+			return vector<long int>();
+		row[j] += sign*s*a;
+	}
+	row[0] = -sign*strtol(line.c_str()+line.find_first_not_of("<>= ", rel), 0, 10);
+	return row;
+}
+
+// The sorted rows of "section" of the file "name" written by porta
+static rowset section_rows(const string& name, const string& section)
+{
+	ifstream in((tmpdir + "/" + name).c_str());
+	string line;
+	long int dim(0);
+	bool inside(false);
+	rowset rows;
+	
+	while (getline(in, line))
+	{
+		line.erase(line.find_last_not_of(" \t\r") + 1);
+		if (line.compare(0, 3, "DIM") == 0)
+			dim = atol(line.c_str() + line.find('=') + 1);
+		else if (line == "END" || line.find("SECTION") != string::npos || line == "VALID")
+			inside = (line == section);
+		else if (inside && !line.empty())
+			rows.push_back(parse_row(line, dim));
+	}
+	sort(rows.begin(), rows.end());
+	return rows;
+}
+
+static const char *pyramid_poi =
+	"DIM = 3\n\nCONV_SECTION\n"
+	"0 0 0\n3 0 0\n0 5 0\n0 0 7\n2 3 4\n1 4 6\n5 1 1\n"
+	"END\n";
+
+/* -e: the inequalities streamed during Fourier-Motzkin (the file kept as 
+ * file% by the output of the sorted system) are those of the result, in
+ * integers also in multiple precision (-l) */
+static void check_stream()
+{
+	const char *opts[] = {"-T -e", "-T -e -l"};
+	
+	for (int i = 0; i < 2; i++)
+	{
+		write_file("stream.poi", pyramid_poi);
+		rowset ieqs(run("xporta", string(opts[i]) + " stream.poi") ? section_rows("stream.poi.ieq", "INEQUALITIES_SECTION") : rowset());
+		check(!ieqs.empty() && section_rows("stream.poi.ieq%", "INEQUALITIES_SECTION") == ieqs, string("xporta ") + opts[i] + " streams the inequalities of the result");
+		remove((tmpdir + "/stream.poi.ieq").c_str());
+		remove((tmpdir + "/stream.poi.ieq%").c_str());
+	}
+}
+
+/* The unit cube without the vertex (1,1,1), and the same system with 
+ * repeated and scaled rows */
+static const char *cube_ieq =
+	"DIM = 3\n\nVALID\n0 0 0\n\nINEQUALITIES_SECTION\n"
+	"-x1 <= 0\n-x2 <= 0\n-x3 <= 0\nx1+x2+x3 <= 2\nx1 <= 1\nx2 <= 1\nx3 <= 1\n"
+	"END\n";
+
+static const char *cube_dup_ieq =
+	"DIM = 3\n\nVALID\n0 0 0\n\nINEQUALITIES_SECTION\n"
+	"-x1 <= 0\n-x2 <= 0\n-2x1 <= 0\n-x3 <= 0\nx1+x2+x3 <= 2\nx1 <= 1\n"
+	"3x1+3x2+3x3 <= 6\nx2 <= 1\nx3 <= 1\n-x2 <= 0\n"
+	"END\n";
+
+/* -d: removes the 3 duplicates of cube_dup_ieq and gives the vertices of
+ * the system without them; without -d nothing is removed */
+static void check_dedup()
+{
+	rowset expected;
+	
+	write_file("cube.ieq", cube_ieq);
+	if (run("xporta", "-T cube.ieq"))
+		expected = section_rows("cube.ieq.poi", "CONV_SECTION");
+	for (int d = 0; d < 2; d++)
+	{
+		write_file("dup.ieq", cube_dup_ieq);
+		remove((tmpdir + "/porta.log").c_str());
+		bool ok(run("xporta", d ? "-T -d dup.ieq" : "-T dup.ieq"));
+		bool removed(read_file("porta.log").find("duplicate inequalities removed  :    3") != string::npos);
+		check(ok && !expected.empty() && section_rows("dup.ieq.poi", "CONV_SECTION") == expected && removed == (d == 1),
+				d ? "xporta -T -d removes the duplicate inequalities" : "xporta -T keeps the duplicate inequalities");
+	}
+}
+
+static const char *triangle_poi =
+	"DIM = 2\n\nCONV_SECTION\n0 0\n1 0\n0 1\nEND\n";
+
+static const char *triangle_ieq =
+	"DIM = 2\n\nVALID\n0 0\n\nINEQUALITIES_SECTION\n"
+	"x1 <= 1\nx1 <= 0\nx1+x2 <= 1\n-x1 <= 0\n-x2 <= 0\nx1-x2 <= 0\n"
+	"1000000x1+1000000x2 <= 999999\n1000000x1+1000000x2 <= 1000000\n"
+	"END\n";
+
+/* -I: keeps the inequalities valid for all the points, drops the others */
+static void check_iespo()
+{
+	rowset expected;
+	long int valid[][3] = {{1, -1, 0}, {1, -1, -1}, {0, 1, 0}, {0, 0, 1}, {1000000, -1000000, -1000000}};
+	
+	for (int i = 0; i < 5; i++)
+		expected.push_back(vector<long int>(valid[i], valid[i]+3));
+	sort(expected.begin(), expected.end());
+	write_file("triangle.poi", triangle_poi);
+	write_file("triangle.ieq", triangle_ieq);
+	check(run("valid", "-I triangle.ieq triangle.poi") && section_rows("triangle.poi.ieq", "INEQUALITIES_SECTION") == expected,
+			"valid -I drops the inequalities violated by a point");
+}
+
+static const char *prism_ray_poi =
+	"DIM = 3\n\nCONV_SECTION\n0 0 0\n1 0 0\n0 1 0\n1 1 0\n"
+	"CONE_SECTION\n1 1 0\nEND\n";
+
+static const char *cone_poi =
+	"DIM = 3\n\nCONE_SECTION\n1 0 0\n0 1 0\n1 1 1\n0 0 1\n1 0 1\nEND\n";
+
+/* -f: all the inequalities of traf are facets, -f keeps them (here a 
+ * full-dimensional polytope, a lower-dimensional polyhedron with a ray and
+ * a cone, for which the origin is added) */
+static void check_facets()
+{
+	const char *names[] = {"pyramid", "prism_ray", "cone"};
+	const char *poi[] = {pyramid_poi, prism_ray_poi, cone_poi};
+	
+	for (int i = 0; i < 3; i++)
+	{
+		string name(names[i]), f(name + "_f");
+		
+		write_file(name + ".poi", poi[i]);
+		write_file(f + ".poi", poi[i]);
+		bool ok(run("xporta", "-T " + name + ".poi") && run("xporta", "-T -f " + f + ".poi"));
+		rowset ieqs(section_rows(name + ".poi.ieq", "INEQUALITIES_SECTION"));
+		check(ok && !ieqs.empty() && section_rows(f + ".poi.ieq", "INEQUALITIES_SECTION") == ieqs,
+				"xporta -T -f keeps the facets of the " + name);
+	}
+}
+
+/* The system of cube_ieq with its rows in another order, repeated and
+ * multiplied by positive numbers, and the system with the bound 2 on x3 */
+static const char *cube_perm_ieq =
+	"DIM = 3\n\nVALID\n0 0 0\n\nINEQUALITIES_SECTION\n"
+	"2x3 <= 2\nx2 <= 1\n-x3 <= 0\n3x1+3x2+3x3 <= 6\nx1 <= 1\n-x2 <= 0\n-5x1 <= 0\nx2 <= 1\n"
+	"END\n";
+
+static const char *cuboid_ieq =
+	"DIM = 3\n\nVALID\n0 0 0\n\nINEQUALITIES_SECTION\n"
+	"-x1 <= 0\n-x2 <= 0\n-x3 <= 0\nx1+x2+x3 <= 2\nx1 <= 1\nx2 <= 1\nx3 <= 2\n"
+	"END\n";
+
+/* -r: a system converted before, up to the order, repetitions and
+ * multiples of its rows, is taken from the cache (a hit), another one is
+ * converted and stored (a miss); the outputs are those of xporta without -r */
+static void check_cache()
+{
+	const char *names[] = {"cube", "cube_perm", "cuboid"};
+	const char *ieq[] = {cube_ieq, cube_perm_ieq, cuboid_ieq};
+	const char *plain[] = {"cube_plain", "cube_plain", "cuboid_plain"};
+	const bool hit[] = {false, true, false};
+	
+	setenv("PORTA_CACHE", (tmpdir + "/porta.cache").c_str(), 1);
+	for (int i = 0; i < 3; i++)
+	{
+		string name(names[i]);
+		
+		write_file(name + ".ieq", ieq[i]);
+		write_file(string(plain[i]) + ".ieq", ieq[i]);
+		remove((tmpdir + "/porta.log").c_str());
+		bool ok(run("xporta", "-T -r " + name + ".ieq"));
+		string log(read_file("porta.log"));
+		ok = ok && log.find(hit[i] ? "output taken from cache entry" : "output stored as cache entry") != string::npos;
+		ok = ok && run("xporta", "-T " + string(plain[i]) + ".ieq");
+		ok = ok && section_rows(name + ".ieq.poi", "CONV_SECTION") == section_rows(string(plain[i]) + ".ieq.poi", "CONV_SECTION");
+		check(ok, "xporta -T -r: " + name + (hit[i] ? " is a hit of the cache" : " is a miss of the cache"));
+	}
+	unsetenv("PORTA_CACHE");
+}
+
+/* Sends the output of the library to /dev/null (on) or back (off) */
+static void quiet(bool on)
+{
+	static int out(-1);
+	
+	cout.flush();
+	fflush(stdout);
+	if (on)
+	{
+		int null(open("/dev/null", O_WRONLY));
+		
+		out = dup(1);
+		dup2(null, 1);
+		close(null);
+	}
+	else if (out >= 0)
+	{
+		dup2(out, 1);
+		close(out);
+		out = -1;
+	}
+}
+
+/* The batch conversions of the library give the results of the single
+ * conversions. An error in a conversion of a batch (an H-representation
+ * with the equations x1 = 0 and x1 = 1) only fails this conversion. */
+static void check_batch()
+{
+	Tnum cube[] = {1,0,0,0, 1,1,0,0, 1,0,1,0, 1,0,0,1, 1,1,1,0, 1,1,0,1, 1,0,1,1, 1,1,1,1};
+	Tnum pyramid[] = {1,0,0,0, 1,3,0,0, 1,0,5,0, 1,0,0,7, 1,2,3,4, 1,1,4,6, 1,5,1,1};
+	Tnum eqs[] = {0,1,0, -1,1,0}, ieqs[] = {0,0,1};
+	vector<Vrep> vreps, vsingle;
+	vector<Hrep> hreps, hsingle;
+	vector<string> verrors, herrors;
+	long int i, bad(3);
+	bool same(true);
+	char cwd[FILENAME_MAX];
+	
+	for (i = 0; i < 6; i++)
+		vreps.push_back(i % 2 ? Vrep(pyramid, 7, 3) : Vrep(cube, 8, 3));
+	if (!getcwd(cwd, sizeof(cwd)) || chdir(tmpdir.c_str()))
+	{
+		check(false, "changing to the directory of the checks");
+		return;
+	}
+	quiet(true);
+	verrors = VtoHrep(vreps, hreps, 3);
+	hsingle.resize(vreps.size());
+	for (i = 0; i < (long int) vreps.size(); i++)
+		VtoHrep(vreps[i], hsingle[i]);
+	hreps.insert(hreps.begin() + bad, Hrep(eqs, 2, ieqs, 1, 2));
+	herrors = HtoVrep(hreps, vreps, 3);
+	vsingle.resize(hreps.size());
+	for (i = 0; i < (long int) hreps.size(); i++)
+		if (i != bad)
+			HtoVrep(hreps[i], vsingle[i]);
+	quiet(false);
+	if (chdir(cwd))
+		check(false, "changing back to the directory of test");
+	
+	for (i = 0; i < (long int) hsingle.size(); i++)
+		same = same && verrors[i].empty() && hreps[i < bad ? i : i+1] == hsingle[i] && hsingle[i].nbInequalities() > 0;
+	check(same, "the batch VtoHrep() gives the results of single conversions");
+	same = !herrors[bad].empty() && vreps[bad].nbPointsAndRays() == 0;
+	for (i = 0; i < (long int) vsingle.size(); i++)
+		if (i != bad)
+			same = same && herrors[i].empty() && vreps[i] == vsingle[i] && vsingle[i].nbPointsAndRays() > 0;
+	check(same, "the batch HtoVrep() gives the results of single conversions and reports the error of one");
+}
+
+static void run_checks(const char *program)
+{
+	char dir[] = "/tmp/porta_testXXXXXX", *path(realpath(program, 0));
+	
+	if (!path || !mkdtemp(dir))
+	{
+		check(false, "setting up the checks");
+		return;
+	}
+	bindir = path;
+	bindir.erase(bindir.rfind('/'));
+	free(path);
+	tmpdir = dir;
+	
+	check_stream();
+	check_dedup();
+	check_iespo();
+	check_facets();
+	check_cache();
+	check_batch();
+	
+	if (failures)
+		cout << failures << " checks failed, their files are in " << tmpdir << endl;
+	else
+		system(("rm -rf " + tmpdir).c_str());
+}
+
+
+int main(int argc, char *argv[]) {
+	run_checks(argv[0]);
+	if (failures || (argc > 1 && string(argv[1]) == "-c"))
+		return (failures ? 1 : 0);
+	
 	// A simple polytope :
 	//long int data[] = {1, 0, -4, 0, 0, 1, 0, 3, 0, 0, 1, 0, 0, 0, -2, 1, 0, 0, 0, 2};
 	//int dimension = 4;
@@ -37,11 +37,11 @@ REVISED BY ANDREAS LOEBEL
 #include "common.h"
 #include "inout.h"
 #include "log.h"
+#include "porta_ctx.h"
+#include <limits.h>
+#include <math.h>
 
 
-FILE *logfile;
-
-FILE *fp;
 int *lowbds,*upbds;
 
 
@@ -103,7 +103,7 @@ int main( int argc, char *argv[] )
     }
     setbuf(prt,CP 0);
     
-    if (is_set(Vint) && !strcmp(*argv+strlen(*argv)-4,".ieq")) 
+    if (is_set(Vint) && file_ext(*argv,".ieq")) 
     {  
             char *cp1,*cp2;
         cp1=strdup("LOWER_BOUNDS");
@@ -119,10 +119,8 @@ int main( int argc, char *argv[] )
     }
     else 
     {
-        pothie = !strcmp(*argv+strlen(*argv)-4,".poi") 
-            && !strcmp(*(argv+1)+strlen(*(argv+1))-4,".ieq");
-        iethpo = !strcmp(*argv+strlen(*argv)-4,".ieq") 
-            && !strcmp(*(argv+1)+strlen(*(argv+1))-4,".poi");
+        pothie = file_ext(*argv,".poi") && file_ext(*(argv+1),".ieq");
+        iethpo = file_ext(*argv,".ieq") && file_ext(*(argv+1),".poi");
         if (!iethpo && !pothie)
             msg("invalid format of command line", "", 0 );
         
@@ -231,11 +229,59 @@ int main( int argc, char *argv[] )
 
 
 
-int valid_points( int dim, RAT *par, int npoi, int pard, RAT *iear, 
+#define VAL_TILE  64
+#define VAL_BLOCK 256
+#define VAL_CHUNK 4096
+
+/* 
+ * valid_points() and valid_ieqs() scale both systems to integers 
+ * and evaluate them in blocks of VAL_BLOCK rows against tiles of 
+ * VAL_TILE rows of the other system, in parallel.
+ * Rows whose products could exceed the long integers are checked
+ * with eqie_satisfied().
+ */
+
+
+
+
+
+
+
+
+static int int_status( long *a, long b, long *p, long w, int ndim, int ie )
+/*****************************************************************/
+/*
+ * Integer version of eqie_satisfied() for the scaled inequality
+ * (a,b) and the scaled point (p,w).
+ */
+{
+    long s = 0;
+    int j;
+    
+#pragma omp simd reduction(+:s)
+    for (j = 0; j < ndim; j++)
+        s += a[j]*p[j];
+    s = b*w - s;
+    
+    if (!ie)
+        return(!s);
+    return(s > 0 ? 1 : (s ? 0 : 2));
+}
+
+
+
+
+
+
+
+
+int valid_points( int ndim, RAT *par, int npoi, int pard, RAT *iear, 
                   int nie, int ieard, int not_equal, char **fname)
 { 
-    RAT *pptr,*ieptr,*ubpar,*ubiear,*np,s;
-    int v,ie,ncv=0,nce=0;
+    RAT *pptr,*ieptr,*ubpar,*ubiear,s;
+    int v,ie,ncv=0,nce=0,fast;
+    long pgmx,agmx,*pm,*pw,*pmx,*am,*aw,*amx;
+    char *ok;
     
     fprintf (prt,"filtering points satisfying given linear system ");
     
@@ -244,7 +290,49 @@ int valid_points( int dim, RAT *par, int npoi, int pard, RAT *iear,
     
     ubpar = par+npoi*pard;
     ubiear = iear+nie*ieard;
-    np = par;
+    
+    fast = int_system(par,npoi,pard,ndim,1,&pm,&pw,&pmx,&pgmx);
+    fast = int_system(iear,nie,ieard,ndim,0,&am,&aw,&amx,&agmx) && fast;
+    ok = allo(CP 0,0,U npoi+1);
+    
+    if (fast) 
+    {
+        int b;
+        
+#pragma omp parallel for schedule(dynamic) private(v) copyin(porta_cur)
+        for (b = 0; b < npoi; b += VAL_BLOCK) 
+        {
+            int p,k,t,e,te,alive = 0;
+            
+            e = (b+VAL_BLOCK < npoi) ? b+VAL_BLOCK : npoi;
+            for (p = b; p < e; p++) 
+            {
+                ok[p] = int_fits(pmx[p],agmx,ndim) ? 1 : 2;
+                alive += (ok[p] == 1);
+            }
+            for (t = 0; t < nie && alive; t += VAL_TILE) 
+            {
+                te = (t+VAL_TILE < nie) ? t+VAL_TILE : nie;
+                for (p = b; p < e; p++) 
+                {
+                    if (ok[p] != 1)
+                        continue;
+                    for (k = t; k < te; k++) 
+                    {
+                        v = int_status(am+(size_t) k*ndim,aw[k],
+                                       pm+(size_t) p*ndim,pw[p],ndim,
+                                       iear[(size_t) k*ieard+ndim+1].num != 0);
+                        if (!v || (not_equal && v == 2)) 
+                        {
+                            ok[p] = 0;
+                            alive--;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
     
     for (pptr = par,ie = 0; pptr < ubpar; pptr += pard, ie++) 
     {
@@ -256,30 +344,41 @@ int valid_points( int dim, RAT *par, int npoi, int pard, RAT *iear,
             porta_log("."); fflush(logfile);
         }
         
-        for (ieptr = iear; ieptr < ubiear; ieptr += ieard) 
+        if (fast && ok[ie] != 2) 
         {
-            if (! pptr[dim].num) 
-            { 
-                /* cone  */
-                s = ieptr[dim];
-                ieptr[dim] = RAT_const[0];
-            }
-            if (!(v = eqie_satisfied(ieptr,pptr,dim,(ieptr+dim+1)->num))  ||
-                (not_equal && v==2)) 
-                v = 0;
-            if (! pptr[dim].num)   /* cone  */
-                ieptr[dim] = s;
-            if (!v) break;
+            if (!ok[ie])
+                continue;
         }
-        
-        if (ieptr == iear + nie*ieard) 
+        else 
         {
-            allo_list(nce+ncv,0,blocks);
-            porta_list[nce+ncv]->sys = pptr;
-            if ((pptr+dim)->num) ncv++;
-            else nce++;
+            for (ieptr = iear; ieptr < ubiear; ieptr += ieard) 
+            {
+                if (! pptr[ndim].num) 
+                { 
+                    /* cone  */
+                    s = ieptr[ndim];
+                    ieptr[ndim] = RAT_const[0];
+                }
+                if (!(v = eqie_satisfied(ieptr,pptr,ndim,(ieptr+ndim+1)->num))  ||
+                    (not_equal && v==2)) 
+                    v = 0;
+                if (! pptr[ndim].num)   /* cone  */
+                    ieptr[ndim] = s;
+                if (!v) break;
+            }
+            if (ieptr != iear + nie*ieard)
+                continue;
         }
+        
+        allo_list(nce+ncv,0,blocks);
+        porta_list[nce+ncv]->sys = pptr;
+        if ((pptr+ndim)->num) ncv++;
+        else nce++;
     }
+    
+    allo(ok,U npoi+1,0);
+    free_int_system(npoi,ndim,pm,pw,pmx);
+    free_int_system(nie,ndim,am,aw,amx);
 
     if (!nce && !ncv)
     {
@@ -289,7 +388,7 @@ int valid_points( int dim, RAT *par, int npoi, int pard, RAT *iear,
         porta_log( "\nno points found\n\n");
     }
     else
-        write_poi_file( (char *)fname,0,dim,0,0,nce,0,ncv,nce);
+        write_poi_file( (char *)fname,0,ndim,0,0,nce,0,ncv,nce);
     return(nce+ncv);
 }
 
@@ -300,13 +399,14 @@ int valid_points( int dim, RAT *par, int npoi, int pard, RAT *iear,
 
 
 
-void valid_ieqs( int dim, RAT *iear, int neqie_in, int *neq_out, int *nie_out,
+void valid_ieqs( int ndim, RAT *iear, int neqie_in, int *neq_out, int *nie_out,
                  int ieard, RAT *par, int npoi, int pard, char **fname )
 { 
-    RAT *pptr,*ieptr,*ubpar,*ubiear,*np,s;
-    int i,ie,b,p,valid;
-    
-    unsigned *mp,m;
+    RAT *pptr,*ieptr,*ubpar,*np,s;
+    int i,ie,b,p,valid,fast,ch,che;
+    long pgmx,agmx,*pm,*pw,*pmx,*am,*aw,*amx;
+    char *ok;
+    unsigned *mp,m,*bits;
     
     printf ("filtering inequalities and equations valid for all given points ");
 
@@ -314,65 +414,132 @@ void valid_ieqs( int dim, RAT *iear, int neqie_in, int *neq_out, int *nie_out,
     porta_log( "filtering inequalities and equations valid for all given points ");
     
     ubpar = par+npoi*pard;
-    ubiear = iear+neqie_in*ieard;
     np = iear;
     *neq_out = *nie_out = 0;
     
     blocks = (is_set(Validity_table_out)) ?  (npoi-1)/32+1 : 0;
     allo_list(0,&mp,blocks);
     
-    for (ieptr = iear,ie=0; ieptr < ubiear; ieptr += ieard,ie++) 
+    fast = int_system(par,npoi,pard,ndim,1,&pm,&pw,&pmx,&pgmx);
+    fast = int_system(iear,neqie_in,ieard,ndim,0,&am,&aw,&amx,&agmx) && fast;
+    ok = allo(CP 0,0,U VAL_CHUNK);
+    bits = (unsigned *) allo(CP 0,0,U (VAL_CHUNK*blocks*sizeof(unsigned)+1));
+    
+    for (ch = 0, ieptr = iear, ie = 0; ch < neqie_in; ch = che) 
     {
-        for (b = 0; b < blocks; b++)
-            mp[b] = 0;
+        che = (ch+VAL_CHUNK < neqie_in) ? ch+VAL_CHUNK : neqie_in;
         
-        if (ie%100 == 0) 
+        if (fast) 
         {
-            fprintf(prt,"."); fflush(prt);
-
-            /* 17.01.1994: include logging on file porta.log */
-            porta_log( "." ); fflush(logfile);
+#pragma omp parallel for schedule(dynamic) private(i,p,b,m,valid) copyin(porta_cur)
+            for (i = ch; i < che; i += VAL_TILE) 
+            {
+                int k,t,e,te,alive = 0;
+                
+                e = (i+VAL_TILE < che) ? i+VAL_TILE : che;
+                for (k = i; k < e; k++) 
+                {
+                    ok[k-ch] = int_fits(amx[k],pgmx,ndim) ? 1 : 2;
+                    alive += (ok[k-ch] == 1);
+                    for (b = 0; b < blocks; b++)
+                        bits[(k-ch)*blocks+b] = 0;
+                }
+                for (t = 0; t < npoi && alive; t += VAL_BLOCK) 
+                {
+                    te = (t+VAL_BLOCK < npoi) ? t+VAL_BLOCK : npoi;
+                    for (k = i; k < e; k++) 
+                    {
+                        if (ok[k-ch] != 1)
+                            continue;
+                        for (p = t; p < te; p++) 
+                        {
+                            valid = int_status(am+(size_t) k*ndim,aw[k],
+                                               pm+(size_t) p*ndim,pw[p],ndim,
+                                               iear[(size_t) k*ieard+ieard-1].num != 0);
+                            if (!valid) 
+                            {
+                                ok[k-ch] = 0;
+                                alive--;
+                                break;
+                            }
+                            if (valid == 2 && blocks) 
+                            {
+                                m = 1;
+                                m <<= p %32;
+                                bits[(k-ch)*blocks+p/32] |= m;
+                            }
+                        }
+                    }
+                }
+            }
         }
         
-        for (pptr = par, p = 0; pptr < ubpar; pptr += pard, p++) 
+        for (; ie < che; ieptr += ieard,ie++) 
         {
-            if (! pptr[dim].num) 
+            if (ie%100 == 0) 
             {
-                /* cone  */
-                s = ieptr[dim];
-                ieptr[dim] = RAT_const[0];
+                fprintf(prt,"."); fflush(prt);
+
+                /* 17.01.1994: include logging on file porta.log */
+                porta_log( "." ); fflush(logfile);
             }
-            valid = eqie_satisfied(ieptr,pptr,dim,(ieptr+ieard-1)->num);
-            if (valid == 2 && is_set(Validity_table_out)) 
-            { 
-                /* ieq strong valid */
-                m = 1;
-                m <<= p %32;
-                mp[p/32] |= m;
+        
+            if (fast && ok[ie-ch] != 2) 
+            {
+                valid = ok[ie-ch];
+                for (b = 0; b < blocks; b++)
+                    mp[b] = bits[(ie-ch)*blocks+b];
             }
-            if (! pptr[dim].num) 
+            else 
             {
-                /* cone  */
-                ieptr[dim] = s;
-                if (!valid) break;
+                for (b = 0; b < blocks; b++)
+                    mp[b] = 0;
+                
+                for (pptr = par, p = 0; pptr < ubpar; pptr += pard, p++) 
+                {
+                    if (! pptr[ndim].num) 
+                    {
+                        /* cone  */
+                        s = ieptr[ndim];
+                        ieptr[ndim] = RAT_const[0];
+                    }
+                    valid = eqie_satisfied(ieptr,pptr,ndim,(ieptr+ieard-1)->num);
+                    if (valid == 2 && is_set(Validity_table_out)) 
+                    { 
+                        /* ieq strong valid */
+                        m = 1;
+                        m <<= p %32;
+                        mp[p/32] |= m;
+                    }
+                    if (! pptr[ndim].num) 
+                        /* cone  */
+                        ieptr[ndim] = s;
+                    if (!valid) break;
+                }
+                valid = (pptr == ubpar);
             }
-        }
         
-        if (pptr == par+npoi*pard) /* valid */ 
-        {
-            porta_list[*nie_out+*neq_out]->sys = np;
-            if ((ieptr+ieard-1)->num) 
-                (*nie_out)++;
-            else 
-                (*neq_out)++;
-            allo_list(*nie_out+*neq_out,&mp,blocks);
+            if (valid) 
+            {
+                porta_list[*nie_out+*neq_out]->sys = np;
+                if ((ieptr+ieard-1)->num) 
+                    (*nie_out)++;
+                else 
+                    (*neq_out)++;
+                allo_list(*nie_out+*neq_out,&mp,blocks);
             
-            for (i = 0; i < ieard; i++)
-                *np++ = ieptr[i];
+                for (i = 0; i < ieard; i++)
+                    *np++ = ieptr[i];
+            }
         }
     }
     
-    write_ieq_file((char *)fname,0,*neq_out,0,dim+1,0,*nie_out,*neq_out,dim+1,0);
+    allo(ok,U VAL_CHUNK,0);
+    allo(CP bits,U (VAL_CHUNK*blocks*sizeof(unsigned)+1),0);
+    free_int_system(npoi,ndim,pm,pw,pmx);
+    free_int_system(neqie_in,ndim,am,aw,amx);
+    
+    write_ieq_file((char *)fname,0,*neq_out,0,ndim+1,0,*nie_out,*neq_out,ndim+1,0);
     
     fprintf(prt,"\n");
     
@@ -471,11 +638,409 @@ void integ_rekurs( RAT *eqsum, RAT *iesum, int lev )
 
 
 
+#define BB_TASKS 1024
+#define BB_PREFIXES 65536
+
+/*
+ * Branch and bound enumeration for valid_ints(): the equations and 
+ * inequalities are scaled to integers, bb_min[r*(eqdim+1)+lev] and 
+ * bb_max[...] are the smallest and largest values of the variables 
+ * lev,...,eqdim-1 in row r within the bounds. Level lev is only 
+ * enumerated for the values that leave every row satisfiable.
+ */
+static long *bb_a,*bb_b,*bb_min,*bb_max;
+static char *bb_eq;
+static int bb_rows;
+
+struct bb_task 
+{
+    long *x,*sum,nodes;
+    int *out,nout,maxout;
+};
+
+
+
+
+
+
+
+
+static long floor_div( long a, long b )
+{
+    long q = a/b;
+    
+    if (a%b && ((a < 0) != (b < 0)))
+        q--;
+    return(q);
+}
+
+
+
+
+
+
+
+
+static long ceil_div( long a, long b )
+{
+    long q = a/b;
+    
+    if (a%b && ((a < 0) == (b < 0)))
+        q++;
+    return(q);
+}
+
+
+
+
+
+
+
+
+static int bb_system( void )
+/*****************************************************************/
+/*
+ * Scale the rows to integers and compute bb_min and bb_max.
+ * Return 0, if the sums may exceed the long integers.
+ */
+{
+    RAT *r;
+    long l,g,v,lo,hi;
+    long double bnd;
+    int k,j;
+    
+    bb_rows = neq+nie;
+    bb_a = (long *) allo(CP 0,0,U (bb_rows*eqdim*sizeof(long)+1));
+    bb_b = (long *) allo(CP 0,0,U (bb_rows*sizeof(long)+1));
+    bb_min = (long *) allo(CP 0,0,U bb_rows*(eqdim+1)*sizeof(long));
+    bb_max = (long *) allo(CP 0,0,U bb_rows*(eqdim+1)*sizeof(long));
+    bb_eq = allo(CP 0,0,U bb_rows+1);
+    if (MP_realised)
+        return(0);
+    
+    for (k = 0; k < bb_rows; k++) 
+    {
+        r = (k < neq) ? eqar+k*eqrl : iear+(k-neq)*ierl;
+        bb_eq[k] = (k < neq);
+        for (l = 1, j = 0; j <= eqdim; j++) 
+        {
+            g = (long) binary_gcd(l,r[j].den.i);
+            if (__builtin_mul_overflow(l/g,(long) r[j].den.i,&l))
+                return(0);
+        }
+        bnd = 0;
+        for (j = 0; j <= eqdim; j++) 
+        {
+            if (__builtin_mul_overflow(r[j].num,l/r[j].den.i,&v))
+                return(0);
+            if (j == eqdim)
+                bb_b[k] = v;
+            else
+                bb_a[k*eqdim+j] = v;
+            bnd += fabsl((long double) v) * 
+                ((j == eqdim) ? 1 : ((labs(lowbds[j]) > labs(upbds[j])) ?
+                                     labs(lowbds[j]) : labs(upbds[j])));
+        }
+        if (bnd >= 4.0e18L)
+            return(0);
+        
+        bb_min[k*(eqdim+1)+eqdim] = bb_max[k*(eqdim+1)+eqdim] = 0;
+        for (j = eqdim-1; j >= 0; j--) 
+        {
+            lo = bb_a[k*eqdim+j]*lowbds[j];
+            hi = bb_a[k*eqdim+j]*upbds[j];
+            if (lo > hi) 
+            {
+                v = lo; lo = hi; hi = v;
+            }
+            bb_min[k*(eqdim+1)+j] = bb_min[k*(eqdim+1)+j+1] + lo;
+            bb_max[k*(eqdim+1)+j] = bb_max[k*(eqdim+1)+j+1] + hi;
+        }
+    }
+    return(1);
+}
+
+
+
+
+
+
+
+
+static void bb_free( void )
+{
+    allo(CP bb_a,U (bb_rows*eqdim*sizeof(long)+1),0);
+    allo(CP bb_b,U (bb_rows*sizeof(long)+1),0);
+    allo(CP bb_min,U bb_rows*(eqdim+1)*sizeof(long),0);
+    allo(CP bb_max,U bb_rows*(eqdim+1)*sizeof(long),0);
+    allo(bb_eq,U bb_rows+1,0);
+}
+
+
+
+
+
+
+
+
+static int bb_range( long *sum, int lev, long *lo, long *hi )
+/*****************************************************************/
+/*
+ * sum[r] is the value of row r for the variables 0,...,lev-1.
+ * Restrict [*lo,*hi] to the values of variable lev that leave every 
+ * row satisfiable. Return 0, if no value is left.
+ */
+{
+    long a,rest;
+    int k;
+    
+    *lo = lowbds[lev];
+    *hi = upbds[lev];
+    for (k = 0; k < bb_rows && *lo <= *hi; k++) 
+    {
+        a = bb_a[k*eqdim+lev];
+        /* a*v <= b-sum-min(rest) */
+        rest = bb_b[k]-sum[k]-bb_min[k*(eqdim+1)+lev+1];
+        if (a > 0) 
+        {
+            if (floor_div(rest,a) < *hi)
+                *hi = floor_div(rest,a);
+        }
+        else if (a < 0) 
+        {
+            if (ceil_div(rest,a) > *lo)
+                *lo = ceil_div(rest,a);
+        }
+        else if (rest < 0)
+            return(0);
+        
+        if (!bb_eq[k])
+            continue;
+        
+        /* a*v >= b-sum-max(rest) */
+        rest = bb_b[k]-sum[k]-bb_max[k*(eqdim+1)+lev+1];
+        if (a > 0) 
+        {
+            if (ceil_div(rest,a) > *lo)
+                *lo = ceil_div(rest,a);
+        }
+        else if (a < 0) 
+        {
+            if (floor_div(rest,a) < *hi)
+                *hi = floor_div(rest,a);
+        }
+        else if (rest > 0)
+            return(0);
+    }
+    return(*lo <= *hi);
+}
+
+
+
+
+
+
+
+
+static void bb_rekurs( struct bb_task *t, int lev )
+{
+    long lo,hi,v,*sum,*nsum;
+    int k;
+    
+    t->nodes++;
+    if (lev == eqdim) 
+    {
+        if (t->nout+eqdim > t->maxout) 
+        {
+            t->out = (int *) lallo(CP t->out,(size_t) t->maxout*sizeof(int),
+                                   (size_t) (2*t->maxout+eqdim)*sizeof(int));
+            t->maxout = 2*t->maxout+eqdim;
+        }
+        for (k = 0; k < eqdim; k++)
+            t->out[t->nout++] = (int) t->x[k];
+        return;
+    }
+    
+    sum = t->sum+lev*bb_rows;
+    nsum = sum+bb_rows;
+    if (!bb_range(sum,lev,&lo,&hi))
+        return;
+    for (v = lo; v <= hi; v++) 
+    {
+        t->x[lev] = v;
+        for (k = 0; k < bb_rows; k++)
+            nsum[k] = sum[k]+bb_a[k*eqdim+lev]*v;
+        bb_rekurs(t,lev+1);
+    }
+}
+
+
+
+
+
+
+
+
+static void bb_enumerate( void )
+/*****************************************************************/
+/*
+ * Split the enumeration tree into at least BB_TASKS subtrees (if 
+ * possible), enumerate them in parallel and write the points of
+ * the subtrees in their order. A subtree is given by the values of
+ * the variables 0,...,d-1. If the next level would give more than 
+ * BB_PREFIXES subtrees, the ranges of variable d are cut into chunks 
+ * instead, which become the subtrees.
+ */
+{
+    long *pre,*npre,*rlo,*rhi,*clo = 0,*chi = 0,lo,hi,v,*sum,*nsum;
+    unsigned long long tot,c;
+    int npr,nnpr,nch = 0,d,j,k,p,q;
+    
+    sum = (long *) allo(CP 0,0,U (bb_rows+1)*sizeof(long));
+    pre = (long *) allo(CP 0,0,U sizeof(long));
+    npr = 1;
+    for (d = 0; d < eqdim && npr < BB_TASKS; d++) 
+    {
+        /* the range of variable d in every subtree */
+        rlo = (long *) allo(CP 0,0,U npr*sizeof(long));
+        rhi = (long *) allo(CP 0,0,U npr*sizeof(long));
+        for (tot = 0, p = 0; p < npr; p++) 
+        {
+            for (k = 0; k < bb_rows; k++)
+                for (sum[k] = 0, j = 0; j < d; j++)
+                    sum[k] += bb_a[k*eqdim+j]*pre[p*d+j];
+            if (!bb_range(sum,d,rlo+p,rhi+p))
+                rhi[p] = rlo[p]-1;
+            else
+                tot += (unsigned long long) (rhi[p]-rlo[p])+1;
+        }
+        
+        if (tot > BB_PREFIXES) 
+        {
+            /* chunks of c values */
+            c = (tot+BB_TASKS-1)/BB_TASKS;
+            for (p = 0; p < npr; p++)
+                if (rlo[p] <= rhi[p])
+                    nch += (int) (((unsigned long long) (rhi[p]-rlo[p]))/c+1);
+            npre = (long *) allo(CP 0,0,U (nch*d+1)*sizeof(long));
+            clo = (long *) allo(CP 0,0,U nch*sizeof(long));
+            chi = (long *) allo(CP 0,0,U nch*sizeof(long));
+            for (q = p = 0; p < npr; p++)
+                for (lo = rlo[p]; lo <= rhi[p]; lo = hi+1, q++) 
+                {
+                    hi = (((unsigned long long) (rhi[p]-lo)) < c) ? rhi[p] : lo+(long) c-1;
+                    for (j = 0; j < d; j++)
+                        npre[q*d+j] = pre[p*d+j];
+                    clo[q] = lo;
+                    chi[q] = hi;
+                }
+        }
+        else 
+        {
+            npre = (long *) allo(CP 0,0,U (tot*(d+1)+1)*sizeof(long));
+            for (nnpr = p = 0; p < npr; p++)
+                for (v = rlo[p]; v <= rhi[p]; v++, nnpr++) 
+                {
+                    for (j = 0; j < d; j++)
+                        npre[nnpr*(d+1)+j] = pre[p*d+j];
+                    npre[nnpr*(d+1)+d] = v;
+                }
+        }
+        allo(CP rlo,U npr*sizeof(long),0);
+        allo(CP rhi,U npr*sizeof(long),0);
+        allo(CP pre,U (npr*d+1)*sizeof(long),0);
+        pre = npre;
+        if (nch) 
+        {
+            npr = nch;
+            break;
+        }
+        npr = (int) tot;
+        if (!npr)
+            break;
+    }
+    
+#pragma omp parallel for schedule(dynamic) ordered private(j,k,v,nsum) copyin(porta_cur)
+    for (p = 0; p < npr; p++) 
+    {
+        struct bb_task t;
+        
+        t.x = (long *) allo(CP 0,0,U (eqdim+1)*sizeof(long));
+        t.sum = (long *) allo(CP 0,0,U (eqdim+1)*(bb_rows+1)*sizeof(long));
+        t.nodes = t.nout = t.maxout = 0;
+        t.out = 0;
+        for (j = 0; j < d; j++)
+            t.x[j] = pre[p*d+j];
+        for (k = 0; k < bb_rows; k++)
+            for (t.sum[d*bb_rows+k] = 0, j = 0; j < d; j++)
+                t.sum[d*bb_rows+k] += bb_a[k*eqdim+j]*t.x[j];
+        if (!nch)
+            bb_rekurs(&t,d);
+        else 
+        {
+            /* the node of level d is counted with its first chunk */
+            if (p == 0 || memcmp(pre+p*d,pre+(p-1)*d,d*sizeof(long)))
+                t.nodes++;
+            nsum = t.sum+(d+1)*bb_rows;
+            for (v = clo[p]; v <= chi[p]; v++) 
+            {
+                t.x[d] = v;
+                for (k = 0; k < bb_rows; k++)
+                    nsum[k] = t.sum[d*bb_rows+k]+bb_a[k*eqdim+d]*v;
+                bb_rekurs(&t,d+1);
+            }
+        }
+        
+#pragma omp ordered
+        {
+            for (j = 0; j < t.nout; j += eqdim) 
+            {
+                intnum++;
+                fprintf(fp,"(%3d) ",intnum);
+                for (k = 0; k < eqdim; k++) 
+                    fprintf(fp,"%i ",t.out[j+k]);
+                fprintf(fp,"\n");
+            }
+            for (; t.nodes > 0; t.nodes--)
+                if (reknum++ % 1000 == 0) 
+                {
+                    fprintf(prt,".");
+                    fflush(prt);
+                    
+                    /* 17.01.1994: include logging on file porta.log */
+                    porta_log(".");
+                    fflush(logfile);
+                }
+        }
+        
+        lallo(CP t.out,(size_t) t.maxout*sizeof(int),0);
+        allo(CP t.sum,U (eqdim+1)*(bb_rows+1)*sizeof(long),0);
+        allo(CP t.x,U (eqdim+1)*sizeof(long),0);
+    }
+    
+    if (nch) 
+    {
+        allo(CP clo,U nch*sizeof(long),0);
+        allo(CP chi,U nch*sizeof(long),0);
+    }
+    allo(CP pre,U (npr*d+1)*sizeof(long),0);
+    allo(CP sum,U (bb_rows+1)*sizeof(long),0);
+}
+
+
+
+
+
+
+
+
 void valid_ints( int eqdimpar, RAT *eqarpar, int neqpar,int eqrlpar,
                 int iedimpar, RAT *iearpar, int niepar, int ierlpar, char *fname )
 { 
     RAT *eqsum = (RAT *)0;
     RAT *iesum = (RAT *)0;
+    char zip[8];
+    int l,z;
     
     fprintf (prt,"computing all valid integral points ");
     fflush(prt);
@@ -502,8 +1067,13 @@ void valid_ints( int eqdimpar, RAT *eqarpar, int neqpar,int eqrlpar,
     ierl = ierlpar;
     ubia = iear+nie*ierl;
     
-    fname[strlen(fname)-4] = '\0';
+    /* x.ieq gives x.poi, x.ieq.gz gives x.poi.gz */
+    l = strlen(fname);
+    z = (file_zip(fname)) ? strlen(strrchr(fname,'.')) : 0;
+    strcpy(zip,fname+l-z);
+    fname[l-z-((file_ext(fname,".ieq") == 2) ? 5 : 4)] = '\0';
     strcat(fname,".poi");
+    strcat(fname,zip);
     fp = wfopen(fname);
     
     fprintf(fp,"DIM =%3d\n\nCONV_SECTION\n",dim);
@@ -513,12 +1083,16 @@ void valid_ints( int eqdimpar, RAT *eqarpar, int neqpar,int eqrlpar,
     eqsum = (RAT *) RATallo(eqsum,0,(1+neq)*(eqdim+1));
     iesum = (RAT *) RATallo(iesum,0,(1+nie)*(iedim+1));
     
-    integ_rekurs(eqsum,iesum,0);
+    if (bb_system())
+        bb_enumerate();
+    else
+        integ_rekurs(eqsum,iesum,0);
+    bb_free();
     
     free(integ);
 
     fprintf(fp,"\nEND\n");
-    fclose(fp);
+    wfclose(fp);
     
     fprintf(prt,"\n\nnumber of valid integral points : %i\n\n",intnum);
     fprintf(prt,"integral points written to file %s\n",fname);
@@ -46,10 +46,10 @@ REVISED BY ANDREAS LOEBEL
 #include "mp.h"
 #include "four_mot.h"
 #include "portsort.h"
+#include "cache.h"
+#include "porta_ctx.h"
 
 
-FILE *logfile;
-
 
 #define FILENAME_SIZE 2000 // Extended this to accept long strings as input for long filenames (which could also include paths...) J-D B
 
@@ -58,6 +58,8 @@ int main( int argc, char *argv[] )
     int i, ieq_file, start;
     char outfname[FILENAME_SIZE];
     char fname[FILENAME_SIZE];
+    char cfname[FILENAME_SIZE];
+    long *key = 0, keylen = 0;
     int   poi_file;
     int   rowl_inar, ierl;
     int  *indx = (int *)0;      
@@ -112,26 +114,27 @@ int main( int argc, char *argv[] )
     
     set_I_functions();
     SET_MP_not_ready;
-    ieq_file = !strcmp(*argv+strlen(*argv)-4,".ieq");
-    poi_file = !strcmp(*argv+strlen(*argv)-4,".poi");
+    ieq_file = (file_ext(*argv,".ieq") != 0);
+    poi_file = (file_ext(*argv,".poi") != 0);
     printf("%i, %i",ieq_file, poi_file);
     if (!poi_file && !ieq_file)
         msg( "invalid format of command line", "", 0 );
+    if (is_set(Result_cache) && (is_set(Validity_table_out) || file_zip(*argv)))
+        msg( "%s : no result cache with -v or compressed files", *argv, 0 );
     
     /*
      * change by M.S. 5.6.92:
      * read_input_file writes to the output file, if is_set(Sort).
      */
     outfp = 0;
-    strcpy(outfname,*argv);
-    if (is_set(Sort) && poi_file) 
+    if (is_set(Sort) && poi_file && !is_set(Binary_out)) 
     {
-        strcat(outfname,".poi");
+        out_name(outfname,*argv,".poi");
         outfp = wfopen(outfname);
     }
-    if (is_set(Sort) && ieq_file) 
+    if (is_set(Sort) && ieq_file && !is_set(Binary_out)) 
     {
-        strcat(outfname,".ieq");
+        out_name(outfname,*argv,".ieq");
         fprintf(prt,"outfname = %s\n",outfname);
         fflush(stdout);
 
@@ -155,6 +158,8 @@ int main( int argc, char *argv[] )
         ineq = read_input_file(*argv,outfp,&dim,&ar1,(int *)&nel_ar1,cp1,
                                &elim_ord,"\0",(int **)&i,"\0",(RAT **)&i);
         free(cp1);
+        if (is_set(Dedup_input))
+            ineq = dedup_rows(ar1,ineq,dim+2,1);
         sort_eqie_cvce(ar1,ineq,dim+2,&equa_in,&ineq_in);
         ineq = ineq_in+equa_in;
         /*     elim_ord = check_and_reorder_elim_ord(elim_ord,&nel); */
@@ -193,7 +198,8 @@ int main( int argc, char *argv[] )
          * =  number of noneliminated variables+1 */
         nel = nel - (ineq - ineq_out);  /* number of variables to be elim. */
         ineq = ineq_out;
-        fourier_motzkin(0,ineq-equa,dim+1-equa_in,nel,poi_file,indx,elim_ord);
+        out_name(fname,*argv,".ieq");
+        fourier_motzkin(fname,ineq-equa,dim+1-equa_in,nel,poi_file,indx,elim_ord);
         if ((MP_realised && return_from_mp()) || !MP_realised) 
             sort(no_denom(ierl, 0, ineq,1), ierl, 0, ineq);
         write_ieq_file(*argv,outfp,equa,ineq,dim+1,0,
@@ -225,6 +231,20 @@ int main( int argc, char *argv[] )
         points = read_input_file(*argv,outfp,&dim,&ar1,(int *)&nel_ar1,
                                  "\0",(int **)&i,"\0",(int **)&i,"\0",
                                  (RAT **)&i);
+        if (is_set(Result_cache) && is_set(Traf) && !is_set(CACHE_BYPASS)) 
+        {
+            /* ar6 is the last conv-point, the VALID point of the output */
+            key = cache_key(ar1,points,dim,0,ar6,option & CACHE_OPTIONS,&keylen);
+            out_name(cfname,*argv,is_set(Binary_out) ? ".ieqb" : ".ieq");
+            if (key && cache_fetch(cache_dir(),key,keylen,cfname)) 
+            {
+                fclose( logfile );
+                exit(0);
+            }
+        }
+        /* the point numbers of the validity table refer to the input */
+        if (is_set(Dedup_input) && !is_set(Validity_table_out))
+            points = dedup_rows(ar1,points,dim+1,0);
         gentableau(ar1,1,&rowl_inar,&indx); 
         if(is_set(Long_arithmetic))
         {
@@ -276,11 +296,11 @@ int main( int argc, char *argv[] )
         {
 			fprintf(prt, "\n\n way2\n\n");
             /* POINTS TO INEQUALITIES */
-            sprintf(fname,"%s.ieq",*argv);
+            out_name(fname,*argv,".ieq");
             fourier_motzkin(fname,ineq-equa,points+dim+1-ineq,
                             points-ineq+equa,poi_file,indx,0);
 			fprintf(prt, "is_set(Validity_table_out) = %i\n", is_set(Validity_table_out));
-            if (is_set(Validity_table_out)) 
+            if (is_set(Validity_table_out) || is_set(Facet_check)) 
                 red_test(indx,ar1,&rowl_inar);
 			if MP_realised
 				fprintf(prt, "MP_realised = %i, return_from_mp() = %i\n", MP_realised, return_from_mp());
@@ -296,6 +316,8 @@ int main( int argc, char *argv[] )
             }
             write_ieq_file(*argv,outfp,equa,ineq,
                            dim+1,0,ineq,0,dim+1-equa,indx);
+            if (key) 
+                cache_store(cache_dir(),cache_budget,key,keylen,cfname);
         }
     }
     else if (is_set(Traf) && ieq_file) 
@@ -312,6 +334,16 @@ int main( int argc, char *argv[] )
                                  "\0",(int **)&i,
                                  "\0",(int **)&i,cp1,&inner);
         free(cp1);
+        if (is_set(Result_cache) && !is_set(CACHE_BYPASS)) 
+        {
+            key = cache_key(ar1,points,dim,1,inner,option & CACHE_OPTIONS,&keylen);
+            out_name(cfname,*argv,is_set(Binary_out) ? ".poib" : ".poi");
+            if (key && cache_fetch(cache_dir(),key,keylen,cfname)) 
+            {
+                fclose( logfile );
+                exit(0);
+            }
+        }
         ar6 = inner; if (inner) nel_ar6 = dim;
         printf("The valid point : ");
         for (i = 0; i < dim; i++)
@@ -340,6 +372,9 @@ int main( int argc, char *argv[] )
 		printf("%li/%i, %li/%i, %li/%i, %li/%i, %li/%i, %li/%i, %li/%i, %li/%i, %li/%i, %li/%i\n", ar1[50].num, ar1[50].den.i, ar1[51].num, ar1[51].den.i, ar1[52].num, ar1[52].den.i, ar1[53].num, ar1[53].den.i, ar1[54].num, ar1[54].den.i, ar1[55].num, ar1[55].den.i, ar1[56].num, ar1[56].den.i, ar1[57].num, ar1[57].den.i, ar1[58].num, ar1[58].den.i, ar1[59].num, ar1[59].den.i);
         
         
+        /* the inequality numbers of the validity table refer to the input */
+        if (is_set(Dedup_input) && !is_set(Validity_table_out))
+            points = dedup_rows(ar1,points,dim+2,1);
         sort_eqie_cvce(ar1,points,dim+2,&equa_in,&ineq_in);
         iep = ar1+equa_in*(dim+2);
         /* first equations then inequalities */
@@ -379,7 +414,7 @@ int main( int argc, char *argv[] )
         for (; (*indx) < 0; indx++);
         fourier_motzkin(0,ineq-equa,points+dim+1-ineq,
                         points-ineq+equa,poi_file,indx,0);
-        if (is_set(Validity_table_out)) 
+        if (is_set(Validity_table_out) || is_set(Facet_check)) 
             red_test(indx,iep,&rowl_inar);
         if (cone >= dim-equa)
             origin_add(rowl_inar,iep); 
@@ -395,6 +430,8 @@ int main( int argc, char *argv[] )
         conv = ineq - cone;
         if (!MP_realised) no_denom(dim+1, 0, cone,1);
         write_poi_file(*argv,outfp,dim,equa,ineq,cone,0,conv,cone);
+        if (key) 
+            cache_store(cache_dir(),cache_budget,key,keylen,cfname);
     }
     else 
         msg( "invalid format of command line", "", 0 );